@@ -208,6 +208,8 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
 	}
 	  // delete page_id from pages_table.
 	  page_table_.erase(page_id);
+	  // the frame goes to the free list, so the replacer must not hand it out as a victim as well.
+	  replacer_->Pin(frame_id);
 	  // Reset some metadata of pages_[frame_id]
 	  pages_[frame_id].ResetMemory();
 	  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
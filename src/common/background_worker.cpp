@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// background_worker.cpp
+//
+// Identification: src/common/background_worker.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/background_worker.h"
+
+#include <utility>
+
+namespace bustub {
+
+BackgroundWorker::~BackgroundWorker() {
+  {
+    std::scoped_lock lock(latch_);
+    stopped_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void BackgroundWorker::Submit(std::function<void()> task) {
+  {
+    std::scoped_lock lock(latch_);
+    tasks_.push_back(std::move(task));
+    if (!thread_.joinable()) {
+      thread_ = std::thread(&BackgroundWorker::Run, this);
+    }
+  }
+  cv_.notify_one();
+}
+
+void BackgroundWorker::Run() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
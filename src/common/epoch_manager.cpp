@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.cpp
+//
+// Identification: src/common/epoch_manager.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/epoch_manager.h"
+
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+EpochManager::~EpochManager() {
+  for (auto &slot : slots_) {
+    for (auto &retired : slot.retired_) {
+      retired.deleter_(retired.ptr_);
+    }
+  }
+}
+
+auto EpochManager::RegisterThread() -> size_t {
+  static std::atomic<size_t> next_slot{0};
+  thread_local size_t slot = next_slot.fetch_add(1) % NUM_SLOTS;
+  return slot;
+}
+
+auto EpochManager::Pin() -> Guard {
+  auto slot = RegisterThread();
+  while (true) {
+    auto epoch = epoch_.load();
+    auto parity = epoch & 1;
+    slots_[slot].pins_[parity].fetch_add(1);
+    // If the epoch moved on before our pin became visible, TryAdvance() may not have seen it; retry in the new epoch.
+    if (epoch_.load() == epoch) {
+      return Guard(this, slot, parity);
+    }
+    slots_[slot].pins_[parity].fetch_sub(1);
+  }
+}
+
+void EpochManager::Retire(void *ptr, void (*deleter)(void *)) {
+  auto &slot = slots_[RegisterThread()];
+  bool collect;
+  {
+    std::lock_guard<std::mutex> guard(slot.retired_latch_);
+    slot.retired_.push_back({ptr, deleter, epoch_.load()});
+    collect = slot.retired_.size() >= COLLECT_THRESHOLD;
+  }
+  if (collect) {
+    TryAdvance();
+    Reclaim(&slot);
+  }
+}
+
+void EpochManager::Collect() {
+  TryAdvance();
+  for (auto &slot : slots_) {
+    Reclaim(&slot);
+  }
+}
+
+void EpochManager::Synchronize() {
+  auto target = epoch_.load() + 2;
+  while (epoch_.load() < target) {
+    if (!TryAdvance()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+auto EpochManager::GetRetiredCount() -> size_t {
+  size_t count = 0;
+  for (auto &slot : slots_) {
+    std::lock_guard<std::mutex> guard(slot.retired_latch_);
+    count += slot.retired_.size();
+  }
+  return count;
+}
+
+auto EpochManager::TryAdvance() -> bool {
+  auto epoch = epoch_.load();
+  // Readers can only be pinned in the current or the previous epoch, which have different parities.
+  auto previous = (epoch - 1) & 1;
+  for (auto &slot : slots_) {
+    if (slot.pins_[previous].load() != 0) {
+      return false;
+    }
+  }
+  return epoch_.compare_exchange_strong(epoch, epoch + 1) || epoch_.load() > epoch;
+}
+
+void EpochManager::Reclaim(Slot *slot) {
+  // Anything retired two epochs ago was unlinked before every current pin was taken.
+  auto safe_epoch = epoch_.load() - 2;
+  std::vector<Retired> to_free;
+  {
+    std::lock_guard<std::mutex> guard(slot->retired_latch_);
+    auto it = slot->retired_.begin();
+    for (auto &retired : slot->retired_) {
+      if (retired.epoch_ <= safe_epoch) {
+        to_free.push_back(retired);
+      } else {
+        *it++ = retired;
+      }
+    }
+    slot->retired_.erase(it, slot->retired_.end());
+  }
+  // Deleters run outside the latch, they may retire objects themselves.
+  for (auto &retired : to_free) {
+    retired.deleter_(retired.ptr_);
+  }
+}
+
+}  // namespace bustub
@@ -12,30 +12,268 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <limits>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "common/util/hash_util.h"
+#include "concurrency/transaction_manager.h"
+
 namespace bustub {
 
 auto LockManager::LockShared(Transaction *txn, const RID &rid) -> bool {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> guard(latch_);
+  if (txn->GetState() == TransactionState::ABORTED) {
+    return false;
+  }
+  if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED) {
+    AbortImplicitly(txn, AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED);
+  }
+  if (txn->GetState() == TransactionState::SHRINKING) {
+    AbortImplicitly(txn, AbortReason::LOCK_ON_SHRINKING);
+  }
+  if (txn->IsSharedLocked(rid) || txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+
+  auto *queue = &lock_table_[rid];
+  auto it = queue->request_queue_.emplace(queue->request_queue_.end(), txn->GetTransactionId(), LockMode::SHARED);
+  WoundYounger(queue, txn, LockMode::SHARED);
+  bool granted = WaitForGrant(txn, rid, queue, it, &guard);
+  if (!granted) {
+    // We were wounded while waiting.
+    queue->request_queue_.erase(it);
+    queue->cv_.notify_all();
+    AbortImplicitly(txn, AbortReason::DEADLOCK);
+  }
+
+  it->granted_ = true;
   txn->GetSharedLockSet()->emplace(rid);
+  RecordLatency(LockOperation::SHARED, start);
   return true;
 }
 
 auto LockManager::LockExclusive(Transaction *txn, const RID &rid) -> bool {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> guard(latch_);
+  if (txn->GetState() == TransactionState::ABORTED) {
+    return false;
+  }
+  if (txn->GetState() == TransactionState::SHRINKING) {
+    AbortImplicitly(txn, AbortReason::LOCK_ON_SHRINKING);
+  }
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+
+  auto *queue = &lock_table_[rid];
+  auto it = queue->request_queue_.emplace(queue->request_queue_.end(), txn->GetTransactionId(), LockMode::EXCLUSIVE);
+  WoundYounger(queue, txn, LockMode::EXCLUSIVE);
+  bool granted = WaitForGrant(txn, rid, queue, it, &guard);
+  if (!granted) {
+    queue->request_queue_.erase(it);
+    queue->cv_.notify_all();
+    AbortImplicitly(txn, AbortReason::DEADLOCK);
+  }
+
+  it->granted_ = true;
   txn->GetExclusiveLockSet()->emplace(rid);
+  RecordLatency(LockOperation::EXCLUSIVE, start);
   return true;
 }
 
 auto LockManager::LockUpgrade(Transaction *txn, const RID &rid) -> bool {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> guard(latch_);
+  if (txn->GetState() == TransactionState::ABORTED) {
+    return false;
+  }
+  if (txn->GetState() == TransactionState::SHRINKING) {
+    AbortImplicitly(txn, AbortReason::LOCK_ON_SHRINKING);
+  }
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+
+  auto *queue = &lock_table_[rid];
+  if (queue->upgrading_ != INVALID_TXN_ID) {
+    queue->upgrade_conflicts_++;
+    AbortImplicitly(txn, AbortReason::UPGRADE_CONFLICT);
+  }
+
+  // Drop the shared request and queue an exclusive one right behind the granted requests, ahead of other waiters.
+  auto &requests = queue->request_queue_;
+  auto it = std::find_if(requests.begin(), requests.end(),
+                         [txn](const LockRequest &request) { return request.txn_id_ == txn->GetTransactionId(); });
+  BUSTUB_ASSERT(it != requests.end(), "Upgrading a lock that is not held.");
+  requests.erase(it);
   txn->GetSharedLockSet()->erase(rid);
+  auto pos =
+      std::find_if(requests.begin(), requests.end(), [](const LockRequest &request) { return !request.granted_; });
+  it = requests.emplace(pos, txn->GetTransactionId(), LockMode::EXCLUSIVE);
+  queue->upgrading_ = txn->GetTransactionId();
+
+  WoundYounger(queue, txn, LockMode::EXCLUSIVE);
+  bool granted = WaitForGrant(txn, rid, queue, it, &guard);
+  queue->upgrading_ = INVALID_TXN_ID;
+  if (!granted) {
+    requests.erase(it);
+    queue->cv_.notify_all();
+    AbortImplicitly(txn, AbortReason::DEADLOCK);
+  }
+
+  it->granted_ = true;
   txn->GetExclusiveLockSet()->emplace(rid);
+  RecordLatency(LockOperation::UPGRADE, start);
   return true;
 }
 
 auto LockManager::Unlock(Transaction *txn, const RID &rid) -> bool {
-  txn->GetSharedLockSet()->erase(rid);
-  txn->GetExclusiveLockSet()->erase(rid);
+  std::unique_lock<std::mutex> guard(latch_);
+  bool shared = txn->GetSharedLockSet()->erase(rid) != 0;
+  bool exclusive = txn->GetExclusiveLockSet()->erase(rid) != 0;
+  if (!shared && !exclusive) {
+    return false;
+  }
+
+  auto *queue = &lock_table_[rid];
+  auto &requests = queue->request_queue_;
+  auto it = std::find_if(requests.begin(), requests.end(),
+                         [txn](const LockRequest &request) { return request.txn_id_ == txn->GetTransactionId(); });
+  if (it != requests.end()) {
+    requests.erase(it);
+  }
+  queue->cv_.notify_all();
+
+  // Releasing a shared lock under READ_COMMITTED does not end the growing phase.
+  if (txn->GetState() == TransactionState::GROWING &&
+      !(shared && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED)) {
+    txn->SetState(TransactionState::SHRINKING);
+  }
+  return true;
+}
+
+auto LockManager::KeyRangeResource(const std::string &index_name, const char *key, size_t key_size) -> RID {
+  // The largest slot number is reserved for the supremum.
+  auto slot = static_cast<uint32_t>(HashUtil::HashBytes(key, key_size) % std::numeric_limits<uint32_t>::max());
+  return {KeyRangeSupremum(index_name).GetPageId(), slot};
+}
+
+auto LockManager::KeyRangeSupremum(const std::string &index_name) -> RID {
+  // Stay below INVALID_PAGE_ID, tuple RIDs only use non-negative page ids.
+  auto index_hash = HashUtil::HashBytes(index_name.data(), index_name.size()) & 0x3fffffff;
+  return {static_cast<page_id_t>(-2 - static_cast<int64_t>(index_hash)), std::numeric_limits<uint32_t>::max()};
+}
+
+void LockManager::AbortImplicitly(Transaction *txn, AbortReason abort_reason) {
+  txn->SetState(TransactionState::ABORTED);
+  throw TransactionAbortException(txn->GetTransactionId(), abort_reason);
+}
+
+void LockManager::WoundYounger(LockRequestQueue *queue, Transaction *txn, LockMode lock_mode) {
+  bool wounded = false;
+  for (auto &request : queue->request_queue_) {
+    if (request.txn_id_ <= txn->GetTransactionId()) {
+      continue;
+    }
+    if (lock_mode == LockMode::SHARED && request.lock_mode_ == LockMode::SHARED) {
+      continue;
+    }
+    auto *younger = TransactionManager::GetTransaction(request.txn_id_);
+    if (younger->GetState() != TransactionState::ABORTED) {
+      younger->SetState(TransactionState::ABORTED);
+      wounded = true;
+      // The victim may be blocked on another RID; wake it up there so that it can release what we wait for.
+      auto waiting = waits_for_.find(request.txn_id_);
+      if (waiting != waits_for_.end()) {
+        lock_table_[waiting->second].cv_.notify_all();
+      }
+    }
+  }
+  if (wounded) {
+    // Waiting victims wake up, withdraw their requests and throw; running victims release on abort.
+    queue->cv_.notify_all();
+  }
+}
+
+auto LockManager::WaitForGrant(Transaction *txn, const RID &rid, LockRequestQueue *queue,
+                               std::list<LockRequest>::iterator it, std::unique_lock<std::mutex> *guard) -> bool {
+  if (txn->GetState() != TransactionState::ABORTED && IsCompatible(queue, it)) {
+    return true;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  waits_for_[txn->GetTransactionId()] = rid;
+  while (txn->GetState() != TransactionState::ABORTED && !IsCompatible(queue, it)) {
+    queue->cv_.wait(*guard);
+  }
+  waits_for_.erase(txn->GetTransactionId());
+
+  auto waited_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  queue->wait_count_++;
+  queue->total_wait_us_ += waited_us;
+  queue->max_wait_us_ = std::max(queue->max_wait_us_, waited_us);
+  return txn->GetState() != TransactionState::ABORTED;
+}
+
+void LockManager::RecordLatency(LockOperation operation, std::chrono::steady_clock::time_point start) {
+  auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  latencies_[static_cast<size_t>(operation)].Record(static_cast<uint64_t>(latency_us.count()));
+}
+
+auto LockManager::GetContentionSnapshot(size_t n) -> std::vector<LockContention> {
+  std::unique_lock<std::mutex> guard(latch_);
+  std::vector<LockContention> snapshot;
+  for (auto &[rid, queue] : lock_table_) {
+    LockContention contention{rid, queue.wait_count_, queue.total_wait_us_, queue.max_wait_us_,
+                              queue.upgrade_conflicts_, {}, {}};
+    for (auto &request : queue.request_queue_) {
+      (request.granted_ ? contention.holders_ : contention.waiters_).push_back(request.txn_id_);
+    }
+    // Waits still in progress are not counted yet, but their lock objects are contended all the same.
+    if (contention.wait_count_ != 0 || contention.upgrade_conflicts_ != 0 || !contention.waiters_.empty()) {
+      snapshot.push_back(std::move(contention));
+    }
+  }
+  auto by_wait_time = [](const LockContention &a, const LockContention &b) {
+    return a.total_wait_us_ != b.total_wait_us_ ? a.total_wait_us_ > b.total_wait_us_ : a.wait_count_ > b.wait_count_;
+  };
+  if (snapshot.size() > n) {
+    std::partial_sort(snapshot.begin(), snapshot.begin() + n, snapshot.end(), by_wait_time);
+    snapshot.resize(n);
+  } else {
+    std::sort(snapshot.begin(), snapshot.end(), by_wait_time);
+  }
+  return snapshot;
+}
+
+auto LockManager::GetLatencyHistogram(LockOperation operation) -> LatencyHistogram {
+  std::unique_lock<std::mutex> guard(latch_);
+  return latencies_[static_cast<size_t>(operation)];
+}
+
+void LockManager::ResetStatistics() {
+  std::unique_lock<std::mutex> guard(latch_);
+  for (auto &[rid, queue] : lock_table_) {
+    queue.wait_count_ = 0;
+    queue.total_wait_us_ = 0;
+    queue.max_wait_us_ = 0;
+    queue.upgrade_conflicts_ = 0;
+  }
+  latencies_.fill(LatencyHistogram());
+}
+
+auto LockManager::IsCompatible(LockRequestQueue *queue, std::list<LockRequest>::iterator it) -> bool {
+  for (auto cur = queue->request_queue_.begin(); cur != it; ++cur) {
+    if (it->lock_mode_ == LockMode::EXCLUSIVE || cur->lock_mode_ == LockMode::EXCLUSIVE) {
+      return false;
+    }
+  }
   return true;
 }
 
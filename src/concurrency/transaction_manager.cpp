@@ -12,6 +12,7 @@
 
 #include "concurrency/transaction_manager.h"
 
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
 
@@ -20,23 +21,127 @@
 
 namespace bustub {
 
-std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
-std::shared_mutex TransactionManager::txn_map_mutex = {};
+TransactionMap TransactionManager::txn_map = {};
+TupleVersionTable TransactionManager::version_table = {};
 
-auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level) -> Transaction * {
-  // Acquire the global transaction latch in shared mode.
-  global_txn_latch_.RLock();
+TransactionMap::~TransactionMap() {
+  for (auto &shard : shards_) {
+    delete shard.table_.load();
+  }
+}
+
+template <typename Modify>
+void TransactionMap::Update(txn_id_t txn_id, Modify modify) {
+  auto &shard = ShardOf(txn_id);
+  Table *old_table;
+  {
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    old_table = shard.table_.load();
+    auto *new_table = old_table == nullptr ? new Table() : new Table(*old_table);
+    modify(new_table);
+    shard.table_.store(new_table);
+  }
+  // Concurrent lookups may still be reading the old table.
+  if (old_table != nullptr) {
+    epoch_manager_.Retire(old_table);
+  }
+}
+
+void TransactionMap::Insert(Transaction *txn) {
+  Update(txn->GetTransactionId(), [txn](Table *table) { (*table)[txn->GetTransactionId()] = txn; });
+}
 
+void TransactionMap::Erase(txn_id_t txn_id) {
+  Update(txn_id, [txn_id](Table *table) { table->erase(txn_id); });
+}
+
+auto TransactionMap::Find(txn_id_t txn_id) -> Transaction * {
+  auto guard = epoch_manager_.Pin();
+  auto *table = ShardOf(txn_id).table_.load();
+  if (table == nullptr) {
+    return nullptr;
+  }
+  auto it = table->find(txn_id);
+  return it == table->end() ? nullptr : it->second;
+}
+
+void TupleVersionTable::Begin(Transaction *txn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  txn->SetStartVersion(clock_);
+  active_.insert(clock_);
+}
+
+void TupleVersionTable::End(Transaction *txn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  active_.erase(active_.find(txn->GetStartVersion()));
+  // Every version up to the oldest start was written before any running transaction began.
+  uint64_t horizon = active_.empty() ? clock_ : *active_.begin();
+  while (!log_.empty() && log_.front().first <= horizon) {
+    const auto &[version, rid] = log_.front();
+    auto &shard = ShardOf(rid);
+    {
+      std::lock_guard<std::mutex> shard_guard(shard.latch_);
+      // A later write of the tuple has a log record of its own and keeps the entry.
+      auto it = shard.versions_.find(rid);
+      if (it != shard.versions_.end() && it->second == version) {
+        shard.versions_.erase(it);
+      }
+    }
+    log_.pop_front();
+  }
+}
+
+auto TupleVersionTable::Get(const RID &rid) -> uint64_t {
+  auto &shard = ShardOf(rid);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  auto it = shard.versions_.find(rid);
+  return it == shard.versions_.end() ? 0 : it->second;
+}
+
+void TupleVersionTable::Bump(const RID &rid) {
+  std::lock_guard<std::mutex> guard(latch_);
+  uint64_t version = ++clock_;
+  auto &shard = ShardOf(rid);
+  {
+    std::lock_guard<std::mutex> shard_guard(shard.latch_);
+    shard.versions_[rid] = version;
+  }
+  log_.emplace_back(version, rid);
+}
+
+auto TupleVersionTable::Size() -> size_t {
+  size_t size = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    size += shard.versions_.size();
+  }
+  return size;
+}
+
+auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level, ConcurrencyMode concurrency_mode)
+    -> Transaction * {
   if (txn == nullptr) {
-    txn = new Transaction(next_txn_id_++, isolation_level);
+    txn = new Transaction(next_txn_id_++, isolation_level, concurrency_mode);
+  }
+  // Wait out any checkpoint in progress.
+  RegisterActive(txn);
+  if (txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC) {
+    version_table.Begin(txn);
   }
-  txn_map_mutex.lock();
-  txn_map[txn->GetTransactionId()] = txn;
-  txn_map_mutex.unlock();
+  txn_map.Insert(txn);
   return txn;
 }
 
 void TransactionManager::Commit(Transaction *txn) {
+  if (txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC && !ValidateAndWrite(txn)) {
+    // ValidateAndWrite() has rolled the transaction back already.
+    txn->SetState(TransactionState::ABORTED);
+    ReleaseLocks(txn);
+    txn_map.Erase(txn->GetTransactionId());
+    version_table.End(txn);
+    DeregisterActive(txn);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::VALIDATION_FAILED);
+  }
   txn->SetState(TransactionState::COMMITTED);
 
   // Perform all deletes before we commit.
@@ -54,14 +159,37 @@ void TransactionManager::Commit(Transaction *txn) {
 
   // Release all the locks.
   ReleaseLocks(txn);
-  // Release the global transaction latch.
-  global_txn_latch_.RUnlock();
+  txn_map.Erase(txn->GetTransactionId());
+  if (txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC) {
+    version_table.End(txn);
+  }
+  // Let a pending checkpoint proceed.
+  DeregisterActive(txn);
 }
 
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
+  // Buffered writes were never applied, so there is nothing to undo. The write set only holds applied writes.
+  txn->GetBufferedWriteSet()->clear();
   // Rollback before releasing the lock.
-  auto table_write_set = txn->GetWriteSet();
+  Rollback(txn);
+
+  // Release all the locks.
+  ReleaseLocks(txn);
+  txn_map.Erase(txn->GetTransactionId());
+  if (txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC) {
+    version_table.End(txn);
+  }
+  // Let a pending checkpoint proceed.
+  DeregisterActive(txn);
+}
+
+void TransactionManager::Rollback(Transaction *txn) {
+  // Undoing an update goes through TableHeap::UpdateTupleInPlace, which appends to the write set; work on a detached
+  // copy.
+  auto table_write_set = std::make_shared<std::deque<TableWriteRecord>>();
+  table_write_set->swap(*txn->GetWriteSet());
+  bool optimistic = txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC;
   while (!table_write_set->empty()) {
     auto &item = table_write_set->back();
     auto table = item.table_;
@@ -71,7 +199,11 @@ void TransactionManager::Abort(Transaction *txn) {
       // Note that this also releases the lock when holding the page latch.
       table->ApplyDelete(item.rid_, txn);
     } else if (item.wtype_ == WType::UPDATE) {
-      table->UpdateTuple(item.tuple_, item.rid_, txn);
+      table->UpdateTupleInPlace(item.tuple_, item.rid_, txn);
+    }
+    if (optimistic) {
+      // Optimistic readers may have seen the undone image, which must fail their validation.
+      version_table.Bump(item.rid_);
     }
     table_write_set->pop_back();
   }
@@ -84,8 +216,9 @@ void TransactionManager::Abort(Transaction *txn) {
     // Metadata identifying the table that should be deleted from.
     TableInfo *table_info = catalog->GetTable(item.table_oid_);
     IndexInfo *index_info = catalog->GetIndex(item.index_oid_);
-    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                            index_info->index_->GetKeyAttrs());
+    // Index entries carry the included columns of covering indexes after the key.
+    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetEntrySchema()),
+                                            index_info->index_->GetEntryAttrs());
     if (item.wtype_ == WType::DELETE) {
       index_info->index_->InsertEntry(new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
@@ -93,23 +226,84 @@ void TransactionManager::Abort(Transaction *txn) {
     } else if (item.wtype_ == WType::UPDATE) {
       // Delete the new key and insert the old key
       index_info->index_->DeleteEntry(new_key, item.rid_, txn);
-      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                                  index_info->index_->GetKeyAttrs());
+      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetEntrySchema()),
+                                                  index_info->index_->GetEntryAttrs());
       index_info->index_->InsertEntry(old_key, item.rid_, txn);
     }
     index_write_set->pop_back();
   }
-  table_write_set->clear();
+  txn->GetWriteSet()->clear();
   index_write_set->clear();
+}
 
-  // Release all the locks.
-  ReleaseLocks(txn);
-  // Release the global transaction latch.
-  global_txn_latch_.RUnlock();
+auto TransactionManager::ValidateAndWrite(Transaction *txn) -> bool {
+  std::lock_guard<std::mutex> guard(validation_latch_);
+  // Take the buffered writes out; applying them in place adds their undo records to the write set.
+  std::deque<TableWriteRecord> buffered;
+  buffered.swap(*txn->GetBufferedWriteSet());
+
+  bool success = true;
+  for (const auto &[rid, version] : *txn->GetReadSet()) {
+    if (!version_table.Validate(rid, version)) {
+      success = false;
+      break;
+    }
+  }
+
+  for (auto it = buffered.begin(); success && it != buffered.end(); ++it) {
+    if (it->wtype_ == WType::DELETE) {
+      success = it->table_->MarkDeleteInPlace(it->rid_, txn);
+    } else if (it->wtype_ == WType::UPDATE) {
+      success = it->table_->UpdateTupleInPlace(it->tuple_, it->rid_, txn);
+    }
+    if (success) {
+      version_table.Bump(it->rid_);
+    }
+  }
+  if (!success) {
+    // Undo under the latch, so that no reader validates against a write that is about to disappear.
+    Rollback(txn);
+  }
+  return success;
+}
+
+void TransactionManager::RegisterActive(Transaction *txn) {
+  auto &slot = active_[static_cast<size_t>(txn->GetTransactionId()) % ACTIVE_SLOTS];
+  while (true) {
+    // Announce ourselves before looking at blocked_; the checkpoint sets blocked_ before looking at the counters.
+    slot.count_.fetch_add(1);
+    if (!blocked_.load()) {
+      return;
+    }
+    slot.count_.fetch_sub(1);
+    std::unique_lock<std::mutex> guard(block_latch_);
+    resumed_.wait(guard, [this] { return !blocked_.load(); });
+  }
 }
 
-void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
+void TransactionManager::DeregisterActive(Transaction *txn) {
+  active_[static_cast<size_t>(txn->GetTransactionId()) % ACTIVE_SLOTS].count_.fetch_sub(1);
+}
 
-void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
+void TransactionManager::BlockAllTransactions() {
+  {
+    std::unique_lock<std::mutex> guard(block_latch_);
+    resumed_.wait(guard, [this] { return !blocked_.load(); });
+    blocked_.store(true);
+  }
+  for (auto &slot : active_) {
+    while (slot.count_.load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void TransactionManager::ResumeTransactions() {
+  {
+    std::lock_guard<std::mutex> guard(block_latch_);
+    blocked_.store(false);
+  }
+  resumed_.notify_all();
+}
 
 }  // namespace bustub
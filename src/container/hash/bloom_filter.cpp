@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/container/hash/bloom_filter.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/hash/bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bustub {
+
+namespace {
+
+/** MurmurHash3's 64-bit finalizer, so that hash functions with weak bits do not skew the probes. */
+auto Mix(uint64_t hash) -> uint64_t {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // namespace
+
+BloomFilter::BloomFilter(uint64_t initial_capacity, uint32_t bits_per_key) {
+  generations_[0] = std::make_unique<Generation>(std::max<uint64_t>(initial_capacity, 1), bits_per_key);
+  num_generations_.store(1);
+}
+
+void BloomFilter::Insert(uint64_t hash) {
+  uint32_t generation_idx = num_generations_.load() - 1;
+  Generation *generation = generations_[generation_idx].get();
+  generation->Insert(hash);
+  if (generation->size_.fetch_add(1) + 1 == generation->capacity_ && generation_idx + 1 < MAX_GENERATIONS) {
+    Grow(generation_idx);
+  }
+}
+
+auto BloomFilter::MayContain(uint64_t hash) const -> bool {
+  uint32_t num_generations = num_generations_.load();
+  // The newest generation holds as many keys as all others together.
+  for (uint32_t i = num_generations; i > 0; i--) {
+    if (generations_[i - 1]->MayContain(hash)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BloomFilter::Grow(uint32_t generation_idx) {
+  std::scoped_lock latch(grow_latch_);
+  if (num_generations_.load() != generation_idx + 1) {
+    return;
+  }
+  const Generation &full = *generations_[generation_idx];
+  uint32_t bits_per_key = static_cast<uint32_t>(full.num_bits_ / full.capacity_) + 1;
+  generations_[generation_idx + 1] = std::make_unique<Generation>(full.capacity_ * 2, bits_per_key);
+  num_generations_.store(generation_idx + 2);
+}
+
+BloomFilter::Generation::Generation(uint64_t capacity, uint32_t bits_per_key)
+    : capacity_(capacity),
+      num_bits_((capacity * bits_per_key + 63) / 64 * 64),
+      // k = ln 2 * bits per key minimizes the false positive rate.
+      num_probes_(std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(bits_per_key * 0.69)))),
+      words_(new std::atomic<uint64_t>[num_bits_ / 64]) {
+  for (uint64_t i = 0; i < num_bits_ / 64; i++) {
+    words_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+/*
+ * The probes are h1 + i * h2 for two halves of the mixed hash (Kirsch and
+ * Mitzenmacher), which is as good as independent hash functions.
+ */
+void BloomFilter::Generation::Insert(uint64_t hash) {
+  uint64_t mixed = Mix(hash);
+  uint64_t h1 = mixed >> 32;
+  uint64_t h2 = (mixed & 0xffffffffULL) | 1;
+  for (uint32_t i = 0; i < num_probes_; i++) {
+    uint64_t bit = (h1 + i * h2) % num_bits_;
+    words_[bit / 64].fetch_or(uint64_t{1} << (bit % 64));
+  }
+}
+
+auto BloomFilter::Generation::MayContain(uint64_t hash) const -> bool {
+  uint64_t mixed = Mix(hash);
+  uint64_t h1 = mixed >> 32;
+  uint64_t h2 = (mixed & 0xffffffffULL) | 1;
+  for (uint32_t i = 0; i < num_probes_; i++) {
+    uint64_t bit = (h1 + i * h2) % num_bits_;
+    if ((words_[bit / 64].load() & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
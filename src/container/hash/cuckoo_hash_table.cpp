@@ -0,0 +1,270 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cuckoo_hash_table.cpp
+//
+// Identification: src/container/hash/cuckoo_hash_table.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/hash/cuckoo_hash_table.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+CUCKOO_HASH_TABLE_TYPE::CuckooHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                        const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                                        size_t num_buckets)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  static_assert(MAX_BUCKETS <= HashTableHeaderPage::MAX_BLOCKS, "The header page cannot list MAX_BUCKETS buckets");
+  size_t size = 2;
+  while (size < std::min(num_buckets, MAX_BUCKETS)) {
+    size *= 2;
+  }
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(NewPage(&header_page_id_)->GetData());
+  header->SetPageId(header_page_id_);
+  header->SetSize(size);
+  for (size_t bucket_idx = 0; bucket_idx < size; bucket_idx++) {
+    page_id_t bucket_page_id;
+    NewPage(&bucket_page_id);
+    header->AddBlockPageId(bucket_page_id);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::CandidateBuckets(const KeyType &key, size_t num_buckets) -> std::pair<size_t, size_t> {
+  uint64_t hash = hash_fn_.GetHash(key);
+  return {(hash & 0xffffffffU) & (num_buckets - 1), (hash >> 32) & (num_buckets - 1)};
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(bucket_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page from the buffer pool");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::NewPage(page_id_t *page_id) -> Page * {
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result)
+    -> bool {
+  table_latch_.RLock();
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id_)->GetData());
+  auto [first, second] = CandidateBuckets(key, header->GetSize());
+  bool found = false;
+  for (size_t bucket_idx : {first, second}) {
+    page_id_t bucket_page_id = header->GetBlockPageId(bucket_idx);
+    found = FetchBucketPage(bucket_page_id)->GetValue(key, comparator_, result) || found;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (first == second) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
+  table_latch_.WLock();
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id_)->GetData());
+  auto [first, second] = CandidateBuckets(key, header->GetSize());
+  std::vector<ValueType> values;
+  for (size_t bucket_idx : {first, second}) {
+    page_id_t bucket_page_id = header->GetBlockPageId(bucket_idx);
+    FetchBucketPage(bucket_page_id)->GetValue(key, comparator_, &values);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (first == second) {
+      break;
+    }
+  }
+
+  bool inserted = std::find(values.begin(), values.end(), value) == values.end();
+  bool grown = false;
+  while (inserted && !InsertIntoCandidate(header, key, value) && !Displace(header, key, value)) {
+    inserted = Grow(header);
+    grown = grown || inserted;
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, grown);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::InsertIntoCandidate(HashTableHeaderPage *header, const KeyType &key,
+                                                 const ValueType &value) -> bool {
+  auto [first, second] = CandidateBuckets(key, header->GetSize());
+  page_id_t first_page_id = header->GetBlockPageId(first);
+  page_id_t second_page_id = header->GetBlockPageId(second);
+  auto *first_bucket = FetchBucketPage(first_page_id);
+  auto *second_bucket = FetchBucketPage(second_page_id);
+  bool second_emptier = second_bucket->NumReadable() < first_bucket->NumReadable();
+  bool inserted = (second_emptier ? second_bucket : first_bucket)->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(first_page_id, inserted && !second_emptier);
+  buffer_pool_manager_->UnpinPage(second_page_id, inserted && second_emptier);
+  return inserted;
+}
+
+/*
+ * Every move takes a pair out of a full bucket to make room for the pair that
+ * is being carried, and carries the pair it took out on to its other bucket,
+ * until a bucket has room. The moves are undone in reverse order if none does.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::Displace(HashTableHeaderPage *header, const KeyType &key, const ValueType &value)
+    -> bool {
+  struct Move {
+    size_t bucket_idx_;
+    MappingType evicted_;
+    MappingType placed_;
+  };
+  std::vector<Move> moves;
+  size_t num_buckets = header->GetSize();
+  MappingType carried(key, value);
+  size_t bucket_idx = CandidateBuckets(key, num_buckets).first;
+  for (int displacement = 0; displacement < MAX_DISPLACEMENTS; displacement++) {
+    // The bucket is full, so every slot holds a pair; the hash spreads the choice of victim over the slots.
+    page_id_t bucket_page_id = header->GetBlockPageId(bucket_idx);
+    auto *bucket = FetchBucketPage(bucket_page_id);
+    auto slot = static_cast<uint32_t>(((hash_fn_.GetHash(carried.first) >> 16) + displacement) % BUCKET_ARRAY_SIZE);
+    MappingType evicted(bucket->KeyAt(slot), bucket->ValueAt(slot));
+    bucket->RemoveAt(slot);
+    bucket->Insert(carried.first, carried.second, comparator_);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    moves.push_back({bucket_idx, evicted, carried});
+
+    auto [first, second] = CandidateBuckets(evicted.first, num_buckets);
+    bucket_idx = first == bucket_idx ? second : first;
+    carried = evicted;
+    bucket_page_id = header->GetBlockPageId(bucket_idx);
+    bool inserted = FetchBucketPage(bucket_page_id)->Insert(carried.first, carried.second, comparator_);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+    if (inserted) {
+      return true;
+    }
+  }
+
+  for (auto move = moves.rbegin(); move != moves.rend(); ++move) {
+    page_id_t bucket_page_id = header->GetBlockPageId(move->bucket_idx_);
+    auto *bucket = FetchBucketPage(bucket_page_id);
+    bucket->Remove(move->placed_.first, move->placed_.second, comparator_);
+    bucket->Insert(move->evicted_.first, move->evicted_.second, comparator_);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::Grow(HashTableHeaderPage *header) -> bool {
+  size_t num_buckets = header->GetSize();
+  if (num_buckets == MAX_BUCKETS) {
+    return false;
+  }
+  for (size_t bucket_idx = 0; bucket_idx < num_buckets; bucket_idx++) {
+    page_id_t old_page_id = header->GetBlockPageId(bucket_idx);
+    page_id_t new_page_id;
+    auto *new_bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(NewPage(&new_page_id)->GetData());
+    auto *old_bucket = FetchBucketPage(old_page_id);
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE && old_bucket->IsOccupied(slot); slot++) {
+      if (!old_bucket->IsReadable(slot)) {
+        continue;
+      }
+      KeyType key = old_bucket->KeyAt(slot);
+      auto [first, second] = CandidateBuckets(key, num_buckets);
+      auto [new_first, new_second] = CandidateBuckets(key, 2 * num_buckets);
+      if ((first == bucket_idx ? new_first : new_second) != bucket_idx) {
+        new_bucket->Insert(key, old_bucket->ValueAt(slot), comparator_);
+        old_bucket->RemoveAt(slot);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(old_page_id, true);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    // Buckets are split in order, so the new bucket of bucket i is listed at i + num_buckets.
+    header->AddBlockPageId(new_page_id);
+  }
+  header->SetSize(2 * num_buckets);
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
+  table_latch_.WLock();
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id_)->GetData());
+  auto [first, second] = CandidateBuckets(key, header->GetSize());
+  bool removed = false;
+  for (size_t bucket_idx : {first, second}) {
+    page_id_t bucket_page_id = header->GetBlockPageId(bucket_idx);
+    removed = FetchBucketPage(bucket_page_id)->Remove(key, value, comparator_);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+    if (removed || first == second) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.WUnlock();
+  return removed;
+}
+
+/*****************************************************************************
+ * GETNUMBUCKETS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto CUCKOO_HASH_TABLE_TYPE::GetNumBuckets() -> size_t {
+  table_latch_.RLock();
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id_)->GetData());
+  size_t num_buckets = header->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return num_buckets;
+}
+
+template class CuckooHashTable<int, int, IntComparator>;
+
+template class CuckooHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class CuckooHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class CuckooHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class CuckooHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class CuckooHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class CuckooHashTable<GenericKey<128>, RID, GenericComparator<128>>;
+template class CuckooHashTable<GenericKey<256>, RID, GenericComparator<256>>;
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -24,9 +25,20 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn, bool bloom_filter)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // A directory of global depth 0 with a single empty bucket.
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(NewPage(&directory_page_id_)->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  NewPage(&bucket_page_id);
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  if (bloom_filter) {
+    bloom_filter_ = std::make_unique<BloomFilter>();
+  }
 }
 
 /*****************************************************************************
@@ -46,30 +58,85 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  return reinterpret_cast<HashTableDirectoryPage *>(FetchPage(directory_page_id_)->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(bucket_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page from the buffer pool");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::NewPage(page_id_t *page_id) -> Page * {
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+  }
+  return page;
 }
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
+/*
+ * Inserts and removes that neither split nor merge a bucket hold the table
+ * latch in read mode, which keeps the directory as it is, and latch only the
+ * bucket page they work on. Splits and merges take the table latch in write
+ * mode, which waits for every such bucket latch to be released, and also
+ * write-latch the directory page while they change the directory.
+ *
+ * Lookups take neither latch on the directory. They read the key's bucket
+ * page id under the directory page's version (see Page::OptimisticRLatch()),
+ * read-latch the bucket and then check that the directory has not been
+ * written to since. Splits write-latch the buckets they move entries out of,
+ * so a bucket cannot change under a lookup that has validated it.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(hash_fn_.GetHash(key))) {
+    return false;
+  }
+  Page *dir = FetchPage(directory_page_id_);
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(dir->GetData());
+  Page *page;
+  while (true) {
+    uint64_t version = dir->OptimisticRLatch();
+    page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+    if (!dir->ValidateRead(version)) {
+      continue;
+    }
+    page = FetchPage(bucket_page_id);
+    page->RLatch();
+    if (dir->ValidateRead(version)) {
+      break;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+  bool found = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData())->GetValue(key, comparator_, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +144,103 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  if (bloom_filter_ != nullptr) {
+    // Before the key is visible, so that no lookup that could find it is ruled out by the filter.
+    bloom_filter_->Insert(hash_fn_.GetHash(key));
+  }
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool full = bucket->IsFull();
+  bool inserted = !full && bucket->Insert(key, value, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (full) {
+    // The bucket may have changed after the latches were released, SplitInsert() looks at it again.
+    table_latch_.WLock();
+    inserted = SplitInsert(transaction, key, value);
+    table_latch_.WUnlock();
+  }
+  return inserted;
 }
 
+/*
+ * Called with the table latch held in write mode, once the bucket of the key
+ * is full. The bucket is split until the key's bucket has room, which may
+ * take more than one split if all of its entries move to the same side.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  Page *dir = FetchPage(directory_page_id_);
+  dir->WLatch();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(dir->GetData());
+  bool inserted = false;
+  bool dirty = false;
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    Page *page = FetchPage(bucket_page_id);
+    page->WLatch();
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    std::vector<ValueType> values;
+    bucket->GetValue(key, comparator_, &values);
+    bool duplicate = std::find(values.begin(), values.end(), value) != values.end();
+    bool full = bucket->IsFull();
+    inserted = !duplicate && !full && bucket->Insert(key, value, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+    if (duplicate || !full || !SplitBucket(dir_page, bucket_idx)) {
+      break;
+    }
+    dirty = true;
+  }
+  dir->WUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dirty);
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx) -> bool {
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  if (local_depth == dir_page->GetGlobalDepth()) {
+    if (dir_page->Size() == DIRECTORY_ARRAY_SIZE) {
+      return false;
+    }
+    dir_page->IncrGlobalDepth();
+  }
+  page_id_t old_page_id = dir_page->GetBucketPageId(bucket_idx);
+  page_id_t new_page_id;
+  auto *new_bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(NewPage(&new_page_id)->GetData());
+  // Lookups may be reading the old bucket, the new one is not reachable yet.
+  Page *old_page = FetchPage(old_page_id);
+  old_page->WLatch();
+  auto *old_bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(old_page->GetData());
+
+  // Entries whose hash has the new local depth bit set move to the new bucket, and so do the directory slots.
+  uint32_t split_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && old_bucket->IsOccupied(i); i++) {
+    if (old_bucket->IsReadable(i) && (Hash(old_bucket->KeyAt(i)) & split_bit) != 0) {
+      new_bucket->Insert(old_bucket->KeyAt(i), old_bucket->ValueAt(i), comparator_);
+      old_bucket->RemoveAt(i);
+    }
+  }
+  old_page->WUnlatch();
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    if (dir_page->GetBucketPageId(i) == old_page_id) {
+      dir_page->IncrLocalDepth(i);
+      if ((i & split_bit) != 0) {
+        dir_page->SetBucketPageId(i, new_page_id);
+      }
+    }
+  }
+  buffer_pool_manager_->UnpinPage(old_page_id, true);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  return true;
 }
 
 /*****************************************************************************
@@ -90,14 +248,73 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = bucket->Remove(key, value, comparator_);
+  bool empty = removed && bucket->IsEmpty();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (empty) {
+    // Merge() checks again that the bucket is still empty.
+    table_latch_.WLock();
+    Merge(transaction, key, value);
+    table_latch_.WUnlock();
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
+/*
+ * Called with the table latch held in write mode. The empty bucket is folded
+ * into its split image, and the directory shrinks while it can.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  // A lookup that pinned a bucket before it was merged away only finds out afterwards, and unpins it then.
+  auto still_pinned = std::remove_if(pending_deletes_.begin(), pending_deletes_.end(),
+                                     [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  pending_deletes_.erase(still_pinned, pending_deletes_.end());
+
+  Page *dir = FetchPage(directory_page_id_);
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(dir->GetData());
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+  HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+  bool empty = bucket->IsEmpty();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  if (!empty || local_depth == 0 || dir_page->GetLocalDepth(image_idx) != local_depth) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    return;
+  }
+
+  dir->WLatch();
+  page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    page_id_t page_id = dir_page->GetBucketPageId(i);
+    if (page_id == bucket_page_id || page_id == image_page_id) {
+      dir_page->SetBucketPageId(i, image_page_id);
+      dir_page->DecrLocalDepth(i);
+    }
+  }
+  while (dir_page->CanShrink()) {
+    dir_page->DecrGlobalDepth();
+  }
+  dir->WUnlatch();
+  if (!buffer_pool_manager_->DeletePage(bucket_page_id)) {
+    pending_deletes_.push_back(bucket_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -134,5 +351,7 @@ template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHashTable<GenericKey<128>, RID, GenericComparator<128>>;
+template class ExtendibleHashTable<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
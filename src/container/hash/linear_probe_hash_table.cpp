@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -23,46 +25,296 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+LINEAR_PROBE_HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      num_slots_(std::max<size_t>(num_buckets, 1)),
+      hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateLayout(num_slots_);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                            std::vector<ValueType> *result) -> bool {
+  table_latch_.RLock();
+  bool found = GetValueFrom(TargetHeaderPageId(), key, result);
+  if (IsResizing()) {
+    found = GetValueFrom(header_page_id_, key, result) || found;
+  }
+  table_latch_.RUnlock();
+  return found;
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetValueFrom(page_id_t header_page_id, const KeyType &key,
+                                                std::vector<ValueType> *result) -> bool {
+  bool found = false;
+  Probe(header_page_id, key, [&](HASH_TABLE_BLOCK_TYPE *block, size_t block_idx, slot_offset_t offset) {
+    if (block != nullptr && block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+    return false;
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Probe(page_id_t header_page_id, const KeyType &key, Visitor visit) -> bool {
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id)->GetData());
+  size_t num_slots = header->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % num_slots;
+  bool stopped = false;
+  bool ended = false;
+  for (size_t probes = 0; probes < num_slots && !stopped && !ended;) {
+    // Visit the slots of one block page, up to its end or the end of the layout, before fetching the next one.
+    size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = header->GetBlockPageId(block_idx);
+    HASH_TABLE_BLOCK_TYPE *block = nullptr;
+    if (block_page_id != INVALID_PAGE_ID) {
+      block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(FetchPage(block_page_id)->GetData());
+    }
+    do {
+      slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+      stopped = visit(block, block_idx, offset);
+      ended = block == nullptr || !block->IsOccupied(offset);
+      probes++;
+      slot = slot + 1 == num_slots ? 0 : slot + 1;
+    } while (!stopped && !ended && probes < num_slots && slot % BLOCK_ARRAY_SIZE != 0);
+    if (block != nullptr) {
+      buffer_pool_manager_->UnpinPage(block_page_id, stopped);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return stopped;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value)
+    -> bool {
+  table_latch_.WLock();
+  if (IsResizing()) {
+    Migrate(MIGRATION_SLOTS_PER_OPERATION);
+  } else if (num_occupied_ * 4 >= num_slots_ * 3 && num_slots_ < HashTableHeaderPage::MAX_BLOCKS * BLOCK_ARRAY_SIZE) {
+    // Three quarters of the slots hold a pair or a tombstone. The new layout is at least as large as this one, so that
+    // it still has room for the pairs inserted while the old one is moved over.
+    BeginResize(num_slots_ / 2);
+    Migrate(MIGRATION_SLOTS_PER_OPERATION);
+  }
+
+  // Pairs that are still in the old layout count as duplicates too.
+  auto is_pair = [&](HASH_TABLE_BLOCK_TYPE *block, size_t block_idx, slot_offset_t offset) {
+    return block != nullptr && block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 &&
+           block->ValueAt(offset) == value;
+  };
+  bool duplicate = IsResizing() && Probe(header_page_id_, key, is_pair);
+  // Every pair of the old layout needs a slot in the new one, so the table is full once it has as many pairs as slots.
+  bool inserted = !duplicate && num_pairs_ < num_slots_ && InsertInto(key, value, true);
+  if (inserted) {
+    num_pairs_++;
+  }
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::InsertInto(const KeyType &key, const ValueType &value, bool check_duplicate)
+    -> bool {
+  page_id_t header_page_id = TargetHeaderPageId();
+  bool duplicate = false;
+  bool free_found = false;
+  size_t free_block_idx = 0;
+  slot_offset_t free_offset = 0;
+  bool free_never_occupied = false;
+  Probe(header_page_id, key, [&](HASH_TABLE_BLOCK_TYPE *block, size_t block_idx, slot_offset_t offset) {
+    if (block != nullptr && block->IsReadable(offset)) {
+      duplicate = check_duplicate && comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value;
+      return duplicate;
+    }
+    if (!free_found) {
+      free_found = true;
+      free_block_idx = block_idx;
+      free_offset = offset;
+      free_never_occupied = block == nullptr || !block->IsOccupied(offset);
+    }
+    // Without a duplicate check the first free slot will do; with one, the probe goes on to the end of the sequence.
+    return !check_duplicate;
+  });
+  if (duplicate || !free_found) {
+    return false;
+  }
+
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id)->GetData());
+  page_id_t block_page_id = header->GetBlockPageId(free_block_idx);
+  Page *page;
+  if (block_page_id == INVALID_PAGE_ID) {
+    page = NewPage(&block_page_id);
+    header->SetBlockPageId(free_block_idx, block_page_id);
+  } else {
+    page = FetchPage(block_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData())->Insert(free_offset, key, value);
+  buffer_pool_manager_->UnpinPage(block_page_id, true);
+  if (free_never_occupied) {
+    num_occupied_++;
+  }
+  return true;
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value)
+    -> bool {
+  table_latch_.WLock();
+  if (IsResizing()) {
+    Migrate(MIGRATION_SLOTS_PER_OPERATION);
+  }
+  bool removed =
+      RemoveFrom(TargetHeaderPageId(), key, value) || (IsResizing() && RemoveFrom(header_page_id_, key, value));
+  if (removed) {
+    num_pairs_--;
+  }
+  table_latch_.WUnlock();
+  return removed;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::RemoveFrom(page_id_t header_page_id, const KeyType &key, const ValueType &value)
+    -> bool {
+  return Probe(header_page_id, key, [&](HASH_TABLE_BLOCK_TYPE *block, size_t block_idx, slot_offset_t offset) {
+    if (block != nullptr && block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 &&
+        block->ValueAt(offset) == value) {
+      block->Remove(offset);
+      return true;
+    }
+    return false;
+  });
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void LINEAR_PROBE_HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  BeginResize(initial_size);
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::BeginResize(size_t initial_size) {
+  if (IsResizing()) {
+    Migrate(SIZE_MAX);
+  }
+  num_slots_ = std::min(2 * std::max({initial_size, num_pairs_, size_t{1}}),
+                        HashTableHeaderPage::MAX_BLOCKS * BLOCK_ARRAY_SIZE);
+  new_header_page_id_ = CreateLayout(num_slots_);
+  migrated_slots_ = 0;
+  num_occupied_ = 0;
+}
+
+/*
+ * A pair moves by being inserted into the new layout and removed from the old
+ * one, where it leaves a tombstone, so that the probe sequences of the pairs
+ * that are still there stay intact. Nothing is inserted into the old layout
+ * any more, so the slots before migrated_slots_ hold no pairs.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::Migrate(size_t num_slots) {
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id_)->GetData());
+  size_t old_num_slots = header->GetSize();
+  size_t end = old_num_slots - migrated_slots_ > num_slots ? migrated_slots_ + num_slots : old_num_slots;
+  while (migrated_slots_ < end) {
+    size_t block_idx = migrated_slots_ / BLOCK_ARRAY_SIZE;
+    size_t block_end = std::min(end, (block_idx + 1) * BLOCK_ARRAY_SIZE);
+    page_id_t block_page_id = header->GetBlockPageId(block_idx);
+    if (block_page_id != INVALID_PAGE_ID) {
+      auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(FetchPage(block_page_id)->GetData());
+      for (size_t slot = migrated_slots_; slot < block_end; slot++) {
+        slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+        if (block->IsReadable(offset)) {
+          InsertInto(block->KeyAt(offset), block->ValueAt(offset), false);
+          block->Remove(offset);
+        }
+      }
+      buffer_pool_manager_->UnpinPage(block_page_id, true);
+    }
+    migrated_slots_ = block_end;
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+
+  if (migrated_slots_ == old_num_slots) {
+    DeleteLayout(header_page_id_);
+    header_page_id_ = new_header_page_id_;
+    new_header_page_id_ = INVALID_PAGE_ID;
+    migrated_slots_ = 0;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::CreateLayout(size_t num_slots) -> page_id_t {
+  page_id_t header_page_id;
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(NewPage(&header_page_id)->GetData());
+  header->SetPageId(header_page_id);
+  header->SetSize(num_slots);
+  for (size_t block_idx = 0; block_idx < (num_slots - 1) / BLOCK_ARRAY_SIZE + 1; block_idx++) {
+    header->AddBlockPageId(INVALID_PAGE_ID);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::DeleteLayout(page_id_t header_page_id) {
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id)->GetData());
+  for (size_t block_idx = 0; block_idx < header->NumBlocks(); block_idx++) {
+    if (header->GetBlockPageId(block_idx) != INVALID_PAGE_ID) {
+      buffer_pool_manager_->DeletePage(header->GetBlockPageId(block_idx));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page from the buffer pool");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::NewPage(page_id_t *page_id) -> Page * {
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+  }
+  return page;
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetSize() -> size_t {
+  table_latch_.RLock();
+  size_t num_slots = num_slots_;
+  table_latch_.RUnlock();
+  return num_slots;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -72,5 +324,7 @@ template class LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>>;
 template class LinearProbeHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class LinearProbeHashTable<GenericKey<128>, RID, GenericComparator<128>>;
+template class LinearProbeHashTable<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
@@ -11,12 +11,92 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "execution/expressions/column_value_expression.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+
+  std::vector<uint32_t> columns;
+  for (const auto &column : GetOutputSchema()->GetColumns()) {
+    CollectColumns(column.GetExpr(), &columns);
+  }
+  CollectColumns(plan_->GetPredicate(), &columns);
+  index_only_ = index_info_->index_->CoversColumns(columns);
+  placeholders_.clear();
+  for (const auto &column : table_info_->schema_.GetColumns()) {
+    // Any value will do, nothing reads it. VARCHAR NULLs cannot be serialized into a tuple.
+    placeholders_.push_back(column.GetType() == TypeId::VARCHAR ? ValueFactory::GetVarcharValue("")
+                                                                 : ValueFactory::GetNullValueByType(column.GetType()));
+  }
+
+  auto *index = index_info_->index_.get();
+  auto *txn = exec_ctx_->GetTransaction();
+  switch (plan_->GetScanType()) {
+    case IndexScanType::FULL:
+      cursor_ = index->GetEntryCursor(txn);
+      break;
+    case IndexScanType::EQUALITY:
+      cursor_ = index->GetEntryCursor(Tuple(plan_->GetLowKey(), index->GetKeySchema()), txn);
+      break;
+    case IndexScanType::RANGE:
+      cursor_ = index->GetEntryCursor(Tuple(plan_->GetLowKey(), index->GetKeySchema()),
+                                      Tuple(plan_->GetHighKey(), index->GetKeySchema()), txn);
+      break;
+  }
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto *table_schema = &table_info_->schema_;
+  Tuple entry;
+  RID entry_rid;
+  while (cursor_->Next(&entry, &entry_rid)) {
+    Tuple row;
+    if (index_only_) {
+      row = TupleFromEntry(entry);
+    } else if (!table_info_->table_->GetTuple(entry_rid, &row, exec_ctx_->GetTransaction())) {
+      continue;
+    }
+    if (plan_->GetPredicate() != nullptr && !plan_->GetPredicate()->Evaluate(&row, table_schema).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema()->GetColumnCount());
+    for (const auto &column : GetOutputSchema()->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&row, table_schema));
+    }
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = entry_rid;
+    return true;
+  }
+  return false;
+}
 
-void IndexScanExecutor::Init() {}
+void IndexScanExecutor::CollectColumns(const AbstractExpression *expr, std::vector<uint32_t> *columns) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    columns->push_back(column->GetColIdx());
+  }
+  for (const auto *child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::TupleFromEntry(const Tuple &entry) const -> Tuple {
+  std::vector<Value> values = placeholders_;
+  const auto &entry_attrs = index_info_->index_->GetEntryAttrs();
+  for (uint32_t i = 0; i < entry_attrs.size(); i++) {
+    values[entry_attrs[i]] = entry.GetValue(index_info_->index_->GetEntrySchema(), i);
+  }
+  return Tuple(values, &table_info_->schema_);
+}
 
 }  // namespace bustub
@@ -16,10 +16,67 @@ namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void NestIndexJoinExecutor::Init() {}
+void NestIndexJoinExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  index_info_ = catalog->GetIndex(plan_->GetIndexName(), inner_table_info_->name_);
+  child_executor_->Init();
+  results_.clear();
+  result_index_ = 0;
+}
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (result_index_ == results_.size()) {
+    if (!JoinNextBatch()) {
+      return false;
+    }
+  }
+  *tuple = results_[result_index_++];
+  return true;
+}
+
+auto NestIndexJoinExecutor::JoinNextBatch() -> bool {
+  results_.clear();
+  result_index_ = 0;
+  const auto *outer_schema = plan_->OuterTableSchema();
+  std::vector<Tuple> outer_tuples;
+  std::vector<Tuple> keys;
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples.size() < OUTER_BATCH_SIZE && child_executor_->Next(&outer_tuple, &outer_rid)) {
+    Value key = plan_->Predicate()->GetChildAt(0)->Evaluate(&outer_tuple, outer_schema);
+    keys.emplace_back(std::vector<Value>{key}, &index_info_->key_schema_);
+    outer_tuples.push_back(outer_tuple);
+  }
+  if (outer_tuples.empty()) {
+    return false;
+  }
+
+  std::vector<std::vector<RID>> inner_rids;
+  index_info_->index_->ScanKeys(keys, &inner_rids, exec_ctx_->GetTransaction());
+  const auto *inner_schema = plan_->InnerTableSchema();
+  const auto &columns = GetOutputSchema()->GetColumns();
+  for (size_t i = 0; i < outer_tuples.size(); i++) {
+    for (const auto &inner_rid : inner_rids[i]) {
+      Tuple inner_tuple;
+      if (!inner_table_info_->table_->GetTuple(inner_rid, &inner_tuple, exec_ctx_->GetTransaction())) {
+        continue;
+      }
+      Value match = plan_->Predicate()->EvaluateJoin(&outer_tuples[i], outer_schema, &inner_tuple, inner_schema);
+      if (!match.GetAs<bool>()) {
+        continue;
+      }
+      std::vector<Value> values;
+      values.reserve(columns.size());
+      for (const auto &column : columns) {
+        values.push_back(column.GetExpr()->EvaluateJoin(&outer_tuples[i], outer_schema, &inner_tuple, inner_schema));
+      }
+      results_.emplace_back(values, GetOutputSchema());
+    }
+  }
+  return true;
+}
 
 }  // namespace bustub
@@ -21,8 +21,11 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/cuckoo_hash_table_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -34,6 +37,17 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/**
+ * The kind of index that Catalog::CreateIndex builds. B+ tree indexes over GenericKey<32> and wider keep their keys
+ * in slotted, prefix-compressed pages (see BPlusTreeCompressedPage), so variable-length columns such as URLs or email
+ * addresses can be indexed in a GenericKey<128> or GenericKey<256> while only paying for the bytes they use.
+ * CUCKOO_HASH suits pure point-lookup workloads such as primary keys: a lookup reads at most two bucket pages.
+ * LINEAR_PROBE_HASH keeps its slots in contiguous block pages and grows incrementally, see LinearProbeHashTable.
+ * Only BPLUS_TREE indexes are ordered, so only they serve range scans (see IndexScanPlanNode); the hash indexes only
+ * serve equality lookups.
+ */
+enum class IndexType { EXTENDIBLE_HASH, BPLUS_TREE, CUCKOO_HASH, LINEAR_PROBE_HASH };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -185,13 +199,18 @@ class Catalog {
    * @param key_schema The schema of the key
    * @param key_attrs Key attributes
    * @param keysize Size of the key
-   * @param hash_function The hash function for the index
+   * @param hash_function The hash function for the index, unused by B+ tree indexes
+   * @param index_type The kind of index to build
+   * @param include_attrs Table columns stored in the leaves after the key, so that scans that only read key and
+   * included columns never fetch the tuple (see IndexScanExecutor). Only B+ tree indexes include columns, and every
+   * entry must fit into the key without truncation.
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::EXTENDIBLE_HASH,
+                   const std::vector<uint32_t> &include_attrs = {}) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -208,21 +227,42 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, include_attrs);
+    if (!include_attrs.empty() &&
+        (index_type != IndexType::BPLUS_TREE || KeyType::MaxEncodedSize(*meta->GetEntrySchema()) > keysize)) {
+      return NULL_INDEX_INFO;
+    }
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::BPLUS_TREE) {
+      index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_, lock_manager_);
+    } else if (index_type == IndexType::CUCKOO_HASH) {
+      index = std::make_unique<CuckooHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                       hash_function);
+    } else if (index_type == IndexType::LINEAR_PROBE_HASH) {
+      index = std::make_unique<LinearProbeHashTableIndex<KeyType, ValueType, KeyComparator>>(
+          std::move(meta), bpm_, LINEAR_PROBE_INITIAL_SLOTS, hash_function);
+    } else {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                           hash_function);
+    }
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
-    }
+    auto tuple = heap->Begin(txn);
+    index->InsertEntries(
+        [&](Tuple *key, RID *rid) {
+          if (tuple == heap->End()) {
+            return false;
+          }
+          *key = tuple->KeyFromTuple(schema, *index->GetEntrySchema(), index->GetEntryAttrs());
+          *rid = tuple->GetRid();
+          ++tuple;
+          return true;
+        },
+        txn);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -323,6 +363,9 @@ class Catalog {
   }
 
  private:
+  /** The number of slots that a new linear probe hash index starts with, it grows as entries come in. */
+  static constexpr size_t LINEAR_PROBE_INITIAL_SLOTS = 1024;
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// background_worker.h
+//
+// Identification: src/include/common/background_worker.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BackgroundWorker runs tasks on a single thread of its own, one after the other in the order they were submitted.
+ *
+ * The thread is started by the first Submit(), so an owner that never submits anything costs no thread. Tasks must
+ * not block on anything that their submitters may hold, since every task queued behind them waits as well.
+ */
+class BackgroundWorker {
+ public:
+  BackgroundWorker() = default;
+
+  /** Runs the tasks that are still queued, then stops the thread. */
+  ~BackgroundWorker();
+
+  DISALLOW_COPY_AND_MOVE(BackgroundWorker);
+
+  /** Queues a task to run on the worker thread. */
+  void Submit(std::function<void()> task);
+
+ private:
+  void Run();
+
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopped_{false};
+  std::thread thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/common/epoch_manager.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * EpochManager implements epoch-based memory reclamation for concurrent data structures.
+ *
+ * Readers pin the current epoch for the duration of an access. A writer that unlinks an object retires it instead of
+ * freeing it; the object is freed once the global epoch has advanced twice past its retirement, at which point no
+ * reader that could still hold a reference remains pinned.
+ *
+ * Threads are registered implicitly on their first Pin() or Retire() and are mapped onto a fixed number of slots, so
+ * any thread can use any EpochManager without setup or teardown.
+ */
+class EpochManager {
+  /** Number of per-thread slots; threads beyond this share slots, which is correct but may contend. */
+  static constexpr size_t NUM_SLOTS = 64;
+  /** Number of retired objects in a slot after which Retire() tries to reclaim. */
+  static constexpr size_t COLLECT_THRESHOLD = 64;
+
+ public:
+  /** An epoch pin, released on destruction. Protects every object reachable while it is held. */
+  class Guard {
+   public:
+    Guard(EpochManager *manager, size_t slot, size_t parity) : manager_(manager), slot_(slot), parity_(parity) {}
+    Guard(Guard &&other) noexcept : manager_(other.manager_), slot_(other.slot_), parity_(other.parity_) {
+      other.manager_ = nullptr;
+    }
+    ~Guard() {
+      if (manager_ != nullptr) {
+        manager_->Unpin(slot_, parity_);
+      }
+    }
+
+    DISALLOW_COPY(Guard);
+    auto operator=(Guard &&other) -> Guard & = delete;
+
+   private:
+    EpochManager *manager_;
+    size_t slot_;
+    size_t parity_;
+  };
+
+  EpochManager() = default;
+
+  /** Frees every object still retired. No thread may be pinned. */
+  ~EpochManager();
+
+  DISALLOW_COPY_AND_MOVE(EpochManager);
+
+  /** @return the slot of the calling thread, registering it on first use */
+  static auto RegisterThread() -> size_t;
+
+  /**
+   * Pins the current epoch for the calling thread.
+   * @return a guard that unpins when it goes out of scope
+   */
+  auto Pin() -> Guard;
+
+  /**
+   * Defers freeing an object that has already been unlinked from the shared structure.
+   * @param ptr the object to free
+   * @param deleter the function that frees it
+   */
+  void Retire(void *ptr, void (*deleter)(void *));
+
+  /** Defers deleting an object that has already been unlinked from the shared structure. */
+  template <typename T>
+  void Retire(T *ptr) {
+    Retire(static_cast<void *>(ptr), [](void *p) { delete static_cast<T *>(p); });
+  }
+
+  /** Tries to advance the global epoch and frees whatever has become safe to free. */
+  void Collect();
+
+  /** Blocks until every pin taken before the call is released. The calling thread must not hold a pin. */
+  void Synchronize();
+
+  /** @return the current global epoch */
+  auto GetEpoch() const -> uint64_t { return epoch_.load(); }
+
+  /** @return the number of retired objects not yet freed */
+  auto GetRetiredCount() -> size_t;
+
+ private:
+  struct Retired {
+    void *ptr_;
+    void (*deleter_)(void *);
+    uint64_t epoch_;
+  };
+
+  struct alignas(64) Slot {
+    /** Number of pins taken in an even and an odd epoch. Only two epochs can have pinned readers at a time. */
+    std::array<std::atomic<uint32_t>, 2> pins_{};
+    std::mutex retired_latch_;
+    std::vector<Retired> retired_;
+  };
+
+  void Unpin(size_t slot, size_t parity) { slots_[slot].pins_[parity].fetch_sub(1); }
+
+  /** Advances the epoch if nobody is pinned in the previous one. @return true if the epoch advanced */
+  auto TryAdvance() -> bool;
+
+  /** Frees the retired objects of the slot that no pinned reader can reach anymore. */
+  void Reclaim(Slot *slot);
+
+  std::atomic<uint64_t> epoch_{2};
+  std::array<Slot, NUM_SLOTS> slots_;
+};
+
+}  // namespace bustub
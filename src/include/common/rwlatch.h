@@ -12,25 +12,36 @@
 
 #pragma once
 
-#include <climits>
+#include <atomic>
 #include <condition_variable>  // NOLINT
-#include <mutex>               // NOLINT
+#include <cstdint>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 #include "common/macros.h"
 
 namespace bustub {
 
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Reader-Writer latch backed by a single atomic word.
+ *
+ * The word holds the reader count, a writer bit and a writer-waiting bit, so an uncontended RLock/RUnlock is one
+ * atomic read-modify-write each. A thread that cannot acquire the latch spins for a short while and then parks on a
+ * condition variable; the mutex is only touched by unlockers when somebody is actually parked.
+ *
+ * With writer preference (the default), a waiting writer stops new readers from entering so that a steady stream of
+ * readers cannot starve it. Without it, readers are admitted whenever no writer holds the latch.
  */
 class ReaderWriterLatch {
-  using mutex_t = std::mutex;
-  using cond_t = std::condition_variable;
-  static const uint32_t MAX_READERS = UINT_MAX;
+  static constexpr uint32_t WRITER = 1U << 31;
+  static constexpr uint32_t WRITER_WAITING = 1U << 30;
+  static constexpr uint32_t MAX_READERS = WRITER_WAITING - 1;
+  /** Number of failed attempts before a thread parks. */
+  static constexpr int SPIN_COUNT = 64;
 
  public:
-  ReaderWriterLatch() = default;
-  ~ReaderWriterLatch() { std::lock_guard<mutex_t> guard(mutex_); }
+  explicit ReaderWriterLatch(bool prefer_writers = true) : prefer_writers_(prefer_writers) {}
+  ~ReaderWriterLatch() = default;
 
   DISALLOW_COPY(ReaderWriterLatch);
 
@@ -38,13 +49,16 @@ class ReaderWriterLatch {
    * Acquire a write latch.
    */
   void WLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_) {
-      reader_.wait(latch);
-    }
-    writer_entered_ = true;
-    while (reader_count_ > 0) {
-      writer_.wait(latch);
+    for (int spins = 0; !TryWLock(); spins++) {
+      if (spins >= SPIN_COUNT) {
+        Park([this] {
+          AnnounceWriter();
+          return TryWLock();
+        });
+        return;
+      }
+      AnnounceWriter();
+      std::this_thread::yield();
     }
   }
 
@@ -52,45 +66,89 @@ class ReaderWriterLatch {
    * Release a write latch.
    */
   void WUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    writer_entered_ = false;
-    reader_.notify_all();
+    state_.fetch_and(~WRITER);
+    WakeParked();
   }
 
   /**
    * Acquire a read latch.
    */
   void RLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_ || reader_count_ == MAX_READERS) {
-      reader_.wait(latch);
+    for (int spins = 0; !TryRLock(); spins++) {
+      if (spins >= SPIN_COUNT) {
+        Park([this] { return TryRLock(); });
+        return;
+      }
+      std::this_thread::yield();
     }
-    reader_count_++;
   }
 
   /**
    * Release a read latch.
    */
   void RUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    reader_count_--;
-    if (writer_entered_) {
-      if (reader_count_ == 0) {
-        writer_.notify_one();
+    state_.fetch_sub(1);
+    WakeParked();
+  }
+
+  /**
+   * Try to acquire a write latch without blocking.
+   * @return true if the write latch is now held
+   */
+  auto TryWLock() -> bool {
+    uint32_t state = state_.load();
+    while ((state & (WRITER | MAX_READERS)) == 0) {
+      // Clears WRITER_WAITING as well; other waiting writers set it again on their next attempt.
+      if (state_.compare_exchange_weak(state, WRITER)) {
+        return true;
       }
-    } else {
-      if (reader_count_ == MAX_READERS - 1) {
-        reader_.notify_one();
+    }
+    return false;
+  }
+
+  /**
+   * Try to acquire a read latch without blocking.
+   * @return true if a read latch is now held
+   */
+  auto TryRLock() -> bool {
+    const uint32_t blocked = prefer_writers_ ? (WRITER | WRITER_WAITING) : WRITER;
+    uint32_t state = state_.load();
+    while ((state & blocked) == 0 && (state & MAX_READERS) != MAX_READERS) {
+      if (state_.compare_exchange_weak(state, state + 1)) {
+        return true;
       }
     }
+    return false;
   }
 
  private:
-  mutex_t mutex_;
-  cond_t writer_;
-  cond_t reader_;
-  uint32_t reader_count_{0};
-  bool writer_entered_{false};
+  void AnnounceWriter() {
+    if (prefer_writers_) {
+      state_.fetch_or(WRITER_WAITING);
+    }
+  }
+
+  /** Blocks until acquire() succeeds. Registering in parked_ before re-checking pairs with WakeParked(). */
+  template <typename Acquire>
+  void Park(Acquire acquire) {
+    std::unique_lock<std::mutex> guard(mutex_);
+    parked_.fetch_add(1);
+    cond_.wait(guard, acquire);
+    parked_.fetch_sub(1);
+  }
+
+  void WakeParked() {
+    if (parked_.load() > 0) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      cond_.notify_all();
+    }
+  }
+
+  const bool prefer_writers_;
+  std::atomic<uint32_t> state_{0};
+  std::atomic<uint32_t> parked_{0};
+  std::mutex mutex_;
+  std::condition_variable cond_;
 };
 
 }  // namespace bustub
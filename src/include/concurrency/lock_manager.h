@@ -13,10 +13,13 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <chrono>  // NOLINT
 #include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -51,9 +54,80 @@ class LockManager {
     std::condition_variable cv_;
     // txn_id of an upgrading transaction (if any)
     txn_id_t upgrading_ = INVALID_TXN_ID;
+    // contention statistics, protected by the lock manager latch
+    uint64_t wait_count_{0};
+    uint64_t total_wait_us_{0};
+    uint64_t max_wait_us_{0};
+    uint64_t upgrade_conflicts_{0};
   };
 
  public:
+  /** The lock operations whose latency is tracked. */
+  enum class LockOperation { SHARED, EXCLUSIVE, UPGRADE };
+
+  /**
+   * Histogram of latencies with power-of-two microsecond buckets: bucket 0 counts latencies below 1us and bucket i
+   * counts latencies in [2^(i-1), 2^i) us. The last bucket also takes everything above its range.
+   */
+  class LatencyHistogram {
+   public:
+    static constexpr size_t NUM_BUCKETS = 32;
+
+    void Record(uint64_t latency_us) {
+      size_t bucket = 0;
+      while (latency_us != 0 && bucket < NUM_BUCKETS - 1) {
+        latency_us >>= 1;
+        bucket++;
+      }
+      buckets_[bucket]++;
+      count_++;
+    }
+
+    /** @return the number of recorded latencies */
+    auto GetCount() const -> uint64_t { return count_; }
+
+    /** @return the number of recorded latencies in the given bucket */
+    auto GetBucketCount(size_t bucket) const -> uint64_t { return buckets_[bucket]; }
+
+    /** @return the exclusive upper bound in us of the given bucket */
+    static auto GetBucketBound(size_t bucket) -> uint64_t { return uint64_t{1} << bucket; }
+
+    /**
+     * @param percentile a value in [0, 100]
+     * @return the upper bound in us of the bucket that holds the given percentile, 0 if nothing was recorded
+     */
+    auto GetPercentile(double percentile) const -> uint64_t {
+      auto rank = static_cast<uint64_t>(percentile / 100 * count_);
+      uint64_t seen = 0;
+      for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        seen += buckets_[bucket];
+        if (seen > rank || (seen == count_ && count_ != 0)) {
+          return GetBucketBound(bucket);
+        }
+      }
+      return 0;
+    }
+
+   private:
+    std::array<uint64_t, NUM_BUCKETS> buckets_{};
+    uint64_t count_{0};
+  };
+
+  /** Contention statistics of a single lock object, as returned by GetContentionSnapshot(). */
+  struct LockContention {
+    RID rid_;
+    /** Number of requests that could not be granted right away. */
+    uint64_t wait_count_;
+    uint64_t total_wait_us_;
+    uint64_t max_wait_us_;
+    /** Number of upgrades aborted because another transaction was already upgrading. */
+    uint64_t upgrade_conflicts_;
+    /** Transactions currently holding the lock. */
+    std::vector<txn_id_t> holders_;
+    /** Transactions currently waiting for the lock, in queue order. */
+    std::vector<txn_id_t> waiters_;
+  };
+
   /**
    * Creates a new lock manager configured for the deadlock prevention policy.
    */
@@ -104,11 +178,84 @@ class LockManager {
    */
   auto Unlock(Transaction *txn, const RID &rid) -> bool;
 
+  /*
+   * [KEY_RANGE_NOTE]: Indexes implement next-key locking on top of the RID locks. The lock on an index key covers the
+   * key itself and the gap between it and the preceding key; the supremum of an index covers the gap above its
+   * largest key. A range scan locks every key it returns plus the first key past its upper bound in shared mode, and
+   * an insert or delete locks the affected key and its successor exclusively, so a key can only appear in or vanish
+   * from a scanned range once the scanning transaction has released its locks.
+   *
+   * Key-range resources are RIDs with a negative page id, so they never collide with tuple locks. Different keys may
+   * hash to the same resource, which only causes false conflicts.
+   */
+
+  /**
+   * @param index_name the name of the index
+   * @param key the raw bytes of the key
+   * @param key_size the number of bytes of the key
+   * @return the lock resource of the key and the gap below it. See [KEY_RANGE_NOTE].
+   */
+  static auto KeyRangeResource(const std::string &index_name, const char *key, size_t key_size) -> RID;
+
+  /**
+   * @param index_name the name of the index
+   * @return the lock resource of the gap above the largest key of the index. See [KEY_RANGE_NOTE].
+   */
+  static auto KeyRangeSupremum(const std::string &index_name) -> RID;
+
+  /**
+   * Lists the most contended lock objects, e.g. to find hot rows.
+   * @param n the maximum number of lock objects to return
+   * @return the lock objects that have been or are being waited on, ordered by total wait time, longest first
+   */
+  auto GetContentionSnapshot(size_t n) -> std::vector<LockContention>;
+
+  /**
+   * @param operation the lock operation
+   * @return the latencies of the granted requests of the given operation, including the time spent waiting
+   */
+  auto GetLatencyHistogram(LockOperation operation) -> LatencyHistogram;
+
+  /** Clears all contention counters and latency histograms. */
+  void ResetStatistics();
+
  private:
+  /**
+   * Abort the transaction and throw a TransactionAbortException.
+   * @param txn the transaction to be aborted
+   * @param abort_reason the reason of the abortion
+   */
+  void AbortImplicitly(Transaction *txn, AbortReason abort_reason);
+
+  /**
+   * Wound-wait: abort every younger transaction in the queue whose request conflicts with the given mode.
+   * @param queue the request queue of the RID being locked
+   * @param txn the (older) transaction requesting the lock
+   * @param lock_mode the mode requested by txn
+   */
+  void WoundYounger(LockRequestQueue *queue, Transaction *txn, LockMode lock_mode);
+
+  /** @return true if the request pointed to by it can be granted, i.e. it is compatible with all requests before it */
+  auto IsCompatible(LockRequestQueue *queue, std::list<LockRequest>::iterator it) -> bool;
+
+  /**
+   * Block until the request pointed to by it is compatible or txn is wounded.
+   * @return true if the request can be granted, false if txn was aborted while waiting
+   */
+  auto WaitForGrant(Transaction *txn, const RID &rid, LockRequestQueue *queue, std::list<LockRequest>::iterator it,
+                    std::unique_lock<std::mutex> *guard) -> bool;
+
+  /** Records the latency of a granted request that started at start. */
+  void RecordLatency(LockOperation operation, std::chrono::steady_clock::time_point start);
+
   std::mutex latch_;
 
   /** Lock table for lock requests. */
   std::unordered_map<RID, LockRequestQueue> lock_table_;
+  /** The RID each blocked transaction is waiting on, so that a wounded waiter can be woken up wherever it sleeps. */
+  std::unordered_map<txn_id_t, RID> waits_for_;
+  /** Latency histograms, indexed by LockOperation. */
+  std::array<LatencyHistogram, 3> latencies_;
 };
 
 }  // namespace bustub
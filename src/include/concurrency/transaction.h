@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
 
 #include "common/config.h"
@@ -48,6 +49,16 @@ enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
  */
 enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
 
+/**
+ * Concurrency control protocol of a transaction.
+ *
+ * TWO_PHASE_LOCKING transactions take locks through the LockManager and write in place.
+ * OPTIMISTIC transactions read without locks, and TableHeap buffers their updates and deletes in the buffered write
+ * set; the buffered writes are validated and applied at commit. Their inserts are applied at once, see
+ * TableHeap::InsertTuple().
+ */
+enum class ConcurrencyMode { TWO_PHASE_LOCKING, OPTIMISTIC };
+
 /**
  * Type of write operation.
  */
@@ -60,6 +71,9 @@ using index_oid_t = uint32_t;
 
 /**
  * WriteRecord tracks information related to a write.
+ *
+ * In the write set the write has already been applied and the record is used for undo. In the buffered write set of
+ * an optimistic transaction the record is a write that is applied at commit, and tuple_ holds the new image.
  */
 class TableWriteRecord {
  public:
@@ -68,7 +82,7 @@ class TableWriteRecord {
 
   RID rid_;
   WType wtype_;
-  /** The tuple is only used for the update operation. */
+  /** The tuple is the old image of an applied update, or the new image of a buffered update. */
   Tuple tuple_;
   /** The table heap specifies which table this write record is for. */
   TableHeap *table_;
@@ -113,7 +127,8 @@ enum class AbortReason {
   UNLOCK_ON_SHRINKING,
   UPGRADE_CONFLICT,
   DEADLOCK,
-  LOCKSHARED_ON_READ_UNCOMMITTED
+  LOCKSHARED_ON_READ_UNCOMMITTED,
+  VALIDATION_FAILED
 };
 
 /**
@@ -143,6 +158,8 @@ class TransactionAbortException : public std::exception {
         return "Transaction " + std::to_string(txn_id_) + " aborted on deadlock\n";
       case AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED:
         return "Transaction " + std::to_string(txn_id_) + " aborted on lockshared on READ_UNCOMMITTED\n";
+      case AbortReason::VALIDATION_FAILED:
+        return "Transaction " + std::to_string(txn_id_) + " aborted because its read set failed validation\n";
     }
     // Todo: Should fail with unreachable.
     return "";
@@ -154,9 +171,11 @@ class TransactionAbortException : public std::exception {
  */
 class Transaction {
  public:
-  explicit Transaction(txn_id_t txn_id, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ)
+  explicit Transaction(txn_id_t txn_id, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+                       ConcurrencyMode concurrency_mode = ConcurrencyMode::TWO_PHASE_LOCKING)
       : state_(TransactionState::GROWING),
         isolation_level_(isolation_level),
+        concurrency_mode_(concurrency_mode),
         thread_id_(std::this_thread::get_id()),
         txn_id_(txn_id),
         prev_lsn_(INVALID_LSN),
@@ -164,9 +183,11 @@ class Transaction {
         exclusive_lock_set_{new std::unordered_set<RID>} {
     // Initialize the sets that will be tracked.
     table_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
+    buffered_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
     page_set_ = std::make_shared<std::deque<bustub::Page *>>();
     deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
+    read_set_ = std::make_shared<std::unordered_map<RID, uint64_t>>();
   }
 
   ~Transaction() = default;
@@ -182,9 +203,15 @@ class Transaction {
   /** @return the isolation level of this transaction */
   inline auto GetIsolationLevel() const -> IsolationLevel { return isolation_level_; }
 
+  /** @return the concurrency control protocol of this transaction */
+  inline auto GetConcurrencyMode() const -> ConcurrencyMode { return concurrency_mode_; }
+
   /** @return the list of table write records of this transaction */
   inline auto GetWriteSet() -> std::shared_ptr<std::deque<TableWriteRecord>> { return table_write_set_; }
 
+  /** @return the writes that this optimistic transaction has buffered until commit */
+  inline auto GetBufferedWriteSet() -> std::shared_ptr<std::deque<TableWriteRecord>> { return buffered_write_set_; }
+
   /** @return the list of index write records of this transaction */
   inline auto GetIndexWriteSet() -> std::shared_ptr<std::deque<IndexWriteRecord>> { return index_write_set_; }
 
@@ -236,6 +263,26 @@ class Transaction {
     return exclusive_lock_set_->find(rid) != exclusive_lock_set_->end();
   }
 
+  /** @return the tuple versions observed by this optimistic transaction */
+  inline auto GetReadSet() -> std::shared_ptr<std::unordered_map<RID, uint64_t>> { return read_set_; }
+
+  /**
+   * Records the version of a tuple read by an optimistic transaction. Only the first read of a RID is kept, since
+   * that is the version the transaction's later decisions depend on.
+   * @param rid the RID that was read
+   * @param version the version of the tuple at the time of the read
+   */
+  inline void AddIntoReadSet(const RID &rid, uint64_t version) { read_set_->emplace(rid, version); }
+
+  /** @return the version clock at the time this optimistic transaction began */
+  inline auto GetStartVersion() const -> uint64_t { return start_version_; }
+
+  /**
+   * Set the version clock at the time this optimistic transaction began.
+   * @param start_version the version clock reading
+   */
+  inline void SetStartVersion(uint64_t start_version) { start_version_ = start_version; }
+
   /** @return the current state of the transaction */
   inline auto GetState() -> TransactionState { return state_; }
 
@@ -259,6 +306,8 @@ class Transaction {
   TransactionState state_;
   /** The isolation level of the transaction. */
   IsolationLevel isolation_level_;
+  /** The concurrency control protocol of the transaction. */
+  ConcurrencyMode concurrency_mode_;
   /** The thread ID, used in single-threaded transactions. */
   std::thread::id thread_id_;
   /** The ID of this transaction. */
@@ -266,6 +315,8 @@ class Transaction {
 
   /** The undo set of table tuples. */
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
+  /** OCC: the table writes that are applied at commit. */
+  std::shared_ptr<std::deque<TableWriteRecord>> buffered_write_set_;
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
@@ -280,6 +331,11 @@ class Transaction {
   std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
   /** LockManager: the set of exclusive-locked tuples held by this transaction. */
   std::shared_ptr<std::unordered_set<RID>> exclusive_lock_set_;
+
+  /** OCC: the version of every tuple read by this transaction, validated at commit. */
+  std::shared_ptr<std::unordered_map<RID, uint64_t>> read_set_;
+  /** OCC: the version clock when the transaction began. Versions up to it are dropped once it has ended. */
+  uint64_t start_version_{0};
 };
 
 }  // namespace bustub
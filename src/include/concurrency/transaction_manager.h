@@ -12,12 +12,17 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
-#include <shared_mutex>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "common/config.h"
+#include "common/epoch_manager.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
 #include "recovery/log_manager.h"
@@ -25,6 +30,100 @@
 namespace bustub {
 class LockManager;
 
+/**
+ * TransactionMap is a concurrent map from transaction id to running transaction. It is striped by transaction id.
+ * Each shard is copy-on-write: writers serialize on the shard latch and publish a new table, lookups take no latch and
+ * are protected by an epoch pin, and replaced tables are reclaimed through the EpochManager.
+ */
+class TransactionMap {
+ public:
+  TransactionMap() = default;
+  ~TransactionMap();
+
+  DISALLOW_COPY_AND_MOVE(TransactionMap);
+
+  /** Registers the transaction under its id, replacing any previous entry. */
+  void Insert(Transaction *txn);
+
+  /** Unregisters the transaction with the given id, if any. */
+  void Erase(txn_id_t txn_id);
+
+  /** @return the transaction with the given id, nullptr if there is none */
+  auto Find(txn_id_t txn_id) -> Transaction *;
+
+ private:
+  static constexpr size_t NUM_SHARDS = 64;
+  using Table = std::unordered_map<txn_id_t, Transaction *>;
+
+  struct alignas(64) Shard {
+    std::mutex latch_;
+    std::atomic<Table *> table_{nullptr};
+  };
+
+  /** Publishes a copy of the shard's table with modify() applied to it. */
+  template <typename Modify>
+  void Update(txn_id_t txn_id, Modify modify);
+
+  auto ShardOf(txn_id_t txn_id) -> Shard & { return shards_[static_cast<size_t>(txn_id) % NUM_SHARDS]; }
+
+  std::array<Shard, NUM_SHARDS> shards_;
+  EpochManager epoch_manager_;
+};
+
+/**
+ * TupleVersionTable holds the versions of the tuples written by optimistic transactions, against which their readers
+ * validate at commit. Versions are drawn from a single clock, so a tuple never gets back a version it had before, and
+ * a read stays valid as long as the tuple's version is not newer than the one that was read.
+ *
+ * A tuple without an entry reads as version 0. An entry is dropped once every running optimistic transaction began
+ * after it was written: none of them can have read the tuple before the write, so the entry fails no validation that
+ * a missing one passes.
+ */
+class TupleVersionTable {
+ public:
+  TupleVersionTable() = default;
+  ~TupleVersionTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(TupleVersionTable);
+
+  /** Starts tracking an optimistic transaction, keeping the versions that it may still read from being dropped. */
+  void Begin(Transaction *txn);
+
+  /** Stops tracking the transaction and drops the versions that no running transaction still needs. */
+  void End(Transaction *txn);
+
+  /** @return the version of the tuple, 0 if it has none */
+  auto Get(const RID &rid) -> uint64_t;
+
+  /** Gives the tuple a new version, invalidating the concurrent readers of the old one. */
+  void Bump(const RID &rid);
+
+  /** @return true if the tuple has not been written since a read that saw the given version */
+  auto Validate(const RID &rid, uint64_t version) -> bool { return Get(rid) <= version; }
+
+  /** @return the number of tuples that have a version */
+  auto Size() -> size_t;
+
+ private:
+  /** Shard of the versions, so that optimistic reads do not contend on a single latch. */
+  struct VersionShard {
+    std::mutex latch_;
+    std::unordered_map<RID, uint64_t> versions_;
+  };
+  static constexpr size_t NUM_SHARDS = 16;
+
+  auto ShardOf(const RID &rid) -> VersionShard & { return shards_[std::hash<RID>()(rid) % NUM_SHARDS]; }
+
+  std::array<VersionShard, NUM_SHARDS> shards_;
+  /** Guards the clock, the log and the start versions, so that a transaction begins either before or after a bump. */
+  std::mutex latch_;
+  uint64_t clock_{0};
+  /** Every version handed out that may still be in the shards, oldest first. */
+  std::deque<std::pair<uint64_t, RID>> log_;
+  /** Start versions of the running optimistic transactions. */
+  std::multiset<uint64_t> active_;
+};
+
 /**
  * TransactionManager keeps track of all the transactions running in the system.
  */
@@ -39,13 +138,15 @@ class TransactionManager {
    * Begins a new transaction.
    * @param txn an optional transaction object to be initialized, otherwise a new transaction is created.
    * @param isolation_level an optional isolation level of the transaction.
+   * @param concurrency_mode an optional concurrency control protocol of the transaction.
    * @return an initialized transaction
    */
-  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ)
-      -> Transaction *;
+  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+             ConcurrencyMode concurrency_mode = ConcurrencyMode::TWO_PHASE_LOCKING) -> Transaction *;
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. Optimistic transactions are validated first; on a conflict the transaction is aborted and
+   * a TransactionAbortException with AbortReason::VALIDATION_FAILED is thrown.
    * @param txn the transaction to commit
    */
   void Commit(Transaction *txn);
@@ -61,24 +162,28 @@ class TransactionManager {
    */
 
   /** The transaction map is a global list of all the running transactions in the system. */
-  static std::unordered_map<txn_id_t, Transaction *> txn_map;
-  static std::shared_mutex txn_map_mutex;
+  static TransactionMap txn_map;
 
   /**
-   * Locates and returns the transaction with the given transaction ID.
+   * Locates and returns the transaction with the given transaction ID. Transactions are unregistered when they commit
+   * or abort, so the returned pointer is only safe to use while the caller knows the transaction is still running,
+   * e.g. because it has a request in a lock queue the caller has latched.
    * @param txn_id the id of the transaction to be found, it must exist!
    * @return the transaction with the given transaction id
    */
   static auto GetTransaction(txn_id_t txn_id) -> Transaction * {
-    TransactionManager::txn_map_mutex.lock_shared();
-    assert(TransactionManager::txn_map.find(txn_id) != TransactionManager::txn_map.end());
-    auto *res = TransactionManager::txn_map[txn_id];
+    auto *res = TransactionManager::txn_map.Find(txn_id);
     assert(res != nullptr);
-    TransactionManager::txn_map_mutex.unlock_shared();
     return res;
   }
 
-  /** Prevents all transactions from performing operations, used for checkpointing. */
+  /** The versions of the tuples written by optimistic transactions, which TableHeap::GetTuple records as it reads. */
+  static TupleVersionTable version_table;
+
+  /**
+   * Prevents new transactions from starting and waits for the running ones to finish, used for checkpointing.
+   * Concurrent callers are serialized until ResumeTransactions().
+   */
   void BlockAllTransactions();
 
   /** Resumes all transactions, used for checkpointing. */
@@ -102,12 +207,46 @@ class TransactionManager {
     }
   }
 
+  /** Counts the transaction as running, waiting first if a checkpoint is blocking transactions. */
+  void RegisterActive(Transaction *txn);
+
+  /** Counts the transaction as finished. */
+  void DeregisterActive(Transaction *txn);
+
+  /**
+   * Validates the read set of an optimistic transaction and, if it is still current, applies the buffered writes.
+   * On success the write set holds undo records for whatever was applied, as it would for a 2PL transaction. On
+   * failure the transaction is rolled back before the validation latch is released.
+   * @param txn the optimistic transaction to validate
+   * @return true if the transaction may commit
+   */
+  auto ValidateAndWrite(Transaction *txn) -> bool;
+
+  /**
+   * Undoes every applied write of the transaction, in reverse order. Tuples that optimistic transactions restore get
+   * a new version.
+   */
+  void Rollback(Transaction *txn);
+
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
 
-  /** The global transaction latch is used for checkpointing. */
-  ReaderWriterLatch global_txn_latch_;
+  /** Number of running transactions, striped by transaction id so that Begin and Commit do not share a cache line. */
+  struct alignas(64) ActiveSlot {
+    std::atomic<uint32_t> count_{0};
+  };
+  static constexpr size_t ACTIVE_SLOTS = 64;
+
+  /** Checkpointing: running transactions, checked against blocked_ in Dekker fashion. */
+  std::array<ActiveSlot, ACTIVE_SLOTS> active_;
+  std::atomic<bool> blocked_{false};
+  /** Checkpointing: guards changes to blocked_ and parks transactions that begin while it is set. */
+  std::mutex block_latch_;
+  std::condition_variable resumed_;
+
+  /** OCC: serializes the validation and write phases of optimistic transactions. */
+  std::mutex validation_latch_;
 };
 
 }  // namespace bustub
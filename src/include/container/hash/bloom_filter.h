@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/container/hash/bloom_filter.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+/**
+ * A memory-resident Bloom filter over the keys of an index, consulted before a point lookup fetches any page, so that
+ * lookups of absent keys (uniqueness checks on insert, joins with few matches) usually touch no page at all.
+ *
+ * The filter takes 64-bit key hashes and grows with the index without knowing its keys: it is a chain of generations,
+ * each twice the capacity of the one before and with one more bit per key, so that the false positive rates of the
+ * generations add up to a bounded total (Almeida et al., Scalable Bloom Filters). Inserts go into the newest
+ * generation, lookups check all of them. Removing a key leaves its bits set; the filter then only answers "maybe" for
+ * a key that is gone, which costs the page reads it would have cost without a filter.
+ *
+ * Insert() and MayContain() may be called concurrently. A key is in the filter once Insert() returns, so an index
+ * inserts into the filter before it makes the key visible in its pages.
+ */
+class BloomFilter {
+ public:
+  /**
+   * @param initial_capacity number of keys the first generation is sized for
+   * @param bits_per_key bits per key in the first generation, 10 gives about a 1% false positive rate
+   */
+  explicit BloomFilter(uint64_t initial_capacity = 1024, uint32_t bits_per_key = 10);
+
+  /** Adds a key, by its hash. */
+  void Insert(uint64_t hash);
+
+  /** @return false if no key with this hash was ever inserted, true if one may have been */
+  auto MayContain(uint64_t hash) const -> bool;
+
+  /** @return the number of generations the filter has grown to */
+  auto NumGenerations() const -> uint32_t { return num_generations_.load(); }
+
+ private:
+  /** One Bloom filter of the chain. */
+  struct Generation {
+    Generation(uint64_t capacity, uint32_t bits_per_key);
+
+    void Insert(uint64_t hash);
+    auto MayContain(uint64_t hash) const -> bool;
+
+    /** Number of keys after which the next generation takes over. */
+    const uint64_t capacity_;
+    const uint64_t num_bits_;
+    const uint32_t num_probes_;
+    std::atomic<uint64_t> size_{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  };
+
+  /** Enough generations for 2^40 times the initial capacity. */
+  static constexpr uint32_t MAX_GENERATIONS = 40;
+
+  /** Adds a generation after the full generation generation_idx, unless another thread already did. */
+  void Grow(uint32_t generation_idx);
+
+  std::array<std::unique_ptr<Generation>, MAX_GENERATIONS> generations_;
+  std::atomic<uint32_t> num_generations_{0};
+  std::mutex grow_latch_;
+};
+
+}  // namespace bustub
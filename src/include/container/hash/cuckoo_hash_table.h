@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cuckoo_hash_table.h
+//
+// Identification: src/include/container/hash/cuckoo_hash_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_header_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define CUCKOO_HASH_TABLE_TYPE CuckooHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of a bucketized cuckoo hash table that is backed by a buffer
+ * pool manager. Non-unique keys are supported. Supports insert and delete.
+ * The table doubles its number of buckets when an insert finds no room.
+ *
+ * Every key has two candidate buckets, one chosen by the low half of its hash
+ * and one by the high half, and its pairs live in one or both of them. A lookup
+ * therefore reads at most two bucket pages, however full the table is. When
+ * both buckets of a new pair are full, the insert moves a pair out of one of
+ * them into that pair's other bucket, which may in turn move another pair, up
+ * to MAX_DISPLACEMENTS times before the table grows.
+ *
+ * The header page lists the bucket pages, HashTableBucketPages, by bucket index;
+ * the number of buckets is a power of two.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class CuckooHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new CuckooHashTable.
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   * @param num_buckets initial number of buckets, rounded up to a power of two of at least 2
+   */
+  explicit CuckooHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                           const KeyComparator &comparator, HashFunction<KeyType> hash_fn, size_t num_buckets = 2);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the pair exists or the table cannot grow any further
+   */
+  auto Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  auto Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool override;
+
+  /** @return the number of buckets */
+  auto GetNumBuckets() -> size_t;
+
+ private:
+  /** Pairs an insert may move to other buckets before the table grows. */
+  static constexpr int MAX_DISPLACEMENTS = 32;
+  /** The most buckets the header page can list, as a power of two. */
+  static constexpr size_t MAX_BUCKETS = 512;
+
+  /** @return the two candidate buckets of a key among num_buckets buckets; they may be the same bucket */
+  auto CandidateBuckets(const KeyType &key, size_t num_buckets) -> std::pair<size_t, size_t>;
+
+  /** Inserts a pair into whichever of its buckets has more room. @return false if both are full */
+  auto InsertIntoCandidate(HashTableHeaderPage *header, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Makes room for a pair whose buckets are both full by moving pairs to their other bucket, and inserts it.
+   * @return false, with every pair back where it was, if no room was found within MAX_DISPLACEMENTS moves
+   */
+  auto Displace(HashTableHeaderPage *header, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Doubles the number of buckets: bucket i is split into buckets i and i + n, by the next bit of the half of the
+   * hash that chose bucket i for each pair. @return false if the table has MAX_BUCKETS buckets already
+   */
+  auto Grow(HashTableHeaderPage *header) -> bool;
+
+  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto FetchPage(page_id_t page_id) -> Page *;
+  auto NewPage(page_id_t *page_id) -> Page *;
+
+  page_id_t header_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers are lookups, writers are inserts and removes
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <memory>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
+#include "container/hash/bloom_filter.h"
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
@@ -30,6 +32,10 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * With a Bloom filter, every inserted key is also added to a memory-resident
+ * BloomFilter, and GetValue() returns without fetching the directory or a
+ * bucket page when the filter rules the key out.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
@@ -40,9 +46,11 @@ class ExtendibleHashTable {
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
    * @param hash_fn the hash function
+   * @param bloom_filter whether to keep a Bloom filter of the keys for lookups of absent keys
    */
   explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                               bool bloom_filter = false);
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -136,6 +144,12 @@ class ExtendibleHashTable {
    */
   auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
 
+  /** Fetches a page, throwing if the buffer pool is exhausted. */
+  auto FetchPage(page_id_t page_id) -> Page *;
+
+  /** Allocates a new page, throwing if the buffer pool is exhausted. */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
   /**
    * Performs insertion with an optional bucket splitting.
    *
@@ -161,14 +175,29 @@ class ExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Moves the entries of a full bucket whose hash has the bit of its new
+   * local depth set into a new bucket, doubling the directory if needed.
+   *
+   * @param dir_page the directory page
+   * @param bucket_idx a directory index of the bucket to split
+   * @return false if the directory cannot grow any further
+   */
+  auto SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx) -> bool;
+
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Readers are inserts and removes, writers are splits and merges. Readers latch the bucket page they work on.
+  // Lookups do not take it, they read the directory page optimistically; see GetValue().
   ReaderWriterLatch table_latch_;
+  // Buckets that Merge() emptied while a lookup still pinned them, retried by the next merge. Under the table latch.
+  std::vector<page_id_t> pending_deletes_;
   HashFunction<KeyType> hash_fn_;
+  // Keys ever inserted, null if the table has no Bloom filter
+  std::unique_ptr<BloomFilter> bloom_filter_;
 };
 
 }  // namespace bustub
@@ -12,12 +12,21 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
-#include "murmur3/MurmurHash3.h"
+#include "common/util/hash_util.h"
 
 namespace bustub {
 
+template <size_t KeySize>
+class GenericKey;
+
+/**
+ * Hashes the bytes of a key with HashUtil, whose xxHash3-style hash mixes a word at a time. Integer keys and
+ * GenericKeys, the keys of every index, get specializations that hash a fixed number of words without a length loop.
+ */
 template <typename KeyType>
 class HashFunction {
  public:
@@ -26,10 +35,24 @@ class HashFunction {
    * @return the hashed value
    */
   virtual auto GetHash(KeyType key) -> uint64_t {
-    uint64_t hash[2];
-    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
-                                 reinterpret_cast<void *>(&hash));
-    return hash[0];
+    if constexpr (std::is_integral_v<KeyType>) {
+      return HashUtil::HashInt(static_cast<uint64_t>(key));
+    } else {
+      return HashUtil::HashBytes(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+    }
+  }
+};
+
+template <size_t KeySize>
+class HashFunction<GenericKey<KeySize>> {
+ public:
+  /**
+   * @param key the key to be hashed
+   * @return the hashed value
+   */
+  virtual auto GetHash(const GenericKey<KeySize> &key) -> uint64_t {
+    // KeySize is a constant, so HashBytes unrolls into loads and multiplications.
+    return HashUtil::HashBytes(key.data_, KeySize);
   }
 };
 
@@ -26,12 +26,20 @@
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
+#define LINEAR_PROBE_HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The slots of a table live in block pages that a header page lists in order;
+ * a header page and its blocks make up a layout. The table grows incrementally:
+ * a resize creates a new, larger layout, and from then on every insert and
+ * remove moves the next few slots of the old layout into the new one, until the
+ * old layout is empty and freed. While both layouts exist, inserts go to the new
+ * layout and lookups and removes consult both, so no single operation pays for
+ * rehashing the whole table.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -87,12 +95,76 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   auto GetSize() -> size_t;
 
  private:
+  /** Slots of the old layout that every insert and remove moves to the new layout while a resize is under way. */
+  static constexpr size_t MIGRATION_SLOTS_PER_OPERATION = 64;
+
+  /** @return true while a resize is under way, i.e. both layouts exist */
+  auto IsResizing() const -> bool { return new_header_page_id_ != INVALID_PAGE_ID; }
+
+  /** @return the header page of the layout that inserts go to */
+  auto TargetHeaderPageId() const -> page_id_t { return IsResizing() ? new_header_page_id_ : header_page_id_; }
+
+  /**
+   * Starts a resize into a new layout of twice the larger of initial_size and the number of pairs, finishing the resize
+   * under way first if there is one.
+   */
+  void BeginResize(size_t initial_size);
+
+  /**
+   * Creates a layout of num_slots empty slots. Its block pages are allocated by the first insert into them, so that a
+   * resize does not pay for them all at once either. @return its header page id
+   */
+  auto CreateLayout(size_t num_slots) -> page_id_t;
+
+  /** Deletes the header page and block pages of a layout. */
+  void DeleteLayout(page_id_t header_page_id);
+
+  /**
+   * Visits the probe sequence of key in a layout, from the slot that key hashes to up to and including the first
+   * slot that was never occupied, or every slot of a full layout. Stops early when visit returns true; the block page
+   * it stops on is unpinned dirty, so visit may change the slot it stops on.
+   * @param visit called as visit(block_page, block_idx, offset) with the block page pinned, or with nullptr for a block
+   * page that was not allocated yet, whose slots were never occupied
+   * @return true if visit stopped the probe
+   */
+  template <typename Visitor>
+  auto Probe(page_id_t header_page_id, const KeyType &key, Visitor visit) -> bool;
+
+  /** Appends the values of key in a layout to result. @return true if there were any */
+  auto GetValueFrom(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Inserts a pair into the target layout, into the first slot of its probe sequence that holds no pair.
+   * @return false if the pair is there already and check_duplicate is set, or if the layout is full
+   */
+  auto InsertInto(const KeyType &key, const ValueType &value, bool check_duplicate) -> bool;
+
+  /** Removes a pair from a layout. @return false if it is not there */
+  auto RemoveFrom(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool;
+
+  /** Moves up to num_slots slots of the old layout into the new one, and frees the old layout once it is empty. */
+  void Migrate(size_t num_slots);
+
+  auto FetchPage(page_id_t page_id) -> Page *;
+  auto NewPage(page_id_t *page_id) -> Page *;
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // While a resize is under way: the header page of the new layout, and the next slot of the old layout to move.
+  page_id_t new_header_page_id_{INVALID_PAGE_ID};
+  size_t migrated_slots_{0};
+
+  // Slots of the target layout.
+  size_t num_slots_;
+  // Pairs in the table, in either layout.
+  size_t num_pairs_{0};
+  // Slots of the target layout that hold a pair or a tombstone.
+  size_t num_occupied_{0};
+
+  // Readers are lookups; inserts, removes and the resize steps they take are writers
   ReaderWriterLatch table_latch_;
 
   // Hash function
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
@@ -24,6 +25,15 @@ namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * The scan reads every entry of the index, the entries whose key equals a key, or the entries whose key is in a range,
+ * see IndexScanType and Index::ScanEntries(). Full and range scans read the entries in key order and need an ordered
+ * index, equality scans work on any index. The entries are pulled one per Next() from an Index::GetEntryCursor(),
+ * which streams them from the index where it can.
+ *
+ * If every column that the output schema and the predicate read is a key or included column of the index, the scan is
+ * index-only: output tuples are computed from the entries themselves and the table is never touched. Otherwise each
+ * tuple is fetched from the table by its RID.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +52,22 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Adds the table columns that expr reads to columns. */
+  static void CollectColumns(const AbstractExpression *expr, std::vector<uint32_t> *columns);
+
+  /** @return a tuple in the table schema with the columns of an index entry in place, and placeholders elsewhere */
+  auto TupleFromEntry(const Tuple &entry) const -> Tuple;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** Metadata of the scanned index and its table. */
+  IndexInfo *index_info_{nullptr};
+  TableInfo *table_info_{nullptr};
+  /** true if the output and the predicate only read columns that the index entries carry */
+  bool index_only_{false};
+  /** Values for the table columns that an index-only scan does not read. */
+  std::vector<Value> placeholders_;
+  /** The entries of the index that are left to scan. */
+  std::unique_ptr<IndexCursor> cursor_;
 };
 }  // namespace bustub
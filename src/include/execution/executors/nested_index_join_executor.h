@@ -29,6 +29,10 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ *
+ * The join key of each outer tuple is the left operand of the join predicate. Outer tuples are pulled from the child
+ * in batches of OUTER_BATCH_SIZE, and the keys of a batch are looked up in the index at once, see Index::ScanKeys(),
+ * so that an index that sorts them can serve a batch in a single pass. Joined tuples come out in outer order.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -47,8 +51,23 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /** Number of outer tuples whose keys are looked up in the index together. */
+  static constexpr size_t OUTER_BATCH_SIZE = 256;
+
  private:
+  /** Joins the next batch of outer tuples into results_. @return false if the outer input is exhausted */
+  auto JoinNextBatch() -> bool;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The child executor that produces the outer tuples. */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Metadata of the inner table. */
+  TableInfo *inner_table_info_{nullptr};
+  /** Metadata of the index on the inner table. */
+  IndexInfo *index_info_{nullptr};
+  /** Joined tuples of the current batch, and the position of the next one to emit. */
+  std::vector<Tuple> results_;
+  size_t result_index_{0};
 };
 }  // namespace bustub
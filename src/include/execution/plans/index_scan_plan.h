@@ -12,39 +12,104 @@
 
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "type/value.h"
 
 namespace bustub {
+
+/** How an index scan reaches its entries. */
+enum class IndexScanType {
+  /** Every entry of an ordered index, in key order. */
+  FULL,
+  /** The entries whose key equals a key, on any index. */
+  EQUALITY,
+  /** The entries whose key is in a closed range, in key order, on an ordered index. */
+  RANGE,
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * Keys are given as one value per column of the index key schema. The predicate is still evaluated on every tuple, so
+ * a scan over a range of the index may return fewer tuples than the range holds, e.g. for a range predicate on a
+ * column after the first key column. A range that is open on one side is closed by the minimum or maximum value of its
+ * column type, see Type::GetMinValue() and Type::GetMaxValue().
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
   /**
-   * Creates a new index scan plan node.
+   * Creates a new index scan plan node that scans every entry of the index.
    * @param output the output format of this scan plan node
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to be scanned
    */
   IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid), scan_type_(IndexScanType::FULL) {}
+
+  /**
+   * Creates a new index scan plan node that looks a key up in the index.
+   * @param output the output format of this scan plan node
+   * @param predicate the predicate to scan with, may be nullptr
+   * @param index_oid the identifier of the index to be scanned
+   * @param key the key to look up
+   */
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    std::vector<Value> key)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        scan_type_(IndexScanType::EQUALITY),
+        low_key_(std::move(key)) {}
+
+  /**
+   * Creates a new index scan plan node that scans the keys in [low_key, high_key] of an ordered index.
+   * @param output the output format of this scan plan node
+   * @param predicate the predicate to scan with, may be nullptr
+   * @param index_oid the identifier of the index to be scanned
+   * @param low_key the smallest key to scan
+   * @param high_key the largest key to scan
+   */
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    std::vector<Value> low_key, std::vector<Value> high_key)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        scan_type_(IndexScanType::RANGE),
+        low_key_(std::move(low_key)),
+        high_key_(std::move(high_key)) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the predicate to test tuples against; tuples should only be returned if they evaluate to true */
   auto GetPredicate() const -> const AbstractExpression * { return predicate_; }
 
-  /** @return the identifier of the table that should be scanned */
+  /** @return the identifier of the index that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return how the scan reaches the entries of the index */
+  auto GetScanType() const -> IndexScanType { return scan_type_; }
+
+  /** @return the key of an equality scan, or the smallest key of a range scan */
+  auto GetLowKey() const -> const std::vector<Value> & { return low_key_; }
+
+  /** @return the largest key of a range scan */
+  auto GetHighKey() const -> const std::vector<Value> & { return high_key_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
-  /** The table whose tuples should be scanned. */
+  /** The index whose entries should be scanned. */
   index_oid_t index_oid_;
+  /** How the entries are reached, and the keys that bound them. */
+  IndexScanType scan_type_;
+  std::vector<Value> low_key_;
+  std::vector<Value> high_key_;
 };
 
 }  // namespace bustub
@@ -10,37 +10,85 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "common/background_worker.h"
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "container/hash/bloom_filter.h"
+#include "container/hash/hash_function.h"
+#include "storage/index/external_sort.h"
 #include "storage/index/index_iterator.h"
+#include "storage/page/b_plus_tree_compressed_internal_page.h"
+#include "storage/page/b_plus_tree_compressed_leaf_page.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/** How concurrent operations on a BPlusTree synchronize. */
+enum class BPlusTreeMode {
+  /** Optimistic lock coupling, restarting with latch crabbing from the root when a split or merge is needed. */
+  LOCK_COUPLING,
+  /**
+   * Lehman-Yao B-link tree: every page carries a high key and a link to its right sibling, so a traversal that races a
+   * split moves right instead of latching the path, and no operation ever holds more than one page latch. Splits are
+   * posted to the parent after the split page is released. Pages are never merged; removes only shrink leaves.
+   */
+  B_LINK,
+};
+
+/** Fraction of a page's capacity that BulkLoad() fills by default, leaving room for later inserts without splits. */
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the tree is built with unique_keys = false: then a key may have several values, which
+ *     are kept in a posting list once there is more than one, see BPlusTreePostingPage
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Key types that PrefixCompressedPages opts in are stored in prefix-compressed pages, see BPlusTreeCompressedPage.
+ * Those pages split when they reach their max size or run out of space, whichever comes first, and are merged or
+ * redistributed only if the result fits.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
-  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
-  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+  static constexpr bool PREFIX_COMPRESSED = PrefixCompressedPages<KeyType>::value;
+  using InternalPage =
+      std::conditional_t<PREFIX_COMPRESSED, BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator>,
+                         BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>;
+  using LeafPage = std::conditional_t<PREFIX_COMPRESSED, BPlusTreeCompressedLeafPage<KeyType, ValueType, KeyComparator>,
+                                      BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>;
 
  public:
+  /** The most entries a leaf and an internal page can hold, and the default max sizes. */
+  static constexpr int LEAF_PAGE_CAPACITY =
+      static_cast<int>(PREFIX_COMPRESSED ? COMPRESSED_LEAF_PAGE_SIZE : LEAF_PAGE_SIZE);
+  static constexpr int INTERNAL_PAGE_CAPACITY =
+      static_cast<int>(PREFIX_COMPRESSED ? COMPRESSED_INTERNAL_PAGE_SIZE : INTERNAL_PAGE_SIZE);
+
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_CAPACITY, int internal_max_size = INTERNAL_PAGE_CAPACITY,
+                     BPlusTreeMode mode = BPlusTreeMode::LOCK_COUPLING, bool unique_keys = true,
+                     bool bloom_filter = false);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -48,15 +96,49 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its values from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one value of a key from this B+ tree; the key goes with its last value.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  // return the values of each of a batch of keys, looking them up in key order; returns the number of keys found
+  auto GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr) -> size_t;
+
+  // find the smallest key greater than a given key, return false if there is none
+  auto GetNextKey(const KeyType &key, KeyType *next_key) -> bool;
+
+  /**
+   * Build the tree bottom-up from a batch of entries: leaves are packed left to right and every internal level is
+   * built in the same pass, so no page is ever split. The tree must be empty.
+   * @param entries the entries to load, sorted in place by key unless they already are. Without unique keys, the
+   * entries of a repeated key are also collapsed in place into one entry for their posting list
+   * @param fill_factor fraction of each page's capacity to fill, pages on a level are sized evenly
+   * @return false if the tree is not empty or has unique keys that the batch repeats, in which case nothing is loaded
+   */
+  auto BulkLoad(std::vector<std::pair<KeyType, ValueType>> *entries, double fill_factor = BULK_LOAD_FILL_FACTOR)
+      -> bool;
+
+  /**
+   * Build the tree bottom-up from the entries of a finished external sort, like the BulkLoad() above, without holding
+   * the batch in memory. The sorted entries are streamed twice: once to count and check the keys, once into the leaves.
+   */
+  auto BulkLoad(ExternalSort<KeyType, ValueType, KeyComparator> *sort, double fill_factor = BULK_LOAD_FILL_FACTOR)
+      -> bool;
+
   // index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
+  // forward iterator over the keys in [low_key, high_key]
+  auto Begin(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE;
+  // reverse iterators from the largest key, from the largest key not above key, and over [low_key, high_key]
+  auto RBegin() -> INDEXITERATOR_TYPE;
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+  auto RBegin(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
 
   // print the B+ tree
@@ -74,30 +156,209 @@ class BPlusTree {
   auto FindLeafPage(const KeyType &key, bool leftMost = false) -> Page *;
 
  private:
+  /** The kind of access a traversal is made for, which decides the latches it takes and when it may release them. */
+  enum class Operation { FIND, INSERT, REMOVE };
+
+  /**
+   * Latches held by a pessimistic (insert/remove) traversal: the root latch if the root may still change, and the
+   * write-latched pages from the highest ancestor that may still be modified down to the leaf.
+   */
+  struct Context {
+    bool root_latched_{false};
+    std::deque<Page *> write_set_;
+    std::vector<page_id_t> deleted_pages_;
+  };
+
+  /** One level of a bulk load in progress: how its entries are spread over pages, and the page being filled. */
+  struct BulkLevel {
+    int64_t count_;
+    int64_t pages_;
+    int64_t started_{0};
+    int target_{0};
+    int filled_{0};
+    Page *page_{nullptr};
+
+    /** @return the number of entries of the next page; the first count % pages pages take one more than the rest */
+    auto NextTarget() const -> int { return static_cast<int>(count_ / pages_ + (started_ < count_ % pages_ ? 1 : 0)); }
+  };
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
+  auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Context *ctx) -> bool;
+
+  /**
+   * Adds a value to a key that the write-latched leaf already holds, as its existing value or posting list.
+   * @return false if the value is the key's only value already
+   */
+  auto InsertDuplicate(LeafPage *leaf, const KeyType &key, const ValueType &existing, const ValueType &value) -> bool;
+
+  /** Removes a key, or only the given value of it if value is not null. */
+  void RemoveValues(const KeyType &key, const ValueType *value);
+
+  /**
+   * Applies a remove of key, or of one of its values if value is not null, to the write-latched leaf as far as that
+   * leaves the leaf entry in place: a value is taken out of a posting list right away.
+   * @param[out] dirty set if the leaf or its posting lists changed
+   * @return true if the leaf entry itself has to go, see RemoveEntry()
+   */
+  auto RemoveFromPostingList(LeafPage *leaf, const KeyType &key, const ValueType *value, bool *dirty) -> bool;
+
+  /** Removes the entry of key from the write-latched leaf and frees its posting list. @return the leaf's new size */
+  auto RemoveEntry(LeafPage *leaf, const KeyType &key) -> int;
 
-  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, Context *ctx);
 
   template <typename N>
   auto Split(N *node) -> N *;
 
   template <typename N>
-  auto CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr) -> bool;
+  void CoalesceOrRedistribute(N *node, Context *ctx);
 
   template <typename N>
-  auto Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr) -> bool;
+  void Coalesce(N *left_node, N *right_node, InternalPage *parent, int right_index, Context *ctx);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index);
 
   auto AdjustRoot(BPlusTreePage *node) -> bool;
 
   void UpdateRootPageId(int insert_record = 0);
 
+  /**
+   * Descends to the leaf responsible for key. FIND returns the leaf read-latched, or nullptr if the tree is empty; it
+   * reads internal pages optimistically where it can, see FindLeafRead(), and read-latches its way down otherwise.
+   * INSERT and REMOVE expect the root latch to be held in ctx and write-latch their way down, releasing ancestors as
+   * soon as a node is safe; the leaf is left at the back of ctx->write_set_.
+   */
+  auto FindLeaf(const KeyType &key, Operation op, Context *ctx = nullptr, bool left_most = false) -> Page *;
+
+  /**
+   * FIND descent in lock coupling mode that latches only the leaf. Internal pages are read under Page versions (see
+   * Page::OptimisticRLatch()) and the descent restarts from the root whenever a page it went through was written to
+   * in the meantime. Compressed pages decode variable-length slots that a torn read could send out of bounds, so trees
+   * with compressed pages read-latch their way down instead.
+   */
+  auto FindLeafRead(const KeyType &key, bool left_most) -> Page *;
+
+  /**
+   * Optimistic lock coupling: read-latches its way down and write-latches only the leaf responsible for key, which is
+   * returned with no other latch held, or nullptr if the tree is empty. The caller restarts pessimistically if the leaf
+   * turns out to need a split or merge.
+   */
+  auto FindLeafOptimistic(const KeyType &key) -> Page *;
+
+  /**
+   * Like FindLeaf() for FIND in lock coupling mode, but also keeps the parent of the leaf read-latched in *parent, or
+   * sets it to nullptr if the leaf is the root.
+   */
+  auto FindLeafAndParent(const KeyType &key, Page **parent) -> Page *;
+
+  /**
+   * Moves the read-latched leaf *page of a batch lookup to the leaf responsible for key, which must not be smaller than
+   * any key the leaf was used for before. The leaf is reused if it still covers key, and a sibling leaf is reached
+   * through the latched parent in lock coupling mode, or by one step right in B-link mode; only otherwise do we descend
+   * from the root again. *page may be nullptr to descend right away.
+   * @return false if the tree is empty
+   */
+  auto MoveBatchCursor(const KeyType &key, Page **parent, Page **page) -> bool;
+
+  /**
+   * Descends to the leaf holding the largest key below key, or the largest key of all if key is null, and returns it
+   * read-latched, or nullptr if the tree is empty. Leaves have no link to their left sibling, so this is how iterators
+   * move backwards. *low_fence is set to the lower end of the leaf's range, if it has one: a leaf may hold no key below
+   * key after all, and the search goes on below its fence.
+   */
+  auto FindLeafBefore(const KeyType *key, KeyType *low_fence, bool *has_low_fence) -> Page *;
+
+  /** B-link part of FindLeafBefore(): moves right from page while its right sibling still starts below key. */
+  auto MoveRightBefore(Page *page, const KeyType *key, KeyType *low_fence, bool *has_low_fence) -> Page *;
+
+  /** Releases the read latch on the parent of the current node, or the root latch if the node is the root. */
+  void ReleaseParent(Page *parent);
+
+  /** B-link insert. Splits are posted to the parent level by level, using the pages visited on the way down. */
+  auto InsertBLink(const KeyType &key, const ValueType &value) -> bool;
+
+  /** B-link remove. The leaf shrinks but is never merged. */
+  void RemoveBLink(const KeyType &key, const ValueType *value);
+
+  /**
+   * Inserts the separator of a split into the parent level, splitting upwards as needed.
+   * @param old_page_id the page that was split, already released
+   * @param key the first key of the new right sibling
+   * @param new_page_id the new right sibling
+   * @param height the height of the split page, leaves have height 0
+   * @param path the internal pages visited above the split page on the way down, root first
+   */
+  void InsertIntoParentBLink(page_id_t old_page_id, KeyType key, page_id_t new_page_id, int height,
+                             std::vector<page_id_t> *path);
+
+  /**
+   * B-link descent to the leaf responsible for key, holding one latch at a time. Internal pages of uncompressed trees
+   * are read optimistically, see FindLeafRead(). Returns the leaf read- or write-latched, or nullptr if the tree is
+   * empty.
+   * @param path if not null, receives the internal pages the descent went through, root first
+   */
+  auto FindLeafBLink(const KeyType &key, bool exclusive, std::vector<page_id_t> *path = nullptr) -> Page *;
+
+  /** Follows right links from the latched page until reaching the page whose key range contains key. */
+  auto MoveRight(Page *page, const KeyType &key, bool exclusive) -> Page *;
+
+  /**
+   * Builds the pages of an empty tree from count sorted, distinct entries, with the root latch held. next_leaf(n)
+   * returns the next n entries; key_size is the longest trimmed key among them, which sizes compressed pages.
+   */
+  void BulkBuild(int64_t count, int key_size, double fill_factor,
+                 const std::function<const std::pair<KeyType, ValueType> *(int)> &next_leaf);
+
+  /**
+   * Starts the next page of a bulk-loaded level, links the previous page of the level to it and adds it to its parent.
+   * Returns the new page pinned; the previous page of the level is released.
+   */
+  auto BulkStartPage(std::vector<BulkLevel> *levels, size_t level, const KeyType &low_key) -> Page *;
+
+  /** Appends a child to the internal level being bulk loaded. @return the page id of the child's parent */
+  auto BulkAppendChild(std::vector<BulkLevel> *levels, size_t level, const KeyType &low_key, page_id_t child)
+      -> page_id_t;
+
+  /** @return true if the node cannot split or underflow as a result of op, so its ancestors can be released */
+  auto IsSafe(BPlusTreePage *node, Operation op) const -> bool;
+
+  /** @return true if the node has to split: it reached its max size, or a compressed page ran out of space */
+  template <typename N>
+  auto IsOverflow(N *node) const -> bool;
+
+  /** @return true if the node has to be merged or redistributed */
+  template <typename N>
+  auto IsUnderflow(N *node) const -> bool;
+
+  /** @return true if right_node can be merged into left_node */
+  template <typename N>
+  auto CanCoalesce(N *left_node, N *right_node, InternalPage *parent, int right_index) const -> bool;
+
+  /** @return true if Redistribute() can move an entry from neighbor_node to node */
+  template <typename N>
+  auto CanRedistribute(N *neighbor_node, N *node, InternalPage *parent, int index) const -> bool;
+
+  /**
+   * @return the key that separates node from its left sibling in the parent: its first key, or for compressed pages
+   * its low key, which a split truncated to the shortest key that separates the two
+   */
+  template <typename N>
+  static auto LowKey(N *node) -> KeyType;
+
+  /**
+   * Releases every latch held in ctx, then deletes the pages that the operation emptied. A page that a concurrent
+   * reader or iterator still pins cannot be deleted yet; it is kept in pending_deletes_ and retried by later calls.
+   */
+  void ReleaseContext(Context *ctx);
+
+  /** Fetches a page that must exist, throwing if the buffer pool is exhausted. */
+  auto FetchPage(page_id_t page_id) -> Page *;
+
+  /** Allocates a new page, throwing if the buffer pool is exhausted. */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -110,6 +371,19 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  BPlusTreeMode mode_;
+  bool unique_keys_;
+  /** Every key ever inserted, so that lookups of absent keys can skip the descent; null without a Bloom filter. */
+  std::unique_ptr<BloomFilter> bloom_filter_;
+  HashFunction<KeyType> bloom_hash_;
+  /** Protects root_page_id_. */
+  ReaderWriterLatch root_latch_;
+  /** Unlinked pages that were still pinned when they were to be deleted, and whether there are any. */
+  std::mutex pending_deletes_latch_;
+  std::vector<page_id_t> pending_deletes_;
+  std::atomic<bool> has_pending_deletes_{false};
+  /** Fetches leaves ahead of forward scans, shared by every iterator over the tree; see IndexIterator. */
+  BackgroundWorker prefetch_worker_;
 };
 
 }  // namespace bustub
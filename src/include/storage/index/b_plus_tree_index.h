@@ -13,9 +13,12 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "concurrency/lock_manager.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
 
@@ -26,25 +29,152 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * @param metadata the index metadata
+   * @param buffer_pool_manager the buffer pool the tree lives in
+   * @param lock_manager if not null, REPEATABLE_READ transactions take key-range locks, see [KEY_RANGE_NOTE]
+   */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 LockManager *lock_manager = nullptr);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  /**
+   * Bulk loads the tree if it is empty, otherwise inserts entry by entry. The entries are sorted with an ExternalSort
+   * in the tree's buffer pool and streamed into BPlusTree::BulkLoad().
+   */
+  void InsertEntries(const std::function<bool(Tuple *key, RID *rid)> &next_entry, Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Looks the keys up in one sorted pass over the tree, see BPlusTree::GetValues(). */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  /**
+   * Search the index for all keys in [low_key, high_key], in key order. Under key-range locking no key can enter or
+   * leave the range until the transaction releases its locks. The bounds are in the key schema, and the entries of a
+   * covering index match by their key columns alone.
+   * @param low_key the smallest key to return
+   * @param high_key the largest key to return
+   * @param result the collection of RIDs that is populated with results of the search
+   * @param transaction the transaction context
+   */
+  void ScanRange(const Tuple &low_key, const Tuple &high_key, std::vector<RID> *result, Transaction *transaction);
+
+  /**
+   * Decodes every entry of the tree, in key order, with the key and included columns of its tuple. Under key-range
+   * locking the scan locks the whole index like ScanRange().
+   */
+  void ScanEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) override;
+
+  /** Decodes the entries whose key columns equal key, see ScanRange(). */
+  void ScanEntries(const Tuple &key, std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) override;
+
+  /** Decodes the entries whose key columns are in [low_key, high_key], in key order, see ScanRange(). */
+  void ScanEntries(const Tuple &low_key, const Tuple &high_key, std::vector<std::pair<Tuple, RID>> *entries,
+                   Transaction *transaction) override;
+
+  /** Streams the entries of ScanEntries() through a tree iterator, see EntryCursor. */
+  auto GetEntryCursor(Transaction *transaction) -> std::unique_ptr<IndexCursor> override;
+
+  auto GetEntryCursor(const Tuple &key, Transaction *transaction) -> std::unique_ptr<IndexCursor> override;
+
+  auto GetEntryCursor(const Tuple &low_key, const Tuple &high_key, Transaction *transaction)
+      -> std::unique_ptr<IndexCursor> override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  auto GetBeginIterator(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE;
+
+  auto GetRBeginIterator() -> INDEXITERATOR_TYPE;
+
+  auto GetRBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
+
+  auto GetRBeginIterator(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE;
+
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
  protected:
+  /**
+   * Streams the entries in [low, high], or every entry if there are no bounds, through a tree iterator. Between calls
+   * to Next() the iterator keeps the leaf it stopped in read latched, like any open iterator of the tree.
+   *
+   * Under key-range locking each entry is locked before it is returned, and at the end the first key above the range,
+   * as ScanEntryRange() does. Locks must not be waited for with a leaf latched, so unless the transaction holds the
+   * lock already the iterator is released first, and then positioned again after the entries returned so far: keys
+   * that came or went in the meantime are seen like any other.
+   */
+  class EntryCursor : public IndexCursor {
+   public:
+    EntryCursor(BPlusTreeIndex *index, std::optional<KeyType> low, std::optional<KeyType> high,
+                Transaction *transaction);
+
+    auto Next(Tuple *entry, RID *rid) -> bool override;
+
+   private:
+    /** Positions the iterator after the entries returned so far. */
+    void Seek();
+
+    BPlusTreeIndex *index_;
+    std::optional<KeyType> low_;
+    std::optional<KeyType> high_;
+    Transaction *transaction_;
+    bool lock_ranges_;
+    std::optional<INDEXITERATOR_TYPE> iterator_;
+    /** The key of the last entry returned and how many entries with that key were returned. */
+    std::optional<KeyType> last_key_;
+    size_t last_key_count_{0};
+  };
+
+  /** Inserts an entry that is already encoded as an index key. */
+  void InsertKey(const KeyType &index_key, RID rid, Transaction *transaction);
+
+  /** @return true if the transaction has to take key-range locks */
+  auto UseKeyRangeLocks(Transaction *transaction) const -> bool;
+
+  /**
+   * Lock a key and the gap below it, or the supremum if key is nullptr. Must not be called with page latches held.
+   * Throws TransactionAbortException if the transaction is aborted.
+   */
+  void LockKeyRange(Transaction *transaction, const KeyType *key, bool exclusive);
+
+  /** @return true if the transaction holds the lock on a key and the gap below it, or the supremum if key is nullptr */
+  auto HoldsKeyRange(Transaction *transaction, const KeyType *key) -> bool;
+
+  /** Lock the successor of key exclusively, repeating until no key was inserted in between. */
+  void LockNextKeyExclusive(Transaction *transaction, const KeyType &key);
+
+  /** Collect the entries in [low, high], under key-range locks on them and the gaps between them if needed. */
+  void ScanEntryRange(const KeyType &low, const KeyType &high, std::vector<std::pair<KeyType, RID>> *entries,
+                      Transaction *transaction);
+
+  /** @return the lock manager resource of a key and the gap below it, or of the supremum if key is nullptr */
+  auto KeyRangeResource(const KeyType *key) -> RID;
+
+  /** Decode an index entry into a tuple in the entry schema. */
+  auto DecodeEntry(const KeyType &index_key) -> Tuple;
+
+  /** Decode index entries into tuples in the entry schema. */
+  void DecodeEntries(const std::vector<std::pair<KeyType, RID>> &index_entries,
+                     std::vector<std::pair<Tuple, RID>> *entries);
+
+  /** Collect the entries in [low_key, high_key] and the first key above high_key, if any. */
+  auto CollectRange(const KeyType &low_key, const KeyType &high_key, std::vector<std::pair<KeyType, RID>> *entries,
+                    KeyType *next_key) -> bool;
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // buffer pool of the tree, which also holds the runs of a bulk load
+  BufferPoolManager *buffer_pool_manager_;
+  // lock manager for key-range locks, may be null
+  LockManager *lock_manager_;
 };
 
 }  // namespace bustub
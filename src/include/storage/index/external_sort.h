@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+/** Pages worth of entries that an ExternalSort buffers in memory by default before it spills them as a run. */
+static constexpr size_t EXTERNAL_SORT_RUN_PAGES = 64;
+
+/** Runs that an ExternalSort merges at once by default. A merge pins one page of each of its runs. */
+static constexpr size_t EXTERNAL_SORT_FAN_IN = 16;
+
+/**
+ * External merge sort of (key, value) entries, e.g. for building an index over a table that does not fit in memory.
+ *
+ * Add() collects entries into a run of bounded size. A full run is sorted and spilled to a chain of pages in the
+ * buffer pool, which writes them out to disk when it needs the frames. Finish() sorts the last run, which stays in
+ * memory, and merges spilled runs ahead of time until a single merge of at most fan_in runs is left. A Merger then
+ * streams the entries in key order; there may be several over the same sort, one after the other.
+ *
+ * Run page format (size in byte):
+ *  --------------------------------------------------------------------
+ * | NextPageId (4) | Size (4) | Entry(1) | Entry(2) | ... | Entry(n) |
+ *  --------------------------------------------------------------------
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSort {
+ public:
+  using Entry = std::pair<KeyType, ValueType>;
+
+  /** The most entries a run page holds. */
+  static constexpr size_t RUN_PAGE_CAPACITY = (PAGE_SIZE - 2 * sizeof(int32_t)) / sizeof(Entry);
+
+  /**
+   * @param run_size the most entries that are sorted in memory at a time
+   * @param fan_in the most runs that are merged at once, at least 2
+   */
+  ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+               size_t run_size = EXTERNAL_SORT_RUN_PAGES * RUN_PAGE_CAPACITY, size_t fan_in = EXTERNAL_SORT_FAN_IN);
+
+  /** Deletes the pages of every spilled run. */
+  ~ExternalSort();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSort);
+
+  /** Adds an entry, spilling the current run if it is full. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Sorts the last run and merges spilled runs until a Merger reads at most fan_in runs. */
+  void Finish();
+
+  /** @return the number of entries added */
+  auto Size() const -> int64_t { return size_; }
+
+  /** @return the number of runs on pages, not counting the run in memory */
+  auto SpilledRuns() const -> size_t { return runs_.size(); }
+
+  /** Streams the entries of a finished sort in key order through a k-way merge of its runs. */
+  class Merger {
+    friend class ExternalSort;
+
+   public:
+    explicit Merger(const ExternalSort &sort) : Merger(sort, sort.runs_.size(), false) {}
+
+    /** Unpins the pages that are still being read. */
+    ~Merger();
+
+    DISALLOW_COPY_AND_MOVE(Merger);
+
+    /** @return false once every entry has been returned, otherwise stores the next entry in entry */
+    auto Next(Entry *entry) -> bool;
+
+   private:
+    /** Reads a spilled run page by page, or the run in memory if page_ is nullptr from the start. */
+    struct RunReader {
+      Page *page_{nullptr};
+      const Entry *entries_{nullptr};
+      int64_t size_{0};
+      int64_t index_{0};
+    };
+
+    /**
+     * Merges the first runs spilled runs and, unless consume is set, the run in memory. A consuming merge deletes
+     * each page once it has read it.
+     */
+    Merger(const ExternalSort &sort, size_t runs, bool consume);
+
+    /** Points reader at the first entry of the run page page_id. */
+    void Load(RunReader *reader, page_id_t page_id);
+
+    /** Moves reader to its next entry. @return false if the run has none left */
+    auto Advance(RunReader *reader) -> bool;
+
+    /** @return a heap order on reader indexes that puts the reader with the smallest current key on top */
+    auto Greater() const;
+
+    const ExternalSort &sort_;
+    bool consume_;
+    std::vector<RunReader> readers_;
+    /** Indexes of the readers that have entries left, as a heap on their current keys. */
+    std::vector<size_t> heap_;
+  };
+
+ private:
+  struct RunPage {
+    page_id_t next_page_id_;
+    int32_t size_;
+    // Flexible array member for page data.
+    Entry entries_[1];
+  };
+
+  /** Writes the entries that next yields, in order, to a new run at the back of runs_. */
+  void SpillRun(const std::function<bool(Entry *)> &next);
+
+  /** Fetches a run page that must exist, throwing if the buffer pool is exhausted. */
+  auto FetchRunPage(page_id_t page_id) const -> Page *;
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t run_size_;
+  size_t fan_in_;
+  int64_t size_{0};
+  /** The run being collected, and after Finish() the sorted last run. */
+  std::vector<Entry> buffer_;
+  /** Head page ids of the spilled runs, oldest first. */
+  std::deque<page_id_t> runs_;
+};
+
+}  // namespace bustub
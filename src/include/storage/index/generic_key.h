@@ -13,7 +13,9 @@
 #pragma once
 
 #include <cstring>
+#include <string>
 
+#include "common/macros.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -25,39 +27,136 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * The key columns are stored in a normalized, byte-order-preserving encoding, so that two keys over the same key
+ * schema compare exactly as a memcmp of their bytes:
+ * - integers are stored big-endian with the sign bit flipped, in the width of their type; BOOLEAN is an int8
+ * - TIMESTAMP is stored big-endian as is, it is unsigned
+ * - DECIMAL flips the sign bit of non-negative doubles and every bit of negative ones, then is stored big-endian
+ * - VARCHAR starts with a null byte (0 for NULL, 1 otherwise), followed by the bytes under binary collation with every
+ *   0 escaped as 0 0xff, and ends with 0 0
+ * Fixed-width NULLs are stored as the type's null sentinel, which is the lowest value of signed types and DECIMAL and
+ * the highest TIMESTAMP. A key that does not fit into KeySize is truncated and compares by its prefix.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    EncodeColumns(tuple, key_schema);
+  }
+
+  /**
+   * Encodes the columns of tuple like SetFromKey(), but pads the rest of the key with 0xff instead of 0. When tuple
+   * holds a prefix of the columns of the keys in a tree, no key that starts with that prefix is greater, so that
+   * [SetFromKey(prefix), SetUpperBoundFromKey(prefix)] is the range of keys with that prefix.
+   */
+  inline void SetUpperBoundFromKey(const Tuple &tuple, const Schema &key_schema) {
+    memset(data_, 0, KeySize);
+    size_t offset = EncodeColumns(tuple, key_schema);
+    memset(data_ + offset, 0xff, KeySize - offset);
+  }
+
+  /** @return the most bytes that a key over key_schema can take before it is truncated to KeySize */
+  static auto MaxEncodedSize(const Schema &key_schema) -> size_t {
+    size_t size = 0;
+    for (const auto &column : key_schema.GetColumns()) {
+      // A VARCHAR whose bytes are all escaped, between its null byte and terminator.
+      size += column.GetType() == TypeId::VARCHAR ? 3 + 2 * static_cast<size_t>(column.GetLength())
+                                                   : Type::GetTypeSize(column.GetType());
+    }
+    return size;
   }
 
   // NOTE: for test purpose only
+  // encodes key as a single BIGINT column
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    size_t offset = 0;
+    AppendBigEndian(static_cast<uint64_t>(key) ^ SIGN_BIT, sizeof(int64_t), &offset);
   }
 
+  /** Decodes the value of a key column. The key schema must be the one the key was encoded with. */
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+    size_t offset = 0;
+    for (uint32_t i = 0;; i++) {
+      const TypeId column_type = schema->GetColumn(i).GetType();
+      switch (column_type) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT: {
+          auto bits = static_cast<int8_t>(ReadBigEndian(sizeof(int8_t), &offset) ^ 0x80U);
+          if (i == column_idx) {
+            return Value(column_type, bits);
+          }
+          break;
+        }
+        case TypeId::SMALLINT: {
+          auto bits = static_cast<int16_t>(ReadBigEndian(sizeof(int16_t), &offset) ^ 0x8000U);
+          if (i == column_idx) {
+            return Value(column_type, bits);
+          }
+          break;
+        }
+        case TypeId::INTEGER: {
+          auto bits = static_cast<int32_t>(ReadBigEndian(sizeof(int32_t), &offset) ^ 0x80000000U);
+          if (i == column_idx) {
+            return Value(column_type, bits);
+          }
+          break;
+        }
+        case TypeId::BIGINT: {
+          auto bits = static_cast<int64_t>(ReadBigEndian(sizeof(int64_t), &offset) ^ SIGN_BIT);
+          if (i == column_idx) {
+            return Value(column_type, bits);
+          }
+          break;
+        }
+        case TypeId::TIMESTAMP: {
+          auto bits = ReadBigEndian(sizeof(uint64_t), &offset);
+          if (i == column_idx) {
+            return Value(column_type, bits);
+          }
+          break;
+        }
+        case TypeId::DECIMAL: {
+          auto bits = ReadBigEndian(sizeof(uint64_t), &offset);
+          bits = (bits & SIGN_BIT) != 0 ? bits ^ SIGN_BIT : ~bits;
+          if (i == column_idx) {
+            double decimal;
+            memcpy(&decimal, &bits, sizeof(decimal));
+            return Value(column_type, decimal);
+          }
+          break;
+        }
+        case TypeId::VARCHAR: {
+          bool is_null = ReadBigEndian(1, &offset) == 0;
+          std::string bytes;
+          while (!is_null && offset < KeySize) {
+            auto byte = static_cast<char>(ReadBigEndian(1, &offset));
+            if (byte == 0 && ReadBigEndian(1, &offset) == 0) {
+              break;
+            }
+            bytes.push_back(byte);
+          }
+          if (i == column_idx) {
+            return is_null ? Value(column_type, nullptr, 0, false)
+                           : Value(column_type, bytes.data(), static_cast<uint32_t>(bytes.size()), true);
+          }
+          break;
+        }
+        default:
+          UNREACHABLE("Unsupported key column type");
+      }
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // interpret the first 8 bytes as a BIGINT encoded by SetFromInteger
+  inline auto ToString() const -> int64_t {
+    size_t offset = 0;
+    return static_cast<int64_t>(ReadBigEndian(sizeof(int64_t), &offset) ^ SIGN_BIT);
+  }
 
   // NOTE: for test purpose only
   // interpret the first 8 bytes as int64_t from data vector
@@ -68,30 +167,85 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  static constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+  /** Encodes the columns of tuple from the start of the key, and returns the number of bytes written. */
+  inline auto EncodeColumns(const Tuple &tuple, const Schema &key_schema) -> size_t {
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      Value value = tuple.GetValue(&key_schema, i);
+      switch (key_schema.GetColumn(i).GetType()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          AppendBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, sizeof(int8_t), &offset);
+          break;
+        case TypeId::SMALLINT:
+          AppendBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, sizeof(int16_t), &offset);
+          break;
+        case TypeId::INTEGER:
+          AppendBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, sizeof(int32_t), &offset);
+          break;
+        case TypeId::BIGINT:
+          AppendBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ SIGN_BIT, sizeof(int64_t), &offset);
+          break;
+        case TypeId::TIMESTAMP:
+          AppendBigEndian(value.GetAs<uint64_t>(), sizeof(uint64_t), &offset);
+          break;
+        case TypeId::DECIMAL: {
+          uint64_t bits;
+          auto decimal = value.GetAs<double>();
+          memcpy(&bits, &decimal, sizeof(bits));
+          AppendBigEndian((bits & SIGN_BIT) != 0 ? ~bits : bits ^ SIGN_BIT, sizeof(uint64_t), &offset);
+          break;
+        }
+        case TypeId::VARCHAR:
+          if (value.IsNull()) {
+            AppendBigEndian(0, 1, &offset);
+            break;
+          }
+          AppendBigEndian(1, 1, &offset);
+          for (uint32_t j = 0; j < value.GetLength(); j++) {
+            auto byte = static_cast<uint8_t>(value.GetData()[j]);
+            AppendBigEndian(byte == 0 ? 0x00ffU : byte, byte == 0 ? 2 : 1, &offset);
+          }
+          AppendBigEndian(0, 2, &offset);
+          break;
+        default:
+          UNREACHABLE("Unsupported key column type");
+      }
+    }
+    return offset;
+  }
+
+  /** Appends the low size bytes of bits, most significant first, dropping whatever does not fit into the key. */
+  inline void AppendBigEndian(uint64_t bits, size_t size, size_t *offset) {
+    for (size_t i = size; i > 0 && *offset < KeySize; i--) {
+      data_[(*offset)++] = static_cast<char>(bits >> ((i - 1) * 8));
+    }
+  }
+
+  /** Reads size bytes as a big-endian integer; bytes past the end of the key read as 0. */
+  inline auto ReadBigEndian(size_t size, size_t *offset) const -> uint64_t {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < size; i++) {
+      bits = (bits << 8) | (*offset < KeySize ? static_cast<uint8_t>(data_[(*offset)++]) : 0);
+    }
+    return bits;
+  }
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys are normalized when they are built, see GenericKey, so comparing them is a memcmp of their bytes.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
-    }
-    // equals
-    return 0;
+    return memcmp(lhs.data_, rhs.data_, KeySize);
   }
 
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
@@ -99,6 +253,9 @@ class GenericComparator {
   // constructor
   explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
 
+  /** @return the schema the compared keys were encoded with */
+  auto GetKeySchema() const -> Schema * { return key_schema_; }
+
  private:
   Schema *key_schema_;
 };
@@ -12,12 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -43,14 +46,24 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param include_attrs Base table columns stored in each entry after the key, see GetEntrySchema()
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs_);
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  }
 
   /** @return The name of the index */
   inline auto GetName() const -> const std::string & { return name_; }
@@ -72,6 +85,18 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return The base table columns that are stored in each entry without being part of the key */
+  inline auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return include_attrs_; }
+
+  /**
+   * @return The schema of an index entry: the key columns followed by the included columns. Entries are inserted and
+   * deleted in this schema, which is the key schema unless the index includes columns.
+   */
+  inline auto GetEntrySchema() const -> Schema * { return entry_schema_; }
+
+  /** @return The base table columns of an index entry, key columns first */
+  inline auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return entry_attrs_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -81,6 +106,9 @@ class IndexMetadata {
        << "Type = B+Tree, "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
+    if (!include_attrs_.empty()) {
+      os << " :: Entry = " << entry_schema_->ToString();
+    }
 
     return os.str();
   }
@@ -92,8 +120,50 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** The base table columns stored in each entry besides the key */
+  const std::vector<uint32_t> include_attrs_;
+  /** The key columns followed by the included columns */
+  std::vector<uint32_t> entry_attrs_;
   /** The schema of the indexed key */
   Schema *key_schema_;
+  /** The schema of an index entry */
+  Schema *entry_schema_;
+};
+
+/**
+ * IndexCursor streams the entries of an index scan one at a time, see Index::GetEntryCursor().
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /**
+   * Moves to the next entry.
+   * @param[out] entry the entry, in the entry schema
+   * @param[out] rid the RID of the entry
+   * @return false once there are no entries left
+   */
+  virtual auto Next(Tuple *entry, RID *rid) -> bool = 0;
+};
+
+/** IndexCursor over entries that were scanned up front, for indexes that cannot stream them. */
+class MaterializedIndexCursor : public IndexCursor {
+ public:
+  explicit MaterializedIndexCursor(std::vector<std::pair<Tuple, RID>> entries) : entries_(std::move(entries)) {}
+
+  auto Next(Tuple *entry, RID *rid) -> bool override {
+    if (next_ == entries_.size()) {
+      return false;
+    }
+    *entry = entries_[next_].first;
+    *rid = entries_[next_].second;
+    next_++;
+    return true;
+  }
+
+ private:
+  std::vector<std::pair<Tuple, RID>> entries_;
+  size_t next_{0};
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +209,23 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /** @return The base table columns stored in each entry besides the key */
+  auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetIncludeAttrs(); }
+
+  /** @return The schema of an index entry, see IndexMetadata::GetEntrySchema() */
+  auto GetEntrySchema() const -> Schema * { return metadata_->GetEntrySchema(); }
+
+  /** @return The base table columns of an index entry */
+  auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetEntryAttrs(); }
+
+  /** @return true if the entries of the index carry every one of the given base table columns */
+  auto CoversColumns(const std::vector<uint32_t> &columns) const -> bool {
+    const auto &entry_attrs = GetEntryAttrs();
+    return std::all_of(columns.begin(), columns.end(), [&entry_attrs](uint32_t column) {
+      return std::find(entry_attrs.begin(), entry_attrs.end(), column) != entry_attrs.end();
+    });
+  }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -153,15 +240,30 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index entry, in the entry schema: the key columns and any included columns
    * @param rid The RID associated with the key (unused)
    * @param transaction The transaction context
    */
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  /**
+   * Insert a batch of entries into the index, e.g. when the index is built over an existing table. The batch is
+   * streamed, so it never has to fit in memory. Indexes that can build themselves from a batch faster than entry by
+   * entry override this.
+   * @param next_entry Stores the next index key and its RID, and returns false once there are none left
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(const std::function<bool(Tuple *key, RID *rid)> &next_entry, Transaction *transaction) {
+    Tuple key;
+    RID rid;
+    while (next_entry(&key, &rid)) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
   /**
    * Delete an index entry by key.
-   * @param key The index key
+   * @param key The index entry, in the entry schema
    * @param rid The RID associated with the key (unused)
    * @param transaction The transaction context
    */
@@ -175,6 +277,86 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for a batch of keys, e.g. the join keys of a batch of outer tuples in an index nested loop join.
+   * Indexes that can look up many keys faster than one by one override this.
+   * @param keys The index keys
+   * @param results Populated with the RIDs of each key: (*results)[i] holds the results for keys[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  /**
+   * Scan every entry of the index in key order, for index-only scans that read the included columns straight from the
+   * index instead of fetching each tuple from the table. Only ordered indexes support this.
+   * @param entries The collection that is populated with each entry, in the entry schema, and its RID
+   * @param transaction The transaction context
+   */
+  virtual void ScanEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+    throw NotImplementedException("index does not support scanning its entries");
+  }
+
+  /**
+   * Scan the entries whose key equals the provided key, the equality access path of an index scan. Indexes that
+   * include columns override this, the entries of the others are their keys.
+   * @param key The index key
+   * @param entries The collection that is populated with each matching entry, in the entry schema, and its RID
+   * @param transaction The transaction context
+   */
+  virtual void ScanEntries(const Tuple &key, std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+    std::vector<RID> result;
+    ScanKey(key, &result, transaction);
+    for (const auto &rid : result) {
+      entries->emplace_back(key, rid);
+    }
+  }
+
+  /**
+   * Scan the entries whose key is in [low_key, high_key], in key order, the range access path of an index scan. Only
+   * ordered indexes support this.
+   * @param low_key The smallest key to return
+   * @param high_key The largest key to return
+   * @param entries The collection that is populated with each matching entry, in the entry schema, and its RID
+   * @param transaction The transaction context
+   */
+  virtual void ScanEntries(const Tuple &low_key, const Tuple &high_key, std::vector<std::pair<Tuple, RID>> *entries,
+                           Transaction *transaction) {
+    throw NotImplementedException("index does not support range scans");
+  }
+
+  /**
+   * Open a cursor over the entries that ScanEntries() returns, in the same order, for scans that consume them one at
+   * a time. Indexes that can stream their entries override this; the default scans them up front.
+   * @param transaction The transaction context
+   * @return the cursor, which must not outlive the index
+   */
+  virtual auto GetEntryCursor(Transaction *transaction) -> std::unique_ptr<IndexCursor> {
+    std::vector<std::pair<Tuple, RID>> entries;
+    ScanEntries(&entries, transaction);
+    return std::make_unique<MaterializedIndexCursor>(std::move(entries));
+  }
+
+  /** Open a cursor over the entries whose key equals the provided key, see GetEntryCursor(). */
+  virtual auto GetEntryCursor(const Tuple &key, Transaction *transaction) -> std::unique_ptr<IndexCursor> {
+    std::vector<std::pair<Tuple, RID>> entries;
+    ScanEntries(key, &entries, transaction);
+    return std::make_unique<MaterializedIndexCursor>(std::move(entries));
+  }
+
+  /** Open a cursor over the entries whose key is in [low_key, high_key], see GetEntryCursor(). */
+  virtual auto GetEntryCursor(const Tuple &low_key, const Tuple &high_key, Transaction *transaction)
+      -> std::unique_ptr<IndexCursor> {
+    std::vector<std::pair<Tuple, RID>> entries;
+    ScanEntries(low_key, high_key, &entries, transaction);
+    return std::make_unique<MaterializedIndexCursor>(std::move(entries));
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
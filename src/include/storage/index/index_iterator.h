@@ -13,31 +13,152 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <deque>
+#include <future>  // NOLINT
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_compressed_leaf_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Iterator over the entries of a B+ tree in key order. A key with a posting list is visited once for each of its
+ * values, so the iterator yields one (key, value) pair per value like a tree of unique keys does.
+ *
+ * A forward iterator (BPlusTree::Begin()) moves towards larger keys on operator++, a reverse iterator
+ * (BPlusTree::RBegin()) towards smaller keys; operator-- moves the other way. Either may carry an inclusive lower and
+ * upper bound, and becomes End() when it steps past one. Leaves only link to their right sibling, so stepping to the
+ * previous leaf descends from the root to the leaf holding the largest key below the current leaf's first key.
+ *
+ * Once a forward scan has crossed a few leaves, the pages of the next leaves along the sibling links are fetched in
+ * the background, so that reading them overlaps with consuming the current one, see PrefetchLeaves().
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = std::conditional_t<PrefixCompressedPages<KeyType>::value,
+                                      BPlusTreeCompressedLeafPage<KeyType, ValueType, KeyComparator>,
+                                      BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>;
+  friend class BPlusTree<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
-  IndexIterator();
+  /**
+   * Creates a forward iterator positioned at an entry of a leaf page.
+   * @param buffer_pool_manager the buffer pool the tree lives in
+   * @param page the leaf page, pinned and read latched; ownership of both passes to the iterator. nullptr for End()
+   * @param index the position in the leaf page
+   * @param tree the tree the leaf belongs to, needed to move backwards; may be null for a forward-only iterator
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                BPlusTree<KeyType, ValueType, KeyComparator> *tree = nullptr);
+  IndexIterator(IndexIterator &&other) noexcept;
   ~IndexIterator();  // NOLINT
 
+  DISALLOW_COPY(IndexIterator);
+
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
+  /** Moves to the next entry in the direction of the iterator. */
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  /** Moves to the next entry against the direction of the iterator. */
+  auto operator--() -> IndexIterator &;
+
+  /** Iterators are equal if they are both End(), or point at the same value with the same direction and bounds. */
+  auto operator==(const IndexIterator &itr) const -> bool {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return GetPageId() == itr.GetPageId() && index_ == itr.index_ && posting_index_ == itr.posting_index_ &&
+           reverse_ == itr.reverse_ && SameBound(low_key_, itr.low_key_) && SameBound(high_key_, itr.high_key_);
+  }
+
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  /** @return true if the iterator moves towards smaller keys on operator++ */
+  auto IsReverse() const -> bool { return reverse_; }
+
+  /** The most leaves a forward scan fetches ahead of the one it reads. */
+  static constexpr size_t PREFETCH_LEAVES = 8;
 
  private:
-  // add your own private member variables here
+  /** A bound of the iterator, if it has one. */
+  using Bound = std::pair<bool, KeyType>;
+
+  auto GetPageId() const -> page_id_t { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  auto SameBound(const Bound &a, const Bound &b) const -> bool;
+
+  /** Steps to the next larger or smaller value. */
+  void StepForward();
+  void StepBackward();
+
+  /** Moves forward over exhausted leaves until the iterator points at an entry or becomes End(). */
+  void SkipExhaustedLeaves();
+
+  /** Makes the latched and pinned next leaf the current one, at its first entry. */
+  void MoveTo(Page *page);
+
+  /**
+   * Positions the iterator at the last entry whose key is smaller than key, or the very last entry if key is null.
+   * The iterator becomes End() if there is none.
+   */
+  void SeekBefore(const KeyType *key);
+
+  /** Makes the iterator End() if the current entry lies outside its bounds. */
+  void CheckBounds();
+
+  /** Reads the posting list of the current entry, if it has one, and visits it from the last value if from_back. */
+  void LoadPostings(bool from_back = false);
+
+  /**
+   * Keeps up to PREFETCH_LEAVES leaves after the current one pinned, fetching them on the tree's prefetch worker,
+   * which every scan of the tree shares. Only the pages are fetched, they are latched briefly to follow their sibling
+   * link and then latched again when visited. Iterators without a tree do not prefetch.
+   */
+  void PrefetchLeaves();
+
+  /** @return the pinned prefetched page with the given id, whose pin passes to the caller, or nullptr */
+  auto TakePrefetched(page_id_t page_id) -> Page *;
+
+  /** Waits for the background task and unpins every prefetched page. */
+  void DropPrefetched();
+
+  /** Releases the latch and the pin on the current leaf. */
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_;
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
+  Page *page_;
+  LeafPage *leaf_{nullptr};
+  int index_;
+  /** The entry operator* returned last: leaf pages may store keys and values apart, so entries are copied out. */
+  MappingType item_;
+  /** The values of the current entry if it is a posting list, read while the leaf is latched, and the one visited. */
+  std::vector<ValueType> postings_;
+  size_t posting_index_{0};
+  bool reverse_{false};
+  Bound low_key_{false, KeyType{}};
+  Bound high_key_{false, KeyType{}};
+  /** Leaves visited so far; prefetching starts once a scan has moved past the first few. */
+  size_t leaves_visited_{0};
+  /** Pinned leaves following the current one, in sibling order, and the page id after the last of them. */
+  std::deque<Page *> prefetched_;
+  page_id_t prefetch_next_page_id_{INVALID_PAGE_ID};
+  /** The queued fetch of further leaves: the pinned pages and the page id after the last of them. */
+  std::future<std::pair<std::vector<Page *>, page_id_t>> prefetch_task_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_internal_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_compressed_internal_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/b_plus_tree_compressed_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE BPlusTreeCompressedInternalPage<KeyType, ValueType, KeyComparator>
+
+/**
+ * Internal page in the prefix-compressed format, see BPlusTreeCompressedPage. It has the interface of
+ * BPlusTreeInternalPage, and BPlusTree uses it in its place for key types that PrefixCompressedPages opts in.
+ *
+ * Unlike in BPlusTreeInternalPage, key 0 is valid: it always equals the low key, so that KeyAt(0) is the separator
+ * in the parent, and only keys from index 1 on can be set. The keys come from leaf splits and are already truncated.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeCompressedInternalPage : public BPlusTreeCompressedPage<KeyType, ValueType> {
+ public:
+  // must call initialize method after "create" a new node
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = COMPRESSED_INTERNAL_PAGE_SIZE);
+
+  void SetKeyAt(int index, const KeyType &key);
+  auto ValueIndex(const ValueType &value) const -> int;
+  auto ValueAt(int index) const -> ValueType;
+  auto CoversKey(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+  auto InsertNode(const KeyType &new_key, const ValueType &new_value, const KeyComparator &comparator) -> int;
+  void Remove(int index);
+  auto RemoveAndReturnOnlyChild() -> ValueType;
+
+  // Bulk load helper method: appends a child that sorts after every child already in the page. The child's parent page
+  // id is left to the caller.
+  void Append(const KeyType &key, const ValueType &child);
+
+  // Split and Merge utility methods. They update the key ranges of both pages.
+  void MoveAllTo(BPlusTreeCompressedInternalPage *recipient, const KeyType &middle_key,
+                 BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeCompressedInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveFirstToEndOf(BPlusTreeCompressedInternalPage *recipient, const KeyType &middle_key,
+                        BufferPoolManager *buffer_pool_manager);
+  void MoveLastToFrontOf(BPlusTreeCompressedInternalPage *recipient, const KeyType &middle_key,
+                         BufferPoolManager *buffer_pool_manager);
+
+  // Whether the matching Move method leaves me with room for another entry, see BPlusTreeCompressedLeafPage.
+  auto CanMergeFrom(const BPlusTreeCompressedInternalPage *right, const KeyType &middle_key) const -> bool;
+  auto CanTakeFirstOf(const BPlusTreeCompressedInternalPage *right, const KeyType &middle_key) const -> bool;
+  auto CanTakeLastOf(const BPlusTreeCompressedInternalPage *left, const KeyType &middle_key) const -> bool;
+
+ private:
+  void Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager);
+};
+}  // namespace bustub
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_leaf_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_compressed_leaf_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/b_plus_tree_compressed_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE BPlusTreeCompressedLeafPage<KeyType, ValueType, KeyComparator>
+
+/**
+ * Leaf page in the prefix-compressed format, see BPlusTreeCompressedPage. It has the interface of BPlusTreeLeafPage,
+ * and BPlusTree uses it in its place for key types that PrefixCompressedPages opts in.
+ *
+ * The key range is always maintained, in both tree modes: a split cuts the page with the shortest separator near its
+ * middle (suffix truncation), and that separator becomes the low key of the new page and the high key of the old one.
+ * Because a page may be full before it reaches its max size, merges and redistributions must first check that the
+ * result fits, see CanMergeFrom() and friends.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeCompressedLeafPage : public BPlusTreeCompressedPage<KeyType, ValueType> {
+ public:
+  // After creating a new leaf page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = COMPRESSED_LEAF_PAGE_SIZE);
+  // helper methods
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+  auto GetItem(int index) const -> MappingType;
+  void SetValueAt(int index, const ValueType &value);
+  auto CoversKey(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
+  // insert and delete methods
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
+
+  // Bulk load helper method: appends items that sort after every key already in the page.
+  void Append(const MappingType *items, int size);
+
+  // Split and Merge utility methods. They update the key ranges of both pages.
+  void MoveHalfTo(BPlusTreeCompressedLeafPage *recipient);
+  void MoveAllTo(BPlusTreeCompressedLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeCompressedLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeCompressedLeafPage *recipient);
+
+  // Whether the matching Move method leaves me with room for another entry: MoveAllTo() from my right sibling,
+  // MoveFirstToEndOf() from my right sibling, and MoveLastToFrontOf() from my left sibling.
+  auto CanMergeFrom(const BPlusTreeCompressedLeafPage *right) const -> bool;
+  auto CanTakeFirstOf(const BPlusTreeCompressedLeafPage *right) const -> bool;
+  auto CanTakeLastOf(const BPlusTreeCompressedLeafPage *left) const -> bool;
+};
+}  // namespace bustub
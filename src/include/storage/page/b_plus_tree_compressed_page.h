@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_compressed_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define COMPRESSED_PAGE_HEADER_SIZE 40
+#define COMPRESSED_LEAF_PAGE_SIZE ((PAGE_SIZE - COMPRESSED_PAGE_HEADER_SIZE) / (sizeof(ValueType) + 4))
+#define COMPRESSED_INTERNAL_PAGE_SIZE ((PAGE_SIZE - COMPRESSED_PAGE_HEADER_SIZE) / (sizeof(page_id_t) + 4))
+
+/**
+ * Whether B+ trees over keys of KeyType use the prefix-compressed page format, see BPlusTreeCompressedPage. Wide keys
+ * opt in: they leave plain pages with a few dozen entries, and their normalized encoding is mostly shared prefixes and
+ * zero padding.
+ */
+template <typename KeyType>
+struct PrefixCompressedPages : std::false_type {};
+template <>
+struct PrefixCompressedPages<GenericKey<32>> : std::true_type {};
+template <>
+struct PrefixCompressedPages<GenericKey<64>> : std::true_type {};
+template <>
+struct PrefixCompressedPages<GenericKey<128>> : std::true_type {};
+template <>
+struct PrefixCompressedPages<GenericKey<256>> : std::true_type {};
+
+/**
+ * Common part of the prefix-compressed leaf and internal pages.
+ *
+ * Every page records the range of keys it is responsible for: the low key (inclusive) and the high key (exclusive)
+ * are the separators in the parent around the page, or the smallest and largest possible key at the edges of the tree.
+ * All keys in the range share the common prefix of the two, which is stored once, so each key only stores the bytes
+ * after the prefix, without the zero padding at its end. Keys are normalized (see GenericKey) and compared with
+ * memcmp, so the comparator of the tree is not consulted.
+ *
+ * Key suffixes vary in length, so the page is slotted: a slot array sorted by key grows from the front, the suffixes
+ * grow from the back. The low and high keys are stored trimmed at the very end of the page, so a page only pays for
+ * the bytes its keys actually use, and short VARCHAR keys in a wide key type cost little more than in a narrow one.
+ * A page is full when it might not fit another entry with a full-length key, so that an insert never fails; how many
+ * entries that is depends on the keys, up to COMPRESSED_LEAF_PAGE_SIZE and COMPRESSED_INTERNAL_PAGE_SIZE.
+ *
+ * Page format (size in byte):
+ *  -----------------------------------------------------------------------------------------------------------------
+ * | HEADER (24) | NextPageId (4) | PrefixSize (2) | HeapBegin (2) | KeyBytes (2) | LowSize (2) | HighSize (2) | (2) |
+ *  -----------------------------------------------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------------
+ * | SLOT(1) | SLOT(2) | ... | SLOT(n) | free space | SUFFIX(k) | ... | SUFFIX(j) | LOW KEY | HIGH KEY |
+ *  ---------------------------------------------------------------------------------------------------
+ * A slot holds the value of an entry and the offset and size of its key suffix. The low key is stored at least up to
+ * the prefix, and a high key of size 0 stands for the largest possible key.
+ */
+template <typename KeyType, typename ValueType>
+class BPlusTreeCompressedPage : public BPlusTreePage {
+ public:
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+
+  // Key range helper methods. Changing the range re-encodes the entries, which must fit with the new prefix.
+  auto GetHighKey() const -> KeyType;
+  void SetHighKey(const KeyType &high_key);
+  auto GetLowKey() const -> KeyType;
+  void SetLowKey(const KeyType &low_key);
+  auto GetPrefixSize() const -> int;
+
+  auto KeyAt(int index) const -> KeyType;
+
+  // Space helper methods, in units of entries with a full-length key.
+  auto HasRoomFor(int entries) const -> bool;
+  auto StaysHalfFull(int removed_entries) const -> bool;
+
+  /** @return the shortest key that is greater than left and not greater than right, i.e. a truncated separator */
+  static auto Separator(const KeyType &left, const KeyType &right) -> KeyType;
+
+  /** @return the size of key without its trailing zero bytes, the most a page stores of it */
+  static auto TrimmedSize(const KeyType &key) -> int;
+
+  /** @return how many entries whose keys have a trimmed size of at most key_size a page fits without becoming full */
+  static auto CapacityFor(int key_size) -> int;
+
+  /** @return the bytes a page with these entries and key range would use for slots, key suffixes and its key range */
+  static auto EncodedSize(const std::vector<std::pair<KeyType, ValueType>> &entries, const KeyType &low_key,
+                          const KeyType &high_key) -> int;
+
+  /** @return true if a page with these entries and key range would not be full */
+  static auto Fits(const std::vector<std::pair<KeyType, ValueType>> &entries, const KeyType &low_key,
+                   const KeyType &high_key) -> bool;
+
+ protected:
+  struct Slot {
+    ValueType value_;
+    uint16_t offset_;
+    uint16_t size_;
+  };
+
+  /** Empties the page and makes it responsible for every key. */
+  void Reset();
+
+  auto ValueRef(int index) const -> const ValueType &;
+  auto ValueRef(int index) -> ValueType &;
+
+  /** @return the number of keys in [begin, size) that are smaller than key, plus begin */
+  auto LowerBound(int begin, const KeyType &key) const -> int;
+  /** @return the number of keys in [begin, size) that are smaller than or equal to key, plus begin */
+  auto UpperBound(int begin, const KeyType &key) const -> int;
+  auto KeyEquals(int index, const KeyType &key) const -> bool;
+
+  /** Inserts an entry at index. The key must be in the page's range and the page must have room for it. */
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  /** Replaces the key at index, keeping its value. */
+  void ReplaceKeyAt(int index, const KeyType &key);
+
+  auto GetEntries() const -> std::vector<std::pair<KeyType, ValueType>>;
+  /** Re-encodes the page from scratch with the given entries and key range, which may be the page's own. */
+  void Rebuild(const std::vector<std::pair<KeyType, ValueType>> &entries, KeyType low_key, KeyType high_key);
+
+ private:
+  /** Bytes for slots, key suffixes and the key range. */
+  static constexpr int CAPACITY = static_cast<int>(PAGE_SIZE - COMPRESSED_PAGE_HEADER_SIZE);
+
+  static auto IsLargestKey(const KeyType &key) -> bool;
+  /** @return the bytes a page with this key range stores its low and high key in */
+  static auto FenceSize(const KeyType &low_key, const KeyType &high_key, int prefix_size) -> int;
+  static auto CommonPrefix(const KeyType &lhs, const KeyType &rhs) -> int;
+  static auto SuffixSize(const KeyType &key, int prefix_size) -> int;
+  /** @return the sign of comparing the key at index with a key suffix of the given size */
+  auto CompareSuffix(int index, const char *suffix, int size) const -> int;
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this); }
+  auto Data() -> char * { return reinterpret_cast<char *>(this); }
+  auto LowKeyData() const -> const char * { return Data() + PAGE_SIZE - high_key_size_ - low_key_size_; }
+  auto UsedBytes() const -> int;
+  /** Bytes of an entry whose key is stored in full after the prefix. */
+  auto MaxEntrySize() const -> int;
+
+  page_id_t next_page_id_;
+  uint16_t prefix_size_;
+  uint16_t heap_begin_;
+  uint16_t key_bytes_;
+  uint16_t low_key_size_;
+  uint16_t high_key_size_;
+  // Flexible array member for page data.
+  Slot slots_[1];
+};
+
+}  // namespace bustub
@@ -12,13 +12,14 @@
 
 #include <queue>
 
+#include "storage/page/b_plus_tree_key_search.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(KeyType)) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -28,9 +29,15 @@ namespace bustub {
  * should ignore the first key.
  *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  -------------------------------------------------------------------------------------
+ * | HEADER | HIGH KEY | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
+ *  -------------------------------------------------------------------------------------
+ *
+ * As in leaf pages, key types that SeparateKeyArray opts in keep the keys and the page ids in two arrays of
+ * INTERNAL_PAGE_SIZE entries each, so that Lookup() can search the keys with KeySearch.
+ *
+ * The header extends the common header with the id of the right sibling (4 bytes). The right sibling and the high key
+ * are only maintained by B-link trees, see GetHighKey().
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -43,12 +50,25 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto ValueIndex(const ValueType &value) const -> int;
   auto ValueAt(int index) const -> ValueType;
 
+  // B-link helper methods: the high key is the exclusive upper bound of the keys that belong to this page. It is only
+  // meaningful while the page has a right sibling; the rightmost page of a level is unbounded.
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &high_key);
+  auto CoversKey(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+  auto InsertNode(const KeyType &new_key, const ValueType &new_value, const KeyComparator &comparator) -> int;
   void Remove(int index);
   auto RemoveAndReturnOnlyChild() -> ValueType;
 
+  // Bulk load helper method: appends a child that sorts after every child already in the page. The child's parent page
+  // id is left to the caller.
+  void Append(const KeyType &key, const ValueType &child);
+
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
@@ -58,9 +78,25 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  static constexpr bool SEPARATE_KEYS = SeparateKeyArray<KeyType>::value;
+
+  // Layout helper methods, see BPlusTreeLeafPage. Keys() and Values() are only meaningful with SEPARATE_KEYS.
+  auto Keys() const -> const KeyType *;
+  auto Keys() -> KeyType *;
+  auto Values() const -> const ValueType *;
+  auto Values() -> ValueType *;
+  auto KeyRef(int index) const -> const KeyType &;
+  auto KeyRef(int index) -> KeyType &;
+  auto ValueRef(int index) const -> const ValueType &;
+  auto ValueRef(int index) -> ValueType &;
+  void MoveEntries(int from, int to, int size);
+
+  void CopyNFrom(const BPlusTreeInternalPage *source, int start, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyLastFrom(const KeyType &key, const ValueType &value, BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(const KeyType &key, const ValueType &value, BufferPoolManager *buffer_pool_manager);
+  void Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager);
+  page_id_t next_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search.h
+//
+// Identification: src/include/storage/page/b_plus_tree_key_search.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <type_traits>
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * Whether B+ tree pages store keys of KeyType in a contiguous array of their own instead of interleaved with the
+ * values, see BPlusTreeLeafPage. Only keys that KeySearch has SIMD kernels for opt in.
+ */
+template <typename KeyType>
+struct SeparateKeyArray : std::false_type {};
+template <>
+struct SeparateKeyArray<GenericKey<4>> : std::true_type {};
+template <>
+struct SeparateKeyArray<GenericKey<8>> : std::true_type {};
+
+/**
+ * SIMD search over a sorted, contiguous array of 4- or 8-byte GenericKeys.
+ *
+ * Normalized keys order like big-endian unsigned integers, see GenericKey, so a kernel byte-swaps each key and flips
+ * its sign bit to compare it with signed integer SIMD compares. A search narrows the range with a binary search until
+ * it spans a few cache lines, then counts the keys below the search key in that window, several keys per instruction.
+ *
+ * The kernel is picked once from what the CPU supports: AVX2, SSE4.2, or a scalar fallback.
+ */
+class KeySearch {
+ public:
+  enum class Kernel { SCALAR, SSE42, AVX2 };
+
+  /** @return the number of keys in keys[0, size) that are smaller than key, i.e. the index of its lower bound */
+  static auto CountLess(const GenericKey<4> *keys, int size, const GenericKey<4> &key) -> int;
+  static auto CountLess(const GenericKey<8> *keys, int size, const GenericKey<8> &key) -> int;
+
+  /** @return the number of keys in keys[0, size) that are smaller than or equal to key */
+  static auto CountLessEqual(const GenericKey<4> *keys, int size, const GenericKey<4> &key) -> int;
+  static auto CountLessEqual(const GenericKey<8> *keys, int size, const GenericKey<8> &key) -> int;
+
+  /** @return the kernel searches run with */
+  static auto GetKernel() -> Kernel;
+
+  /** Overrides the kernel, e.g. to compare kernels in tests. Kernels the CPU does not support fall back to SCALAR. */
+  static void SetKernel(Kernel kernel);
+};
+
+}  // namespace bustub
@@ -13,13 +13,14 @@
 #include <utility>
 #include <vector>
 
+#include "storage/page/b_plus_tree_key_search.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType)) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -27,9 +28,17 @@ namespace bustub {
  * page. Only support unique key.
  *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | HIGH KEY | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  ---------------------------------------------------------------------------------
+ *
+ * Key types that SeparateKeyArray opts in keep their keys apart from the RIDs instead, so that KeyIndex() can scan
+ * contiguous keys with SIMD instructions, see KeySearch. Both arrays are sized for LEAF_PAGE_SIZE entries:
+ *  -------------------------------------------------------------------------------------------
+ * | HEADER | HIGH KEY | KEY(1) | KEY(2) | ... | KEY(n) | ... | RID(1) | RID(2) | ... | RID(n) | ...
+ *  -------------------------------------------------------------------------------------------
+ *
+ * The high key is only maintained by B-link trees, see GetHighKey().
  *
  *  Header format (size in byte, 28 bytes in total):
  *  ---------------------------------------------------------------------
@@ -50,13 +59,23 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void SetNextPageId(page_id_t next_page_id);
   auto KeyAt(int index) const -> KeyType;
   auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
-  auto GetItem(int index) -> const MappingType &;
+  auto GetItem(int index) const -> MappingType;
+  void SetValueAt(int index, const ValueType &value);
+
+  // B-link helper methods: the high key is the exclusive upper bound of the keys that belong to this page. It is only
+  // meaningful while the page has a right sibling; the rightmost page of a level is unbounded.
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &high_key);
+  auto CoversKey(const KeyType &key, const KeyComparator &comparator) const -> bool;
 
   // insert and delete methods
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
   auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
   auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
 
+  // Bulk load helper method: appends items that sort after every key already in the page.
+  void Append(const MappingType *items, int size);
+
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
@@ -64,10 +83,25 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+  static constexpr bool SEPARATE_KEYS = SeparateKeyArray<KeyType>::value;
+
+  // Layout helper methods: every access to array_ goes through these, so that the rest of the page does not depend on
+  // whether keys are interleaved with the values. Keys() and Values() are only meaningful with SEPARATE_KEYS.
+  auto Keys() const -> const KeyType *;
+  auto Keys() -> KeyType *;
+  auto Values() const -> const ValueType *;
+  auto Values() -> ValueType *;
+  auto KeyRef(int index) const -> const KeyType &;
+  auto KeyRef(int index) -> KeyType &;
+  auto ValueRef(int index) const -> const ValueType &;
+  auto ValueRef(int index) -> ValueType &;
+  void MoveEntries(int from, int to, int size);
+
+  void CopyNFrom(const BPlusTreeLeafPage *source, int start, int size);
+  void CopyLastFrom(const KeyType &key, const ValueType &value);
+  void CopyFirstFrom(const KeyType &key, const ValueType &value);
   page_id_t next_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_posting_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 8
+#define POSTING_PAGE_SIZE ((PAGE_SIZE - POSTING_PAGE_HEADER_SIZE) / sizeof(RID))
+
+/**
+ * Page of a posting list: the RIDs of a key that occurs in more than one tuple, for B+ trees with non-unique keys.
+ *
+ * A key with a single RID stores it inline in its leaf entry. Once a key has several, the leaf entry holds a marker RID
+ * (see IsPostingList()) that names the head page of a chain of posting pages, and the RIDs are stored there at 8 bytes
+ * each instead of one leaf entry per duplicate. Only the head page may be partially filled: appends go to the head,
+ * which first moves its RIDs into a new second page when it is full, and a remove fills the hole with the last RID of
+ * the head. The RIDs of a posting list are in no particular order.
+ *
+ * Posting pages are only read and written under the latch of the leaf page that points to them, so they need no
+ * latches of their own.
+ *
+ * Page format (size in byte):
+ *  -----------------------------------------------------------------
+ * | NextPageId (4) | Size (4) | RID(1) | RID(2) | ... | RID(n) |
+ *  -----------------------------------------------------------------
+ */
+class BPlusTreePostingPage {
+ public:
+  /** @return true if the leaf value rid is a marker for a posting list rather than the RID of a tuple */
+  static auto IsPostingList(const RID &rid) -> bool { return rid.GetSlotNum() == POSTING_LIST_SLOT_NUM; }
+
+  /**
+   * Starts a posting list with two RIDs.
+   * @return the marker to store in the leaf entry in place of the RIDs
+   */
+  static auto Create(BufferPoolManager *buffer_pool_manager, const RID &first, const RID &second) -> RID;
+
+  /** Appends a RID to the posting list that marker points to. */
+  static void Append(BufferPoolManager *buffer_pool_manager, const RID &marker, const RID &rid);
+
+  /**
+   * Removes a RID from the posting list that marker points to. A posting list left with a single RID is freed.
+   * @param[out] remaining the value the leaf entry should hold from now on: marker, or the only RID left
+   * @return false if the RID is not in the posting list
+   */
+  static auto Remove(BufferPoolManager *buffer_pool_manager, const RID &marker, const RID &rid, RID *remaining)
+      -> bool;
+
+  /** Appends every RID of the posting list that marker points to to result. */
+  static void Collect(BufferPoolManager *buffer_pool_manager, const RID &marker, std::vector<RID> *result);
+
+  /** Deletes every page of the posting list that marker points to. */
+  static void Free(BufferPoolManager *buffer_pool_manager, const RID &marker);
+
+ private:
+  /** Slot number of a posting list marker; tuple slots never get anywhere near it. */
+  static constexpr uint32_t POSTING_LIST_SLOT_NUM = UINT32_MAX;
+
+  void Init();
+  auto IsFull() const -> bool { return size_ == static_cast<int32_t>(POSTING_PAGE_SIZE); }
+
+  static auto Fetch(BufferPoolManager *buffer_pool_manager, page_id_t page_id) -> BPlusTreePostingPage *;
+
+  page_id_t next_page_id_;
+  int32_t size_;
+  // Flexible array member for page data.
+  RID rids_[1];
+};
+
+}  // namespace bustub
@@ -66,7 +66,7 @@ class HashTableBlockPage {
    * @param value value to insert
    * @return If the value is inserted successfully, it returns true. If the
    * index is marked as occupied before the key and value can be inserted,
-   * Insert returns false.
+   * Insert returns false. An index that holds a tombstone is reused.
    */
   auto Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool;
 
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -31,7 +32,12 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  readable_ arrays and the fingerprints_ array. More information is in
+ *  storage/page/hash_table_page_defs.h.
+ *
+ *  Every slot has a one byte fingerprint of its key. Lookups compare the
+ *  fingerprint of the key they look for with 16 slots at once and only call
+ *  the comparator on readable slots whose fingerprint matches.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -138,10 +144,31 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /** Number of slots whose fingerprints are compared at once. */
+  static constexpr uint32_t FINGERPRINT_GROUP_SIZE = 16;
+
+  /** @return the fingerprint of a key, a hash of its bytes; keys that compare equal have equal bytes */
+  static auto Fingerprint(const KeyType &key) -> uint8_t;
+
+  /**
+   * @param group_start the first slot of a group of FINGERPRINT_GROUP_SIZE slots
+   * @return a bitmask of the readable slots in the group whose fingerprint is fingerprint, bit i for group_start + i
+   */
+  auto MatchFingerprint(uint32_t group_start, uint8_t fingerprint) const -> uint32_t;
+
+  /** @return the number of occupied slots; they form a prefix of the array */
+  auto NumOccupied() const -> uint32_t;
+
+  /** @return the first slot that is free to insert into, or BUCKET_ARRAY_SIZE if the bucket is full */
+  auto FreeSlot() const -> uint32_t;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // Fingerprint of the key in each occupied slot, padded to whole groups so that a group can be loaded at once.
+  uint8_t fingerprints_[(BUCKET_ARRAY_SIZE - 1) / FINGERPRINT_GROUP_SIZE * FINGERPRINT_GROUP_SIZE +
+                        FINGERPRINT_GROUP_SIZE];
   MappingType array_[1];
 };
 
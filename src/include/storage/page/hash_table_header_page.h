@@ -26,13 +26,17 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
+ * Header format (size in byte, 32 bytes in total, with padding):
  * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
+ * | LSN (4) | Size (8) | PageId(4) | NextBlockIndex(8)
  * -------------------------------------------------------------
+ * followed by the page ids of the block pages, in slot order.
  */
 class HashTableHeaderPage {
  public:
+  /** The most block pages one header page can list. */
+  static constexpr size_t MAX_BLOCKS = (PAGE_SIZE - 32) / sizeof(page_id_t);
+
   /**
    * @return the number of buckets in the hash table;
    */
@@ -76,6 +80,14 @@ class HashTableHeaderPage {
    */
   void AddBlockPageId(page_id_t page_id);
 
+  /**
+   * Sets the page_id of the index-th block
+   *
+   * @param index the index of the block
+   * @param page_id the page_id of the block
+   */
+  void SetBlockPageId(size_t index, page_id_t page_id);
+
   /**
    * Returns the page_id of the index-th block
    *
@@ -90,12 +102,12 @@ class HashTableHeaderPage {
   auto NumBlocks() -> size_t;
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
   // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  page_id_t block_page_ids_[1];
 };
 
 }  // namespace bustub
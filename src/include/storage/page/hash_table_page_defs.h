@@ -37,8 +37,9 @@
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_ and a one byte fingerprint.
+ * 4 * (PAGE_SIZE - 24) / (4 * sizeof (MappingType) + 5) = (PAGE_SIZE - 24)/(sizeof (MappingType) + 1.25) because 1.25
+ * bytes is the space required to maintain the occupied and readable flags and the fingerprint of a key value pair.
+ * The 24 bytes cover the padding of the fingerprints to whole groups of 16 and the alignment of the pairs.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (PAGE_SIZE - 24) / (4 * sizeof(MappingType) + 5))
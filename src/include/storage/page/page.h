@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -48,11 +50,18 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The page version is odd while the write latch is held. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +69,33 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** @return true if the page read latch was acquired without waiting */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
+  /**
+   * Begin an optimistic read. Unlike RLatch() this does not write to the page, so concurrent readers do not contend
+   * on its cache line. Waits for any current writer to finish. The caller must keep the page pinned and must treat
+   * everything it reads as garbage until ValidateRead() succeeds.
+   * @return the version to pass to ValidateRead()
+   */
+  inline auto OptimisticRLatch() const -> uint64_t {
+    uint64_t version;
+    while (((version = version_.load(std::memory_order_acquire)) & 1) != 0) {
+      std::this_thread::yield();
+    }
+    return version;
+  }
+
+  /**
+   * Finish (or check the progress of) an optimistic read.
+   * @param version the version returned by OptimisticRLatch()
+   * @return true if no writer latched the page since, i.e. everything read in between is consistent
+   */
+  inline auto ValidateRead(uint64_t version) const -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -86,8 +122,10 @@ class Page {
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
-  /** Page latch. */
-  ReaderWriterLatch rwlatch_;
+  /** Page latch. Writer-preferring, so a structure modification is not starved by concurrent traversals. */
+  ReaderWriterLatch rwlatch_{true};
+  /** Page version for optimistic readers, bumped on both WLatch() and WUnlatch(). */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -51,7 +51,9 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false. Inserts of optimistic
+   * transactions are applied at once too, since the caller needs the RID; nobody has read the new tuple's version yet,
+   * and an abort deletes it again.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -60,7 +62,8 @@ class TableHeap {
   auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
 
   /**
-   * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
+   * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called. The delete of an optimistic
+   * transaction is only buffered, and applied at commit.
    * @param rid resource id of the tuple of delete
    * @param txn transaction performing the delete
    * @return true iff the delete is successful (i.e the tuple exists)
@@ -68,7 +71,8 @@ class TableHeap {
   auto MarkDelete(const RID &rid, Transaction *txn) -> bool;  // for delete
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * if the new tuple is too large to fit in the old page, return false (will delete and insert). The update of an
+   * optimistic transaction is only buffered, and applied at commit.
    * @param tuple new tuple
    * @param rid rid of the old tuple
    * @param txn transaction performing the update
@@ -83,6 +87,12 @@ class TableHeap {
    */
   void ApplyDelete(const RID &rid, Transaction *txn);
 
+  /** Mark the tuple as deleted in place, whatever the concurrency mode, e.g. to apply a buffered delete. */
+  auto MarkDeleteInPlace(const RID &rid, Transaction *txn) -> bool;
+
+  /** Update the tuple in place, whatever the concurrency mode, e.g. to apply a buffered update or undo an update. */
+  auto UpdateTupleInPlace(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool;
+
   /**
    * Called on abort to rollback a delete.
    * @param rid rid of the deleted tuple.
@@ -91,7 +101,8 @@ class TableHeap {
   void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
-   * Read a tuple from the table.
+   * Read a tuple from the table. An optimistic transaction takes no lock; it records the version of the tuple for
+   * validation at commit, and sees the writes it has buffered.
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
@@ -98,6 +98,9 @@ class ValueFactory {
       case TypeId::VARCHAR:
         ret_value = GetVarcharValue(nullptr, false, nullptr);
         break;
+      case TypeId::TIMESTAMP:
+        ret_value = GetTimestampValue(BUSTUB_TIMESTAMP_NULL);
+        break;
       default: {
         throw Exception(ExceptionType::UNKNOWN_TYPE, "Attempting to create invalid null type");
       }
@@ -9,7 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -20,30 +22,125 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, BPlusTreeMode mode, bool unique_keys,
+                          bool bloom_filter)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      // An internal page briefly holds one entry more than its max size before it splits.
+      internal_max_size_(std::min<int>(internal_max_size, INTERNAL_PAGE_CAPACITY - 1)),
+      mode_(mode),
+      unique_keys_(unique_keys),
+      bloom_filter_(bloom_filter ? std::make_unique<BloomFilter>() : nullptr) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values associated with input key: its only value, or every value
+ * in its posting list
  * This method is used for point query
+ * A key that the Bloom filter rules out is not looked for in the tree at all
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  return false;
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(bloom_hash_.GetHash(key))) {
+    return false;
+  }
+  auto *page = FindLeaf(key, Operation::FIND);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  if (found && BPlusTreePostingPage::IsPostingList(value)) {
+    BPlusTreePostingPage::Collect(buffer_pool_manager_, value, result);
+  } else if (found) {
+    result->push_back(value);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*
+ * Return the values of every key of a batch, (*results)[i] for keys[i]
+ * The keys are looked up in sorted order, so that a run of keys that fall into
+ * the same leaf, or into sibling leaves under one parent, costs a single
+ * descent from the root, see MoveBatchCursor()
+ * This method is used for index nested loop joins
+ * Keys that the Bloom filter rules out are left out of the batch
+ * @return : the number of keys that exist
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) -> size_t {
+  results->assign(keys.size(), {});
+  std::vector<size_t> order;
+  order.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (bloom_filter_ == nullptr || bloom_filter_->MayContain(bloom_hash_.GetHash(keys[i]))) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [this, &keys](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  size_t found = 0;
+  Page *parent = nullptr;
+  Page *page = nullptr;
+  for (size_t i : order) {
+    if (!MoveBatchCursor(keys[i], &parent, &page)) {
+      break;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType value;
+    if (!leaf->Lookup(keys[i], &value, comparator_)) {
+      continue;
+    }
+    if (BPlusTreePostingPage::IsPostingList(value)) {
+      BPlusTreePostingPage::Collect(buffer_pool_manager_, value, &(*results)[i]);
+    } else {
+      (*results)[i].push_back(value);
+    }
+    found++;
+  }
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  if (parent != nullptr) {
+    parent->RUnlatch();
+    buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
+  }
+  return found;
+}
+
+/*
+ * Find the successor of the input key, which does not need to be in the tree.
+ * Used by next-key locking to find the key that guards the gap around input key.
+ * @return : false means input key is greater than or equal to every key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetNextKey(const KeyType &key, KeyType *next_key) -> bool {
+  auto iterator = Begin(key);
+  if (!iterator.IsEnd() && comparator_((*iterator).first, key) == 0) {
+    ++iterator;
+  }
+  if (iterator.IsEnd()) {
+    return false;
+  }
+  *next_key = (*iterator).first;
+  return true;
 }
 
 /*****************************************************************************
@@ -53,12 +150,53 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: with unique keys, if user try to insert duplicate keys return
+ * false; otherwise return true unless the pair is already in the tree.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+  if (bloom_filter_ != nullptr) {
+    // Before the key is visible, so that no lookup that could find it is ruled out by the filter.
+    bloom_filter_->Insert(bloom_hash_.GetHash(key));
+  }
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    return InsertBLink(key, value);
+  }
+  // Most inserts do not split their leaf, so try with a write latch on the leaf alone first.
+  auto *page = FindLeafOptimistic(key);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType existing;
+    bool duplicate = leaf->Lookup(key, &existing, comparator_);
+    bool safe = IsSafe(leaf, Operation::INSERT);
+    bool inserted = false;
+    if (duplicate) {
+      // A repeated key never grows the leaf, its values go into a posting list.
+      inserted = !unique_keys_ && InsertDuplicate(leaf, key, existing, value);
+    } else if (safe) {
+      leaf->Insert(key, value, comparator_);
+      inserted = true;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+    if (duplicate || safe) {
+      return inserted;
+    }
+  }
+
+  // The leaf may split or the tree is empty: restart with pessimistic crabbing.
+  Context ctx;
+  root_latch_.WLock();
+  ctx.root_latched_ = true;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    ReleaseContext(&ctx);
+    return true;
+  }
+  FindLeaf(key, Operation::INSERT, &ctx);
+  bool inserted = InsertIntoLeaf(key, value, &ctx);
+  ReleaseContext(&ctx);
+  return inserted;
 }
 /*
  * Insert constant key & value pair into an empty tree
@@ -67,19 +205,62 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  auto *page = NewPage(&page_id);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: with unique keys, if user try to insert duplicate keys return
+ * false; otherwise return true unless the pair is already in the tree.
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  return false;
+auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Context *ctx) -> bool {
+  auto *leaf = reinterpret_cast<LeafPage *>(ctx->write_set_.back()->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    return !unique_keys_ && InsertDuplicate(leaf, key, existing, value);
+  }
+  leaf->Insert(key, value, comparator_);
+  if (IsOverflow(leaf)) {
+    auto *new_leaf = Split(leaf);
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    leaf->SetNextPageId(new_leaf->GetPageId());
+    InsertIntoParent(leaf, LowKey(new_leaf), new_leaf, ctx);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  return true;
+}
+
+/*
+ * The second value of a key moves both into a new posting list, later values
+ * are appended to it. Only the value of the leaf entry changes, so the leaf
+ * never splits. A value already in a posting list is not looked for: callers
+ * insert each (key, RID) pair once.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertDuplicate(LeafPage *leaf, const KeyType &key, const ValueType &existing,
+                                     const ValueType &value) -> bool {
+  if (BPlusTreePostingPage::IsPostingList(existing)) {
+    BPlusTreePostingPage::Append(buffer_pool_manager_, existing, value);
+    return true;
+  }
+  if (existing == value) {
+    return false;
+  }
+  ValueType marker = BPlusTreePostingPage::Create(buffer_pool_manager_, existing, value);
+  leaf->SetValueAt(leaf->KeyIndex(key, comparator_), marker);
+  return true;
 }
 
 /*
@@ -92,7 +273,17 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::Split(N *node) -> N * {
-  return nullptr;
+  page_id_t page_id;
+  auto *new_node = reinterpret_cast<N *>(NewPage(&page_id)->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    node->MoveHalfTo(new_node);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    // B-link trees keep no parent pointers, so the moved children need not be adopted.
+    node->MoveHalfTo(new_node, mode_ == BPlusTreeMode::B_LINK ? nullptr : buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -106,7 +297,273 @@ auto BPLUSTREE_TYPE::Split(N *node) -> N * {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Context *ctx) {
+  if (old_node->IsRootPage()) {
+    // The root latch is still held: a root that can split is never safe.
+    page_id_t root_id;
+    auto *root = reinterpret_cast<InternalPage *>(NewPage(&root_id)->GetData());
+    root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+  // The parent was not safe either, so it is still write latched in ctx.
+  page_id_t parent_id = old_node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchPage(parent_id)->GetData());
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(parent_id);
+  if (IsOverflow(parent)) {
+    auto *new_parent = Split(parent);
+    InsertIntoParent(parent, LowKey(new_parent), new_parent, ctx);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_id, true);
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Build an empty tree from a batch of entries, bottom-up.
+ * The number of pages on every level is planned up front, so each page is
+ * started knowing how many entries it gets and is added to its parent right
+ * away. Only the page being filled on each level is pinned.
+ * @return: false if the tree is not empty or the batch has duplicate keys
+ * that the tree does not allow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(std::vector<std::pair<KeyType, ValueType>> *entries, double fill_factor) -> bool {
+  auto less = [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; };
+  if (!std::is_sorted(entries->begin(), entries->end(), less)) {
+    std::sort(entries->begin(), entries->end(), less);
+  }
+  auto equal = [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) == 0; };
+  bool duplicates = std::adjacent_find(entries->begin(), entries->end(), equal) != entries->end();
+  if (duplicates && unique_keys_) {
+    return false;
+  }
+  if (bloom_filter_ != nullptr) {
+    for (const auto &entry : *entries) {
+      bloom_filter_->Insert(bloom_hash_.GetHash(entry.first));
+    }
+  }
+
+  root_latch_.WLock();
+  if (!IsEmpty() || entries->empty()) {
+    bool empty = IsEmpty();
+    root_latch_.WUnlock();
+    return empty;
+  }
+  if (duplicates) {
+    // Each run of a repeated key becomes a single entry whose value is the run's posting list.
+    size_t size = 0;
+    for (size_t begin = 0, end; begin < entries->size(); begin = end) {
+      end = begin + 1;
+      while (end < entries->size() && equal((*entries)[begin], (*entries)[end])) {
+        end++;
+      }
+      (*entries)[size] = (*entries)[begin];
+      if (end - begin > 1) {
+        ValueType marker =
+            BPlusTreePostingPage::Create(buffer_pool_manager_, (*entries)[begin].second, (*entries)[begin + 1].second);
+        for (size_t i = begin + 2; i < end; i++) {
+          BPlusTreePostingPage::Append(buffer_pool_manager_, marker, (*entries)[i].second);
+        }
+        (*entries)[size].second = marker;
+      }
+      size++;
+    }
+    entries->resize(size);
+  }
+
+  int key_size = 0;
+  if constexpr (PREFIX_COMPRESSED) {
+    for (const auto &entry : *entries) {
+      key_size = std::max(key_size, LeafPage::TrimmedSize(entry.first));
+    }
+  }
+  size_t next = 0;
+  BulkBuild(static_cast<int64_t>(entries->size()), key_size, fill_factor, [entries, &next](int n) {
+    next += n;
+    return entries->data() + next - n;
+  });
+  root_latch_.WUnlock();
+  return true;
+}
+
+/*
+ * Build an empty tree from the entries of an external sort. A first merge
+ * counts the distinct keys, which the pages are planned from, and a second
+ * one fills the leaves, turning each run of a repeated key into a posting
+ * list on the way. Only one leaf's worth of entries is in memory at a time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(ExternalSort<KeyType, ValueType, KeyComparator> *sort, double fill_factor) -> bool {
+  using Merger = typename ExternalSort<KeyType, ValueType, KeyComparator>::Merger;
+  int64_t count = 0;
+  bool duplicates = false;
+  int key_size = 0;
+  {
+    Merger merge(*sort);
+    std::pair<KeyType, ValueType> entry;
+    KeyType previous;
+    while (merge.Next(&entry)) {
+      if (count > 0 && comparator_(entry.first, previous) == 0) {
+        duplicates = true;
+        continue;
+      }
+      count++;
+      previous = entry.first;
+      if constexpr (PREFIX_COMPRESSED) {
+        key_size = std::max(key_size, LeafPage::TrimmedSize(entry.first));
+      }
+    }
+  }
+  if (duplicates && unique_keys_) {
+    return false;
+  }
+
+  root_latch_.WLock();
+  if (!IsEmpty() || count == 0) {
+    bool empty = IsEmpty();
+    root_latch_.WUnlock();
+    return empty;
+  }
+  Merger merge(*sort);
+  std::pair<KeyType, ValueType> pending;
+  bool has_pending = merge.Next(&pending);
+  std::vector<std::pair<KeyType, ValueType>> leaf_entries;
+  BulkBuild(count, key_size, fill_factor, [&](int n) {
+    leaf_entries.clear();
+    while (static_cast<int>(leaf_entries.size()) < n && has_pending) {
+      auto entry = pending;
+      if (bloom_filter_ != nullptr) {
+        bloom_filter_->Insert(bloom_hash_.GetHash(entry.first));
+      }
+      has_pending = merge.Next(&pending);
+      if (has_pending && comparator_(pending.first, entry.first) == 0) {
+        ValueType marker = BPlusTreePostingPage::Create(buffer_pool_manager_, entry.second, pending.second);
+        while ((has_pending = merge.Next(&pending)) && comparator_(pending.first, entry.first) == 0) {
+          BPlusTreePostingPage::Append(buffer_pool_manager_, marker, pending.second);
+        }
+        entry.second = marker;
+      }
+      leaf_entries.push_back(entry);
+    }
+    return leaf_entries.data();
+  });
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkBuild(int64_t count, int key_size, double fill_factor,
+                               const std::function<const std::pair<KeyType, ValueType> *(int)> &next_leaf) {
+  // A leaf splits when it reaches its max size, an internal page when it exceeds it. Internal pages get at least
+  // three children so that even sizing never leaves one with a single child.
+  std::vector<BulkLevel> levels;
+  int capacity = std::max(leaf_max_size_ - 1, 1);
+  int internal_capacity = internal_max_size_;
+  if constexpr (PREFIX_COMPRESSED) {
+    // Pages are planned by entry count, so compressed pages are sized for the longest key in the batch. Separators
+    // are never longer than the keys they come from.
+    capacity = std::max(std::min(capacity, LeafPage::CapacityFor(key_size)), 1);
+    internal_capacity = std::min(internal_capacity, InternalPage::CapacityFor(key_size));
+  }
+  int lower = 1;
+  int64_t remaining = count;
+  while (true) {
+    int per_page = std::clamp(static_cast<int>(capacity * fill_factor), std::min(lower, capacity), capacity);
+    int64_t pages = (remaining + per_page - 1) / per_page;
+    levels.push_back({remaining, pages});
+    if (pages == 1) {
+      break;
+    }
+    remaining = pages;
+    capacity = internal_capacity;
+    lower = 3;
+  }
+
+  KeyType last_key;
+  for (int64_t next = 0; next < count;) {
+    const auto *entries = next_leaf(levels[0].NextTarget());
+    KeyType low_key = entries[0].first;
+    if constexpr (PREFIX_COMPRESSED) {
+      if (next > 0) {
+        low_key = LeafPage::Separator(last_key, low_key);
+      }
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(BulkStartPage(&levels, 0, low_key)->GetData());
+    leaf->Append(entries, levels[0].target_);
+    next += levels[0].target_;
+    last_key = entries[levels[0].target_ - 1].first;
+  }
+  root_page_id_ = levels.back().page_->GetPageId();
+  for (auto &level : levels) {
+    buffer_pool_manager_->UnpinPage(level.page_->GetPageId(), true);
+  }
+  UpdateRootPageId(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkStartPage(std::vector<BulkLevel> *levels, size_t level, const KeyType &low_key) -> Page * {
+  auto &current = (*levels)[level];
+  page_id_t page_id;
+  auto *page = NewPage(&page_id);
+  int target = current.NextTarget();
+  current.started_++;
+  page_id_t parent_id =
+      level + 1 < levels->size() ? BulkAppendChild(levels, level + 1, low_key, page_id) : INVALID_PAGE_ID;
+
+  if (level == 0) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, parent_id, leaf_max_size_);
+    if (current.page_ != nullptr) {
+      auto *previous = reinterpret_cast<LeafPage *>(current.page_->GetData());
+      previous->SetNextPageId(page_id);
+      previous->SetHighKey(low_key);
+      if constexpr (PREFIX_COMPRESSED) {
+        leaf->SetLowKey(low_key);
+      }
+    }
+  } else {
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    node->Init(page_id, parent_id, internal_max_size_);
+    if (current.page_ != nullptr) {
+      auto *previous = reinterpret_cast<InternalPage *>(current.page_->GetData());
+      previous->SetNextPageId(page_id);
+      previous->SetHighKey(low_key);
+      if constexpr (PREFIX_COMPRESSED) {
+        node->SetLowKey(low_key);
+      }
+    }
+  }
+  if (current.page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(current.page_->GetPageId(), true);
+  }
+  current.page_ = page;
+  current.target_ = target;
+  current.filled_ = 0;
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkAppendChild(std::vector<BulkLevel> *levels, size_t level, const KeyType &low_key,
+                                     page_id_t child) -> page_id_t {
+  auto &current = (*levels)[level];
+  if (current.page_ == nullptr || current.filled_ == current.target_) {
+    BulkStartPage(levels, level, low_key);
+  }
+  // The key of the first child is never compared against, the low key just fills the slot.
+  auto *node = reinterpret_cast<InternalPage *>(current.page_->GetData());
+  node->Append(low_key, child);
+  current.filled_++;
+  return current.page_->GetPageId();
+}
 
 /*****************************************************************************
  * REMOVE
@@ -119,53 +576,186 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  RemoveValues(key, nullptr);
+}
+
+/*
+ * Delete a single value of input key. The leaf entry only goes with the last
+ * value of the key; before that, the value is taken out of the posting list.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  RemoveValues(key, &value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveValues(const KeyType &key, const ValueType *value) {
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    RemoveBLink(key, value);
+    return;
+  }
+  // Most removes do not underflow their leaf, so try with a write latch on the leaf alone first.
+  auto *page = FindLeafOptimistic(key);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool dirty = false;
+  bool remove_entry = RemoveFromPostingList(leaf, key, value, &dirty);
+  bool safe = IsSafe(leaf, Operation::REMOVE);
+  if (remove_entry && safe) {
+    RemoveEntry(leaf, key);
+    dirty = true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+  if (!remove_entry || safe) {
+    return;
+  }
+
+  // The leaf may underflow: restart with pessimistic crabbing.
+  Context ctx;
+  root_latch_.WLock();
+  ctx.root_latched_ = true;
+  if (IsEmpty()) {
+    ReleaseContext(&ctx);
+    return;
+  }
+  FindLeaf(key, Operation::REMOVE, &ctx);
+  leaf = reinterpret_cast<LeafPage *>(ctx.write_set_.back()->GetData());
+  // The leaf may have changed since it was unlatched.
+  int size = leaf->GetSize();
+  if (RemoveFromPostingList(leaf, key, value, &dirty) && RemoveEntry(leaf, key) < size) {
+    CoalesceOrRedistribute(leaf, &ctx);
+  }
+  ReleaseContext(&ctx);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromPostingList(LeafPage *leaf, const KeyType &key, const ValueType *value, bool *dirty)
+    -> bool {
+  ValueType existing;
+  if (!leaf->Lookup(key, &existing, comparator_)) {
+    return false;
+  }
+  if (value == nullptr) {
+    return true;
+  }
+  if (!BPlusTreePostingPage::IsPostingList(existing)) {
+    return existing == *value;
+  }
+  ValueType remaining;
+  if (BPlusTreePostingPage::Remove(buffer_pool_manager_, existing, *value, &remaining)) {
+    leaf->SetValueAt(leaf->KeyIndex(key, comparator_), remaining);
+    *dirty = true;
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveEntry(LeafPage *leaf, const KeyType &key) -> int {
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_) && BPlusTreePostingPage::IsPostingList(existing)) {
+    BPlusTreePostingPage::Free(buffer_pool_manager_, existing);
+  }
+  return leaf->RemoveAndDeleteRecord(key, comparator_);
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * Pages that become empty are recorded in ctx and deleted once all latches are released.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -> bool {
-  return false;
+void BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Context *ctx) {
+  if (node->IsRootPage()) {
+    if (AdjustRoot(node)) {
+      ctx->deleted_pages_.push_back(node->GetPageId());
+    }
+    return;
+  }
+  if (!IsUnderflow(node)) {
+    return;
+  }
+  // The parent was not safe, so it is still write latched in ctx.
+  page_id_t parent_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchPage(parent_id)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  int sibling_index = index == 0 ? 1 : index - 1;
+  auto *sibling_page = FetchPage(parent->ValueAt(sibling_index));
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // Always merge the right page into the left one, so that the leaf chain stays intact.
+  if (index == 0 ? CanCoalesce(node, sibling, parent, 1) : CanCoalesce(sibling, node, parent, index)) {
+    if (index == 0) {
+      Coalesce(node, sibling, parent, 1, ctx);
+    } else {
+      Coalesce(sibling, node, parent, index, ctx);
+    }
+  } else if (CanRedistribute(sibling, node, parent, index)) {
+    Redistribute(sibling, node, parent, index);
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent_id, true);
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
+ * Move all the key & value pairs from the right page into the left page, and
+ * schedule the right page for deletion. Parent page is adjusted to take the
+ * deletion into account, recursively coalescing or redistributing it.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion
- * happend
+ * @param   left_node      the left one of two sibling pages
+ * @param   right_node     the right one, which is emptied
+ * @param   parent         parent page of both
+ * @param   right_index    index of right_node in parent
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-auto BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) -> bool {
-  return false;
+void BPLUSTREE_TYPE::Coalesce(N *left_node, N *right_node, InternalPage *parent, int right_index, Context *ctx) {
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    right_node->MoveAllTo(left_node);
+  } else {
+    right_node->MoveAllTo(left_node, parent->KeyAt(right_index), buffer_pool_manager_);
+  }
+  parent->Remove(right_index);
+  ctx->deleted_pages_.push_back(right_node->GetPageId());
+  CoalesceOrRedistribute(parent, ctx);
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
+ * "node". The separator key in the parent is updated accordingly.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   index              index of node in parent
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(1, LowKey(neighbor_node));
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(index, LowKey(node));
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -177,7 +767,26 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return false; }
+auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  auto child_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  auto *child = reinterpret_cast<BPlusTreePage *>(FetchPage(child_id)->GetData());
+  child->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(child_id, true);
+  root_page_id_ = child_id;
+  UpdateRootPageId(0);
+  return true;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -188,7 +797,10 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool { return f
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  auto *page = FindLeaf(KeyType{}, Operation::FIND, nullptr, true);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0, this);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -196,7 +808,83 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  auto *page = FindLeaf(key, Operation::FIND);
+  if (page == nullptr) {
+    return End();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, this);
+}
+
+/*
+ * Input parameters are the inclusive bounds of a range scan: the iterator
+ * starts at low key and becomes End() once it moves past high key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE {
+  auto iterator = Begin(low_key);
+  iterator.low_key_ = {true, low_key};
+  iterator.high_key_ = {true, high_key};
+  iterator.CheckBounds();
+  return iterator;
+}
+
+/*
+ * Input parameter is void, construct a reverse index iterator positioned at
+ * the largest key, which moves towards smaller keys
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE {
+  INDEXITERATOR_TYPE iterator(buffer_pool_manager_, nullptr, 0, this);
+  iterator.reverse_ = true;
+  iterator.SeekBefore(nullptr);
+  iterator.LoadPostings(true);
+  return iterator;
+}
+
+/*
+ * Input parameter is high key, construct a reverse index iterator positioned
+ * at the largest key that is not greater than high key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  INDEXITERATOR_TYPE iterator(buffer_pool_manager_, nullptr, 0, this);
+  iterator.reverse_ = true;
+  auto *page = FindLeaf(key, Operation::FIND);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(key, comparator_);
+    if (index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0) {
+      iterator.page_ = page;
+      iterator.leaf_ = leaf;
+      iterator.index_ = index;
+    } else {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      iterator.SeekBefore(&key);
+    }
+  }
+  iterator.LoadPostings(true);
+  return iterator;
+}
+
+/*
+ * Input parameters are the inclusive bounds of a reverse range scan: the
+ * iterator starts at high key and becomes End() once it moves past low key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE {
+  auto iterator = RBegin(high_key);
+  iterator.low_key_ = {true, low_key};
+  iterator.high_key_ = {true, high_key};
+  iterator.CheckBounds();
+  return iterator;
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -204,7 +892,9 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return IN
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, nullptr, 0, this);
+}
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -212,10 +902,641 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE();
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * The returned page is pinned but not latched; the caller must unpin it.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  auto *page = FindLeaf(key, Operation::FIND, nullptr, leftMost);
+  if (page != nullptr) {
+    page->RUnlatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeaf(const KeyType &key, Operation op, Context *ctx, bool left_most) -> Page * {
+  // The leftmost page of a level never moves, so crabbing down the left edge is also correct for B-link trees.
+  if (op == Operation::FIND && mode_ == BPlusTreeMode::B_LINK && !left_most) {
+    return FindLeafBLink(key, false);
+  }
+  if (op == Operation::FIND) {
+    if constexpr (!PREFIX_COMPRESSED) {
+      return FindLeafRead(key, left_most);
+    }
+    root_latch_.RLock();
+    if (IsEmpty()) {
+      root_latch_.RUnlock();
+      return nullptr;
+    }
+    auto *page = FetchPage(root_page_id_);
+    page->RLatch();
+    root_latch_.RUnlock();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    while (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      auto *child = FetchPage(left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_));
+      child->RLatch();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child;
+      node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    }
+    return page;
+  }
+
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    auto *page = FetchPage(page_id);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op)) {
+      // Nothing above this node can change anymore.
+      ReleaseContext(ctx);
+    }
+    ctx->write_set_.push_back(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+  }
+}
+
+/*
+ * Every page is pinned while it is read, so its frame cannot be reused under
+ * the descent. A child is only trusted once its parent still has the version
+ * it had when the child's page id was read from it, which also covers a child
+ * that was merged away and deleted before it could be pinned: the merge wrote
+ * to the parent. The leaf is read-latched and then checked the same way.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType &key, bool left_most) -> Page * {
+  while (true) {
+    root_latch_.RLock();
+    if (IsEmpty()) {
+      root_latch_.RUnlock();
+      return nullptr;
+    }
+    auto *page = FetchPage(root_page_id_);
+    uint64_t version = page->OptimisticRLatch();
+    root_latch_.RUnlock();
+    while (true) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        page->RLatch();
+        if (page->ValidateRead(version)) {
+          return page;
+        }
+        page->RUnlatch();
+        break;
+      }
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      page_id_t child_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+      if (!page->ValidateRead(version)) {
+        break;
+      }
+      auto *child = FetchPage(child_id);
+      uint64_t child_version = child->OptimisticRLatch();
+      bool valid = page->ValidateRead(version);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child;
+      version = child_version;
+      if (!valid) {
+        break;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key) -> Page * {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *parent = nullptr;
+  auto *page = FetchPage(root_page_id_);
+  page->RLatch();
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      // Structural changes to the leaf need a write latch on its parent (or the root latch), which we still block, so
+      // the leaf stays responsible for key while its read latch is traded for a write latch.
+      page->RUnlatch();
+      page->WLatch();
+      ReleaseParent(parent);
+      return page;
+    }
+    auto *child = FetchPage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+    child->RLatch();
+    ReleaseParent(parent);
+    parent = page;
+    page = child;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafAndParent(const KeyType &key, Page **parent) -> Page * {
+  *parent = nullptr;
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  auto *page = FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *child = FetchPage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+    child->RLatch();
+    if (*parent != nullptr) {
+      (*parent)->RUnlatch();
+      buffer_pool_manager_->UnpinPage((*parent)->GetPageId(), false);
+    }
+    *parent = page;
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MoveBatchCursor(const KeyType &key, Page **parent, Page **page) -> bool {
+  if (*page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>((*page)->GetData());
+    if (mode_ == BPlusTreeMode::B_LINK) {
+      if (leaf->CoversKey(key, comparator_)) {
+        return true;
+      }
+      // A leaf below key has a right sibling, which is where the next key usually is. Further right, a descent is
+      // cheaper than walking the leaves in between.
+      auto *next = FetchPage(leaf->GetNextPageId());
+      (*page)->RUnlatch();
+      next->RLatch();
+      buffer_pool_manager_->UnpinPage((*page)->GetPageId(), false);
+      *page = next;
+      if (reinterpret_cast<LeafPage *>(next->GetData())->CoversKey(key, comparator_)) {
+        return true;
+      }
+    } else {
+      // Every key up to the largest one of the leaf belongs to it, since earlier keys of the batch were routed here.
+      // A root leaf covers every key, and cannot stop being the root while we hold its latch.
+      if (*parent == nullptr ||
+          (leaf->GetSize() > 0 && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) <= 0)) {
+        return true;
+      }
+      // The parent cannot split or merge while we hold its latch, so its separators route key to the right sibling,
+      // unless key falls beyond the last one: then it may belong to the next parent.
+      auto *internal = reinterpret_cast<InternalPage *>((*parent)->GetData());
+      page_id_t child_page_id = internal->Lookup(key, comparator_);
+      bool last_child = internal->ValueIndex(child_page_id) == internal->GetSize() - 1;
+      if (child_page_id != (*page)->GetPageId()) {
+        (*page)->RUnlatch();
+        buffer_pool_manager_->UnpinPage((*page)->GetPageId(), false);
+        *page = FetchPage(child_page_id);
+        (*page)->RLatch();
+        leaf = reinterpret_cast<LeafPage *>((*page)->GetData());
+      }
+      if (!last_child || (leaf->GetSize() > 0 && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) <= 0)) {
+        return true;
+      }
+    }
+    (*page)->RUnlatch();
+    buffer_pool_manager_->UnpinPage((*page)->GetPageId(), false);
+    if (*parent != nullptr) {
+      (*parent)->RUnlatch();
+      buffer_pool_manager_->UnpinPage((*parent)->GetPageId(), false);
+      *parent = nullptr;
+    }
+  }
+  *page = mode_ == BPlusTreeMode::B_LINK ? FindLeafBLink(key, false) : FindLeafAndParent(key, parent);
+  return *page != nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafBefore(const KeyType *key, KeyType *low_fence, bool *has_low_fence) -> Page * {
+  *has_low_fence = false;
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  auto *page = FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  while (true) {
+    if (mode_ == BPlusTreeMode::B_LINK) {
+      page = MoveRightBefore(page, key, low_fence, has_low_fence);
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    // The rightmost child whose separator is below key; the first child has none and is below every key.
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    int index = internal->GetSize() - 1;
+    if (key != nullptr) {
+      index = 0;
+      int low = 1;
+      int high = internal->GetSize() - 1;
+      while (low <= high) {
+        int mid = (low + high) / 2;
+        if (comparator_(internal->KeyAt(mid), *key) < 0) {
+          index = mid;
+          low = mid + 1;
+        } else {
+          high = mid - 1;
+        }
+      }
+    }
+    if (index > 0) {
+      *low_fence = internal->KeyAt(index);
+      *has_low_fence = true;
+    }
+    auto *child = FetchPage(internal->ValueAt(index));
+    if (mode_ == BPlusTreeMode::B_LINK) {
+      // As in FindLeafBLink(), a B-link traversal holds one latch at a time and catches up with splits by moving right.
+      page->RUnlatch();
+      child->RLatch();
+    } else {
+      child->RLatch();
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MoveRightBefore(Page *page, const KeyType *key, KeyType *low_fence, bool *has_low_fence)
+    -> Page * {
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t next_page_id;
+    KeyType high_key;
+    if (node->IsLeafPage()) {
+      next_page_id = reinterpret_cast<LeafPage *>(node)->GetNextPageId();
+      high_key = reinterpret_cast<LeafPage *>(node)->GetHighKey();
+    } else {
+      next_page_id = reinterpret_cast<InternalPage *>(node)->GetNextPageId();
+      high_key = reinterpret_cast<InternalPage *>(node)->GetHighKey();
+    }
+    if (next_page_id == INVALID_PAGE_ID || (key != nullptr && comparator_(high_key, *key) >= 0)) {
+      return page;
+    }
+    *low_fence = high_key;
+    *has_low_fence = true;
+    auto *next = FetchPage(next_page_id);
+    page->RUnlatch();
+    next->RLatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseParent(Page *parent) {
+  if (parent == nullptr) {
+    root_latch_.RUnlock();
+    return;
+  }
+  parent->RUnlatch();
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafBLink(const KeyType &key, bool exclusive, std::vector<page_id_t> *path) -> Page * {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  // A stale root is harmless: pages are never deleted, and moving right from a former root still finds the key.
+  page_id_t root_page_id = root_page_id_;
+  root_latch_.RUnlock();
+
+  auto *page = FetchPage(root_page_id);
+  if constexpr (PREFIX_COMPRESSED) {
+    page->RLatch();
+    while (true) {
+      page = MoveRight(page, key, false);
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        break;
+      }
+      if (path != nullptr) {
+        path->push_back(page->GetPageId());
+      }
+      // The child may split before we latch it; the split moves keys right, where MoveRight() finds them.
+      auto *child = FetchPage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      child->RLatch();
+      page = child;
+    }
+  } else {
+    // Pages are never deleted or change type, so a read that was overtaken by a writer simply reads the same page
+    // again, and the leaf only has to be latched and moved right from.
+    uint64_t version = page->OptimisticRLatch();
+    while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+      bool covers = internal->CoversKey(key, comparator_);
+      page_id_t next_page_id = covers ? internal->Lookup(key, comparator_) : internal->GetNextPageId();
+      if (!page->ValidateRead(version)) {
+        version = page->OptimisticRLatch();
+        continue;
+      }
+      if (covers && path != nullptr) {
+        path->push_back(page->GetPageId());
+      }
+      auto *next = FetchPage(next_page_id);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = next;
+      version = page->OptimisticRLatch();
+    }
+    page->RLatch();
+    page = MoveRight(page, key, false);
+  }
+  if (exclusive) {
+    page->RUnlatch();
+    page->WLatch();
+    page = MoveRight(page, key, true);
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MoveRight(Page *page, const KeyType &key, bool exclusive) -> Page * {
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t next_page_id;
+    if (node->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<LeafPage *>(node);
+      next_page_id = leaf->CoversKey(key, comparator_) ? INVALID_PAGE_ID : leaf->GetNextPageId();
+    } else {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      next_page_id = internal->CoversKey(key, comparator_) ? INVALID_PAGE_ID : internal->GetNextPageId();
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      return page;
+    }
+    auto *next = FetchPage(next_page_id);
+    if (exclusive) {
+      page->WUnlatch();
+      next->WLatch();
+    } else {
+      page->RUnlatch();
+      next->RLatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value) -> bool {
+  std::vector<page_id_t> path;
+  auto *page = FindLeafBLink(key, true, &path);
+  if (page == nullptr) {
+    root_latch_.WLock();
+    bool empty = IsEmpty();
+    if (empty) {
+      StartNewTree(key, value);
+    }
+    root_latch_.WUnlock();
+    return empty || InsertBLink(key, value);
+  }
+
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    bool inserted = !unique_keys_ && InsertDuplicate(leaf, key, existing, value);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+    return inserted;
+  }
+  leaf->Insert(key, value, comparator_);
+  if (!IsOverflow(leaf)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+
+  // The new sibling is unreachable until the right link is set, and complete before the latch is released. Compressed
+  // pages already split their key range in MoveHalfTo(), so the high key is read before the split.
+  KeyType high_key = leaf->GetHighKey();
+  auto *new_leaf = Split(leaf);
+  KeyType separator = LowKey(new_leaf);
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  new_leaf->SetHighKey(high_key);
+  leaf->SetNextPageId(new_leaf->GetPageId());
+  leaf->SetHighKey(separator);
+  page_id_t old_page_id = leaf->GetPageId();
+  page_id_t new_page_id = new_leaf->GetPageId();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(old_page_id, true);
+
+  InsertIntoParentBLink(old_page_id, separator, new_page_id, 0, &path);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(page_id_t old_page_id, KeyType key, page_id_t new_page_id, int height,
+                                           std::vector<page_id_t> *path) {
+  while (true) {
+    if (path->empty()) {
+      root_latch_.WLock();
+      if (root_page_id_ == old_page_id) {
+        page_id_t root_id;
+        auto *root = reinterpret_cast<InternalPage *>(NewPage(&root_id)->GetData());
+        root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
+        root->PopulateNewRoot(old_page_id, key, new_page_id);
+        root_page_id_ = root_id;
+        UpdateRootPageId(0);
+        buffer_pool_manager_->UnpinPage(root_id, true);
+        root_latch_.WUnlock();
+        return;
+      }
+      root_latch_.WUnlock();
+      // Another split of the old root got there first: descend again to find the ancestors of the split level.
+      auto *leaf = FindLeafBLink(key, false, path);
+      leaf->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+      path->resize(path->size() - height);
+    }
+
+    auto *page = FetchPage(path->back());
+    path->pop_back();
+    page->WLatch();
+    page = MoveRight(page, key, true);
+    auto *parent = reinterpret_cast<InternalPage *>(page->GetData());
+    parent->InsertNode(key, new_page_id, comparator_);
+    if (!IsOverflow(parent)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return;
+    }
+
+    KeyType high_key = parent->GetHighKey();
+    auto *sibling = Split(parent);
+    key = LowKey(sibling);
+    sibling->SetNextPageId(parent->GetNextPageId());
+    sibling->SetHighKey(high_key);
+    parent->SetNextPageId(sibling->GetPageId());
+    parent->SetHighKey(key);
+    old_page_id = parent->GetPageId();
+    new_page_id = sibling->GetPageId();
+    height++;
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(old_page_id, true);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBLink(const KeyType &key, const ValueType *value) {
+  auto *page = FindLeafBLink(key, true);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool dirty = false;
+  if (RemoveFromPostingList(leaf, key, value, &dirty)) {
+    RemoveEntry(leaf, key);
+    dirty = true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const -> bool {
+  // Compressed pages also fill up by bytes: an insert below must leave room for one more entry, and a page that holds
+  // half a page of keys without one of them does not underflow.
+  bool bytes_safe = false;
+  if constexpr (PREFIX_COMPRESSED) {
+    auto check = [op](const auto *page) {
+      return op == Operation::INSERT ? page->HasRoomFor(2) : page->StaysHalfFull(1);
+    };
+    bytes_safe = node->IsLeafPage() ? check(reinterpret_cast<LeafPage *>(node))
+                                    : check(reinterpret_cast<InternalPage *>(node));
+  }
+  if (op == Operation::INSERT) {
+    bool count_safe =
+        node->IsLeafPage() ? node->GetSize() + 1 < leaf_max_size_ : node->GetSize() < internal_max_size_;
+    return count_safe && (!PREFIX_COMPRESSED || bytes_safe);
+  }
+  if (node->IsRootPage()) {
+    return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+  }
+  return node->GetSize() > node->GetMinSize() || bytes_safe;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::IsOverflow(N *node) const -> bool {
+  bool overflow = node->IsLeafPage() ? node->GetSize() >= leaf_max_size_ : node->GetSize() > internal_max_size_;
+  if constexpr (PREFIX_COMPRESSED) {
+    overflow = overflow || !node->HasRoomFor(1);
+  }
+  return overflow;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::IsUnderflow(N *node) const -> bool {
+  bool underflow = node->GetSize() < node->GetMinSize();
+  if constexpr (PREFIX_COMPRESSED) {
+    underflow = underflow && !node->StaysHalfFull(0);
+  }
+  return underflow;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::CanCoalesce(N *left_node, N *right_node, InternalPage *parent, int right_index) const -> bool {
+  // A merged leaf must stay below the split threshold, a merged internal page may reach it.
+  int merged_size = left_node->GetSize() + right_node->GetSize();
+  bool fits = left_node->IsLeafPage() ? merged_size < leaf_max_size_ : merged_size <= internal_max_size_;
+  if constexpr (PREFIX_COMPRESSED && std::is_same_v<N, LeafPage>) {
+    fits = fits && left_node->CanMergeFrom(right_node);
+  } else if constexpr (PREFIX_COMPRESSED) {
+    fits = fits && left_node->CanMergeFrom(right_node, parent->KeyAt(right_index));
+  }
+  return fits;
+}
+
+/*
+ * Plain pages can always redistribute when they cannot merge. A compressed page
+ * may not fit the entry it takes, and the new separator may not fit in the
+ * parent, in which case the page is left underfull.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::CanRedistribute(N *neighbor_node, N *node, InternalPage *parent, int index) const -> bool {
+  if constexpr (PREFIX_COMPRESSED && std::is_same_v<N, LeafPage>) {
+    return parent->HasRoomFor(2) &&
+           (index == 0 ? node->CanTakeFirstOf(neighbor_node) : node->CanTakeLastOf(neighbor_node));
+  } else if constexpr (PREFIX_COMPRESSED) {
+    return parent->HasRoomFor(2) && (index == 0 ? node->CanTakeFirstOf(neighbor_node, parent->KeyAt(1))
+                                                : node->CanTakeLastOf(neighbor_node, parent->KeyAt(index)));
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::LowKey(N *node) -> KeyType {
+  if constexpr (PREFIX_COMPRESSED) {
+    return node->GetLowKey();
+  } else {
+    return node->KeyAt(0);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseContext(Context *ctx) {
+  for (auto *page : ctx->write_set_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  ctx->write_set_.clear();
+  if (ctx->root_latched_) {
+    root_latch_.WUnlock();
+    ctx->root_latched_ = false;
+  }
+  // Emptied pages are unreachable by now, but a concurrent reader may still pin one until it moves on.
+  if (ctx->deleted_pages_.empty() && !has_pending_deletes_.load()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(pending_deletes_latch_);
+  pending_deletes_.insert(pending_deletes_.end(), ctx->deleted_pages_.begin(), ctx->deleted_pages_.end());
+  ctx->deleted_pages_.clear();
+  auto still_pinned = std::remove_if(pending_deletes_.begin(), pending_deletes_.end(),
+                                     [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  pending_deletes_.erase(still_pinned, pending_deletes_.end());
+  has_pending_deletes_.store(!pending_deletes_.empty());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchPage(page_id_t page_id) -> Page * {
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page from the buffer pool");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewPage(page_id_t *page_id) -> Page * {
+  auto *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+  }
+  return page;
 }
 
 /*
@@ -230,8 +1551,10 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
   if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
+    // create a new record<index_name + root_page_id> in header_page, unless the tree existed before and was emptied
+    if (!header_page->InsertRecord(index_name_, root_page_id_)) {
+      header_page->UpdateRecord(index_name_, root_page_id_);
+    }
   } else {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
@@ -431,5 +1754,7 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTree<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
@@ -11,49 +11,404 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <cstring>
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     LockManager *lock_manager)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      // An index maps a key to the RIDs of every tuple with that key, so keys may repeat. Point lookups of absent
+      // keys, such as uniqueness checks, are answered by a Bloom filter.
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, decltype(container_)::LEAF_PAGE_CAPACITY,
+                 decltype(container_)::INTERNAL_PAGE_CAPACITY, BPlusTreeMode::LOCK_COUPLING, false, true),
+      buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetEntrySchema());
+  InsertKey(index_key, rid, transaction);
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertKey(const KeyType &index_key, RID rid, Transaction *transaction) {
+  if (UseKeyRangeLocks(transaction)) {
+    // Locking the successor conflicts with any scan that covers the gap the key is inserted into.
+    LockKeyRange(transaction, &index_key, true);
+    LockNextKeyExclusive(transaction, index_key);
+  }
   container_.Insert(index_key, rid, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::function<bool(Tuple *key, RID *rid)> &next_entry,
+                                         Transaction *transaction) {
+  // An index that is still empty has no readers whose ranges need locking.
+  if (!container_.IsEmpty()) {
+    Index::InsertEntries(next_entry, transaction);
+    return;
+  }
+  ExternalSort<KeyType, ValueType, KeyComparator> sort(buffer_pool_manager_, comparator_);
+  Tuple key;
+  RID rid;
+  KeyType index_key;
+  while (next_entry(&key, &rid)) {
+    index_key.SetFromKey(key, *GetEntrySchema());
+    sort.Add(index_key, rid);
+  }
+  sort.Finish();
+  if (container_.BulkLoad(&sort)) {
+    return;
+  }
+  // Someone inserted in the meantime; the entries are gone from the producer, so they come from the sort.
+  typename ExternalSort<KeyType, ValueType, KeyComparator>::Merger merge(sort);
+  std::pair<KeyType, ValueType> entry;
+  while (merge.Next(&entry)) {
+    InsertKey(entry.first, entry.second, transaction);
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetEntrySchema());
 
-  container_.Remove(index_key, transaction);
+  if (UseKeyRangeLocks(transaction)) {
+    // Removing the key merges its gap into the successor's, so the successor is locked as well.
+    LockKeyRange(transaction, &index_key, true);
+    LockNextKeyExclusive(transaction, index_key);
+  }
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (UseKeyRangeLocks(transaction) || !GetIncludeAttrs().empty()) {
+    // A point lookup is a range scan of one key; an absent key needs its gap locked just the same. The entries of a
+    // covering index are distinct tree keys that share the key as their prefix.
+    ScanRange(key, key, result, transaction);
+    return;
+  }
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  if (UseKeyRangeLocks(transaction) || !GetIncludeAttrs().empty()) {
+    // Every key needs its own range locked, which ScanKey() does without page latches held, or its own range scanned.
+    Index::ScanKeys(keys, results, transaction);
+    return;
+  }
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i], *GetKeySchema());
+  }
+  container_.GetValues(index_keys, results, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple &low_key, const Tuple &high_key, std::vector<RID> *result,
+                                     Transaction *transaction) {
+  KeyType low;
+  KeyType high;
+  low.SetFromKey(low_key, *GetKeySchema());
+  // Takes in every entry whose key is high_key, whatever the included columns that follow it.
+  high.SetUpperBoundFromKey(high_key, *GetKeySchema());
+
+  std::vector<std::pair<KeyType, RID>> entries;
+  ScanEntryRange(low, high, &entries, transaction);
+  for (auto &entry : entries) {
+    result->push_back(entry.second);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+  KeyType low;
+  KeyType high;
+  memset(low.data_, 0, sizeof(low.data_));
+  memset(high.data_, 0xff, sizeof(high.data_));
+
+  std::vector<std::pair<KeyType, RID>> index_entries;
+  ScanEntryRange(low, high, &index_entries, transaction);
+  DecodeEntries(index_entries, entries);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanEntries(const Tuple &key, std::vector<std::pair<Tuple, RID>> *entries,
+                                       Transaction *transaction) {
+  ScanEntries(key, key, entries, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanEntries(const Tuple &low_key, const Tuple &high_key,
+                                       std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+  KeyType low;
+  KeyType high;
+  low.SetFromKey(low_key, *GetKeySchema());
+  high.SetUpperBoundFromKey(high_key, *GetKeySchema());
+
+  std::vector<std::pair<KeyType, RID>> index_entries;
+  ScanEntryRange(low, high, &index_entries, transaction);
+  DecodeEntries(index_entries, entries);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetEntryCursor(Transaction *transaction) -> std::unique_ptr<IndexCursor> {
+  return std::make_unique<EntryCursor>(this, std::nullopt, std::nullopt, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetEntryCursor(const Tuple &key, Transaction *transaction)
+    -> std::unique_ptr<IndexCursor> {
+  return GetEntryCursor(key, key, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetEntryCursor(const Tuple &low_key, const Tuple &high_key, Transaction *transaction)
+    -> std::unique_ptr<IndexCursor> {
+  KeyType low;
+  KeyType high;
+  low.SetFromKey(low_key, *GetKeySchema());
+  high.SetUpperBoundFromKey(high_key, *GetKeySchema());
+  return std::make_unique<EntryCursor>(this, low, high, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_INDEX_TYPE::EntryCursor::EntryCursor(BPlusTreeIndex *index, std::optional<KeyType> low,
+                                               std::optional<KeyType> high, Transaction *transaction)
+    : index_(index),
+      low_(std::move(low)),
+      high_(std::move(high)),
+      transaction_(transaction),
+      lock_ranges_(index->UseKeyRangeLocks(transaction)) {
+  if (lock_ranges_) {
+    // The first key above the range has to be seen, to lock the gap below it.
+    Seek();
+  } else if (low_.has_value()) {
+    iterator_.emplace(index_->container_.Begin(*low_, *high_));
+  } else {
+    iterator_.emplace(index_->container_.Begin());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::EntryCursor::Seek() {
+  if (last_key_.has_value()) {
+    iterator_.emplace(index_->container_.Begin(*last_key_));
+    // Our lock on the last key keeps its entries from coming or going.
+    for (size_t i = 0; i < last_key_count_ && !iterator_->IsEnd(); i++) {
+      ++*iterator_;
+    }
+  } else if (low_.has_value()) {
+    iterator_.emplace(index_->container_.Begin(*low_));
+  } else {
+    iterator_.emplace(index_->container_.Begin());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::EntryCursor::Next(Tuple *entry, RID *rid) -> bool {
+  if (!iterator_.has_value()) {
+    return false;
+  }
+  if (lock_ranges_) {
+    while (true) {
+      bool has_key = !iterator_->IsEnd();
+      KeyType key;
+      if (has_key) {
+        key = (**iterator_).first;
+      }
+      if (index_->HoldsKeyRange(transaction_, has_key ? &key : nullptr)) {
+        break;
+      }
+      iterator_.reset();
+      index_->LockKeyRange(transaction_, has_key ? &key : nullptr, false);
+      Seek();
+      // The range is settled once the entry we locked is still the next one.
+      if (iterator_->IsEnd() ? !has_key : has_key && index_->comparator_((**iterator_).first, key) == 0) {
+        break;
+      }
+    }
+    if (!iterator_->IsEnd() && high_.has_value() && index_->comparator_((**iterator_).first, *high_) > 0) {
+      iterator_.reset();
+      return false;
+    }
+  }
+  if (iterator_->IsEnd()) {
+    iterator_.reset();
+    return false;
+  }
+  const auto &[index_key, value] = **iterator_;
+  if (last_key_.has_value() && index_->comparator_(index_key, *last_key_) == 0) {
+    last_key_count_++;
+  } else {
+    last_key_ = index_key;
+    last_key_count_ = 1;
+  }
+  *entry = index_->DecodeEntry(index_key);
+  *rid = value;
+  ++*iterator_;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::DecodeEntry(const KeyType &index_key) -> Tuple {
+  auto *entry_schema = GetEntrySchema();
+  std::vector<Value> values(entry_schema->GetColumnCount());
+  for (uint32_t i = 0; i < values.size(); i++) {
+    values[i] = index_key.ToValue(entry_schema, i);
+  }
+  return Tuple(values, entry_schema);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::DecodeEntries(const std::vector<std::pair<KeyType, RID>> &index_entries,
+                                         std::vector<std::pair<Tuple, RID>> *entries) {
+  for (const auto &[index_key, rid] : index_entries) {
+    entries->emplace_back(DecodeEntry(index_key), rid);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanEntryRange(const KeyType &low, const KeyType &high,
+                                          std::vector<std::pair<KeyType, RID>> *entries, Transaction *transaction) {
+  KeyType next_key;
+  bool has_next = CollectRange(low, high, entries, &next_key);
+  if (!UseKeyRangeLocks(transaction)) {
+    return;
+  }
+  // Locks are taken without page latches held, so the range may change before they are granted. Once every key of a
+  // scan is locked nothing can change anymore, so the loop ends as soon as a rescan sees the same keys.
+  while (true) {
+    for (auto &entry : *entries) {
+      LockKeyRange(transaction, &entry.first, false);
+    }
+    LockKeyRange(transaction, has_next ? &next_key : nullptr, false);
+
+    std::vector<std::pair<KeyType, RID>> rescan;
+    KeyType rescan_next;
+    bool rescan_has_next = CollectRange(low, high, &rescan, &rescan_next);
+    bool stable = rescan.size() == entries->size() && rescan_has_next == has_next &&
+                  (!has_next || comparator_(rescan_next, next_key) == 0);
+    for (size_t i = 0; stable && i < entries->size(); i++) {
+      stable = comparator_(rescan[i].first, (*entries)[i].first) == 0;
+    }
+    *entries = std::move(rescan);
+    next_key = rescan_next;
+    has_next = rescan_has_next;
+    if (stable) {
+      return;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::UseKeyRangeLocks(Transaction *transaction) const -> bool {
+  // Rollback re-applies index writes under locks the aborted transaction already holds.
+  return lock_manager_ != nullptr && transaction != nullptr &&
+         transaction->GetConcurrencyMode() == ConcurrencyMode::TWO_PHASE_LOCKING &&
+         transaction->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ &&
+         transaction->GetState() != TransactionState::ABORTED;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::KeyRangeResource(const KeyType *key) -> RID {
+  return key == nullptr ? LockManager::KeyRangeSupremum(GetName())
+                        : LockManager::KeyRangeResource(GetName(), key->data_, sizeof(key->data_));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::HoldsKeyRange(Transaction *transaction, const KeyType *key) -> bool {
+  RID resource = KeyRangeResource(key);
+  return transaction->IsSharedLocked(resource) || transaction->IsExclusiveLocked(resource);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::LockKeyRange(Transaction *transaction, const KeyType *key, bool exclusive) {
+  RID resource = KeyRangeResource(key);
+  bool granted;
+  if (!exclusive) {
+    granted = lock_manager_->LockShared(transaction, resource);
+  } else if (transaction->IsSharedLocked(resource)) {
+    granted = lock_manager_->LockUpgrade(transaction, resource);
+  } else {
+    granted = lock_manager_->LockExclusive(transaction, resource);
+  }
+  if (!granted) {
+    throw TransactionAbortException(transaction->GetTransactionId(), AbortReason::DEADLOCK);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::LockNextKeyExclusive(Transaction *transaction, const KeyType &key) {
+  KeyType next_key;
+  bool has_next = container_.GetNextKey(key, &next_key);
+  while (true) {
+    LockKeyRange(transaction, has_next ? &next_key : nullptr, true);
+    // A key inserted into the gap before our lock was granted becomes the new successor.
+    KeyType current;
+    bool has_current = container_.GetNextKey(key, &current);
+    if (has_current == has_next && (!has_next || comparator_(current, next_key) == 0)) {
+      return;
+    }
+    next_key = current;
+    has_next = has_current;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::CollectRange(const KeyType &low_key, const KeyType &high_key,
+                                        std::vector<std::pair<KeyType, RID>> *entries, KeyType *next_key) -> bool {
+  entries->clear();
+  for (auto iterator = container_.Begin(low_key); !iterator.IsEnd(); ++iterator) {
+    const auto &entry = *iterator;
+    if (comparator_(entry.first, high_key) > 0) {
+      *next_key = entry.first;
+      return true;
+    }
+    entries->emplace_back(entry.first, entry.second);
+  }
+  return false;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE { return container_.Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE {
+  return container_.Begin(low_key, high_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRBeginIterator() -> INDEXITERATOR_TYPE { return container_.RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE {
+  return container_.RBegin(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRBeginIterator(const KeyType &low_key, const KeyType &high_key) -> INDEXITERATOR_TYPE {
+  return container_.RBegin(low_key, high_key);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_.End(); }
 
@@ -62,5 +417,7 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeIndex<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/storage/index/external_sort.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sort.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORT_TYPE ExternalSort<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                 size_t run_size, size_t fan_in)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      run_size_(std::max<size_t>(run_size, 1)),
+      fan_in_(std::max<size_t>(fan_in, 2)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::~ExternalSort() {
+  for (page_id_t page_id : runs_) {
+    while (page_id != INVALID_PAGE_ID) {
+      auto *page = FetchRunPage(page_id);
+      page_id_t next_page_id = reinterpret_cast<RunPage *>(page->GetData())->next_page_id_;
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      buffer_pool_manager_->DeletePage(page->GetPageId());
+      page_id = next_page_id;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Add(const KeyType &key, const ValueType &value) {
+  buffer_.emplace_back(key, value);
+  size_++;
+  if (buffer_.size() < run_size_) {
+    return;
+  }
+  std::sort(buffer_.begin(), buffer_.end(),
+            [this](const Entry &a, const Entry &b) { return comparator_(a.first, b.first) < 0; });
+  size_t next = 0;
+  SpillRun([this, &next](Entry *entry) {
+    if (next == buffer_.size()) {
+      return false;
+    }
+    *entry = buffer_[next++];
+    return true;
+  });
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Finish() {
+  std::sort(buffer_.begin(), buffer_.end(),
+            [this](const Entry &a, const Entry &b) { return comparator_(a.first, b.first) < 0; });
+  // Every pass merges the oldest runs into one at the back, so runs are merged about as often as each other.
+  while (runs_.size() + (buffer_.empty() ? 0 : 1) > fan_in_) {
+    size_t runs = std::min(fan_in_, runs_.size());
+    {
+      Merger merge(*this, runs, true);
+      SpillRun([&merge](Entry *entry) { return merge.Next(entry); });
+    }
+    runs_.erase(runs_.begin(), runs_.begin() + runs);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::SpillRun(const std::function<bool(Entry *)> &next) {
+  page_id_t head_page_id = INVALID_PAGE_ID;
+  Page *page = nullptr;
+  RunPage *run_page = nullptr;
+  Entry entry;
+  while (next(&entry)) {
+    if (page == nullptr || run_page->size_ == static_cast<int32_t>(RUN_PAGE_CAPACITY)) {
+      page_id_t page_id;
+      auto *new_page = buffer_pool_manager_->NewPage(&page_id);
+      if (new_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+      }
+      auto *new_run_page = reinterpret_cast<RunPage *>(new_page->GetData());
+      new_run_page->next_page_id_ = INVALID_PAGE_ID;
+      new_run_page->size_ = 0;
+      if (page == nullptr) {
+        head_page_id = page_id;
+      } else {
+        run_page->next_page_id_ = page_id;
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      }
+      page = new_page;
+      run_page = new_run_page;
+    }
+    run_page->entries_[run_page->size_++] = entry;
+  }
+  if (page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    runs_.push_back(head_page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::FetchRunPage(page_id_t page_id) const -> Page * {
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page from the buffer pool");
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::Merger::Merger(const ExternalSort &sort, size_t runs, bool consume)
+    : sort_(sort), consume_(consume) {
+  readers_.resize(runs + (consume ? 0 : 1));
+  for (size_t i = 0; i < runs; i++) {
+    Load(&readers_[i], sort.runs_[i]);
+  }
+  if (!consume) {
+    readers_.back().entries_ = sort.buffer_.data();
+    readers_.back().size_ = static_cast<int64_t>(sort.buffer_.size());
+  }
+  for (size_t i = 0; i < readers_.size(); i++) {
+    if (readers_[i].size_ > 0) {
+      heap_.push_back(i);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), Greater());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::Merger::~Merger() {
+  for (auto &reader : readers_) {
+    if (reader.page_ != nullptr) {
+      sort_.buffer_pool_manager_->UnpinPage(reader.page_->GetPageId(), false);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Merger::Load(RunReader *reader, page_id_t page_id) {
+  reader->page_ = sort_.FetchRunPage(page_id);
+  auto *run_page = reinterpret_cast<RunPage *>(reader->page_->GetData());
+  reader->entries_ = run_page->entries_;
+  reader->size_ = run_page->size_;
+  reader->index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::Merger::Advance(RunReader *reader) -> bool {
+  if (++reader->index_ < reader->size_) {
+    return true;
+  }
+  if (reader->page_ == nullptr) {
+    return false;
+  }
+  page_id_t page_id = reader->page_->GetPageId();
+  page_id_t next_page_id = reinterpret_cast<RunPage *>(reader->page_->GetData())->next_page_id_;
+  sort_.buffer_pool_manager_->UnpinPage(page_id, false);
+  reader->page_ = nullptr;
+  if (consume_) {
+    sort_.buffer_pool_manager_->DeletePage(page_id);
+  }
+  if (next_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  Load(reader, next_page_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::Merger::Greater() const {
+  // Ties go to the older run, which keeps the merge stable.
+  return [this](size_t a, size_t b) {
+    const auto &reader_a = readers_[a];
+    const auto &reader_b = readers_[b];
+    int result = sort_.comparator_(reader_a.entries_[reader_a.index_].first, reader_b.entries_[reader_b.index_].first);
+    return result > 0 || (result == 0 && a > b);
+  };
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORT_TYPE::Merger::Next(Entry *entry) -> bool {
+  if (heap_.empty()) {
+    return false;
+  }
+  std::pop_heap(heap_.begin(), heap_.end(), Greater());
+  auto &reader = readers_[heap_.back()];
+  *entry = reader.entries_[reader.index_];
+  if (Advance(&reader)) {
+    std::push_heap(heap_.begin(), heap_.end(), Greater());
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+template class ExternalSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSort<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExternalSort<GenericKey<128>, RID, GenericComparator<128>>;
+template class ExternalSort<GenericKey<256>, RID, GenericComparator<256>>;
+
+}  // namespace bustub
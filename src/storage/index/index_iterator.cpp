@@ -1,30 +1,341 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <utility>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
 /*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
+ * The iterator holds a pin and a read latch on the leaf page it points into.
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                                  BPlusTree<KeyType, ValueType, KeyComparator> *tree)
+    : buffer_pool_manager_(buffer_pool_manager), tree_(tree), page_(page), index_(index) {
+  if (page_ != nullptr) {
+    leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+    SkipExhaustedLeaves();
+    LoadPostings();
+    CheckBounds();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      tree_(other.tree_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      index_(other.index_),
+      postings_(std::move(other.postings_)),
+      posting_index_(other.posting_index_),
+      reverse_(other.reverse_),
+      low_key_(other.low_key_),
+      high_key_(other.high_key_),
+      leaves_visited_(other.leaves_visited_),
+      prefetched_(std::move(other.prefetched_)),
+      prefetch_next_page_id_(other.prefetch_next_page_id_),
+      prefetch_task_(std::move(other.prefetch_task_)) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+  other.index_ = 0;
+  other.postings_.clear();
+  other.posting_index_ = 0;
+  other.prefetched_.clear();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::~IndexIterator() {  // NOLINT
+  Release();
+  DropPrefetched();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_ == nullptr; }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  item_ = leaf_->GetItem(index_);
+  if (!postings_.empty()) {
+    item_.second = postings_[posting_index_];
+  }
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (reverse_) {
+    StepBackward();
+  } else {
+    StepForward();
+  }
+  CheckBounds();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator--() -> INDEXITERATOR_TYPE & {
+  if (reverse_) {
+    StepForward();
+  } else {
+    StepBackward();
+  }
+  CheckBounds();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::SameBound(const Bound &a, const Bound &b) const -> bool {
+  return a.first == b.first && (!a.first || tree_->comparator_(a.second, b.second) == 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::StepForward() {
+  if (posting_index_ + 1 < postings_.size()) {
+    posting_index_++;
+    return;
+  }
+  index_++;
+  SkipExhaustedLeaves();
+  LoadPostings();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::StepBackward() {
+  if (page_ == nullptr) {
+    return;
+  }
+  if (posting_index_ > 0) {
+    posting_index_--;
+    return;
+  }
+  if (index_ > 0) {
+    index_--;
+  } else {
+    KeyType first_key = leaf_->KeyAt(0);
+    SeekBefore(&first_key);
+  }
+  LoadPostings(true);
+}
+
+/*
+ * The next leaf is latched while the current one is still held, so no entry can
+ * move between the two unseen. A writer that merges or redistributes two leaves
+ * may latch the right one first though, so the scan only tries the latch; if
+ * that fails, it lets go, waits for the writer and descends again to the first
+ * key after the last one of the current leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    Page *next = nullptr;
+    if (next_page_id != INVALID_PAGE_ID) {
+      next = TakePrefetched(next_page_id);
+      if (next == nullptr) {
+        next = buffer_pool_manager_->FetchPage(next_page_id);
+      }
+    }
+    if (next == nullptr) {
+      Release();
+      return;
+    }
+    if (next->TryRLatch()) {
+      Release();
+      MoveTo(next);
+      continue;
+    }
+    if (tree_ == nullptr || index_ == 0) {
+      // No key to descend to: an empty leaf, which only the root or a B-link tree has, and neither merges leaves.
+      Release();
+      next->RLatch();
+      MoveTo(next);
+      continue;
+    }
+    KeyType last_key = leaf_->KeyAt(index_ - 1);
+    Release();
+    next->RLatch();
+    next->RUnlatch();
+    buffer_pool_manager_->UnpinPage(next_page_id, false);
+    page_ = tree_->FindLeaf(last_key, BPlusTree<KeyType, ValueType, KeyComparator>::Operation::FIND);
+    if (page_ != nullptr) {
+      leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+      index_ = leaf_->KeyIndex(last_key, tree_->comparator_);
+      if (index_ < leaf_->GetSize() && tree_->comparator_(leaf_->KeyAt(index_), last_key) == 0) {
+        index_++;
+      }
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MoveTo(Page *page) {
+  page_ = page;
+  leaf_ = reinterpret_cast<LeafPage *>(page->GetData());
+  index_ = 0;
+  leaves_visited_++;
+  PrefetchLeaves();
+}
+
+/*
+ * A leaf whose keys are all at or above key may still have a predecessor, e.g.
+ * an emptied leaf of a B-link tree, so the search goes on below its low fence.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SeekBefore(const KeyType *key) {
+  Release();
+  KeyType search_key;
+  if (key != nullptr) {
+    search_key = *key;
+  }
+  while (true) {
+    KeyType low_fence;
+    bool has_low_fence;
+    page_ = tree_->FindLeafBefore(key == nullptr ? nullptr : &search_key, &low_fence, &has_low_fence);
+    if (page_ == nullptr) {
+      return;
+    }
+    leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+    index_ = (key == nullptr ? leaf_->GetSize() : leaf_->KeyIndex(search_key, tree_->comparator_)) - 1;
+    if (index_ >= 0) {
+      return;
+    }
+    Release();
+    if (!has_low_fence) {
+      return;
+    }
+    key = &search_key;
+    search_key = low_fence;
+  }
+}
+
+/*
+ * An iterator that has become End() also gives back the leaves it prefetched,
+ * rather than holding on to their pins until it is destroyed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckBounds() {
+  if (page_ != nullptr && (low_key_.first || high_key_.first)) {
+    KeyType key = leaf_->KeyAt(index_);
+    if ((low_key_.first && tree_->comparator_(key, low_key_.second) < 0) ||
+        (high_key_.first && tree_->comparator_(key, high_key_.second) > 0)) {
+      Release();
+    }
+  }
+  if (page_ == nullptr) {
+    DropPrefetched();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadPostings(bool from_back) {
+  postings_.clear();
+  posting_index_ = 0;
+  if (page_ != nullptr) {
+    ValueType value = leaf_->GetItem(index_).second;
+    if (BPlusTreePostingPage::IsPostingList(value)) {
+      BPlusTreePostingPage::Collect(buffer_pool_manager_, value, &postings_);
+      posting_index_ = from_back ? postings_.size() - 1 : 0;
+    }
+  }
+}
+
+/*
+ * Called with the current leaf latched, so it never waits for the background
+ * task: a leaf the task still has to fetch is fetched by the scan itself.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrefetchLeaves() {
+  // A small pool cannot spare the pins; most iterators also stop within a leaf or two.
+  size_t depth = std::min(PREFETCH_LEAVES, buffer_pool_manager_->GetPoolSize() / 16);
+  if (depth == 0 || leaves_visited_ < 2 || tree_ == nullptr) {
+    return;
+  }
+  if (prefetch_task_.valid()) {
+    if (prefetch_task_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return;
+    }
+    auto [pages, next_page_id] = prefetch_task_.get();
+    prefetched_.insert(prefetched_.end(), pages.begin(), pages.end());
+    prefetch_next_page_id_ = next_page_id;
+  }
+  if (prefetched_.empty()) {
+    prefetch_next_page_id_ = leaf_->GetNextPageId();
+  }
+  if (prefetched_.size() > depth / 2 || prefetch_next_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  size_t count = depth - prefetched_.size();
+  auto task = std::make_shared<std::packaged_task<std::pair<std::vector<Page *>, page_id_t>()>>(
+      [bpm = buffer_pool_manager_, page_id = prefetch_next_page_id_, count]() mutable {
+        std::vector<Page *> pages;
+        while (pages.size() < count && page_id != INVALID_PAGE_ID) {
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            break;
+          }
+          // The worker is shared by every scan of the tree, so it never waits for a writer; the leaf a writer holds
+          // is where the next batch starts.
+          if (!page->TryRLatch()) {
+            bpm->UnpinPage(page_id, false);
+            break;
+          }
+          page_id_t next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+          page->RUnlatch();
+          pages.push_back(page);
+          page_id = next_page_id;
+        }
+        return std::make_pair(std::move(pages), page_id);
+      });
+  prefetch_task_ = task->get_future();
+  tree_->prefetch_worker_.Submit([task] { (*task)(); });
+}
+
+/*
+ * Prefetched leaves that the scan has passed by, or that are no longer linked
+ * after a concurrent split or merge, are dropped on the way.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::TakePrefetched(page_id_t page_id) -> Page * {
+  while (!prefetched_.empty()) {
+    Page *page = prefetched_.front();
+    prefetched_.pop_front();
+    if (page->GetPageId() == page_id) {
+      return page;
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  return nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::DropPrefetched() {
+  if (prefetch_task_.valid()) {
+    auto [pages, next_page_id] = prefetch_task_.get();
+    prefetched_.insert(prefetched_.end(), pages.begin(), pages.end());
+  }
+  for (auto *page : prefetched_) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  prefetched_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -35,5 +346,7 @@ template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<GenericKey<128>, RID, GenericComparator<128>>;
+template class IndexIterator<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
@@ -0,0 +1,297 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_internal_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_compressed_internal_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_compressed_internal_page.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+/*
+ * Init method after creating a new internal page: set page type, page id/parent
+ * id and max size, and make the page responsible for every key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  this->Reset();
+  this->SetPageType(IndexPageType::INTERNAL_PAGE);
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->SetMaxSize(max_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  BUSTUB_ASSERT(index > 0, "key 0 is the low key");
+  this->ReplaceKeyAt(index, key);
+}
+
+/*
+ * Helper method to find and return array index(or offset), so that its value
+ * equals to input "value"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (this->ValueRef(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return this->ValueRef(index); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::CoversKey(const KeyType &key, const KeyComparator &comparator) const
+    -> bool {
+  return this->GetNextPageId() == INVALID_PAGE_ID || comparator(key, this->GetHighKey()) < 0;
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Find and return the child pointer(page_id) which points to the child page
+ * that contains input "key"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const
+    -> ValueType {
+  return this->ValueRef(this->UpperBound(1, key) - 1);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Populate new root page with old_value + new_key & new_value. The root is
+ * responsible for every key, so key 0 is the smallest key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                                const ValueType &new_value) {
+  this->Rebuild({{this->GetLowKey(), old_value}, {new_key, new_value}}, this->GetLowKey(), this->GetHighKey());
+}
+
+/*
+ * Insert new_key & new_value pair right after the pair with its value ==
+ * old_value
+ * @return:  new size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                                const ValueType &new_value) -> int {
+  this->InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
+  return this->GetSize();
+}
+
+/*
+ * Insert new_key & new_value pair at the position given by new_key, see
+ * BPlusTreeInternalPage::InsertNode()
+ * @return:  new size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::InsertNode(const KeyType &new_key, const ValueType &new_value,
+                                                           const KeyComparator &comparator) -> int {
+  this->InsertAt(this->LowerBound(1, new_key), new_key, new_value);
+  return this->GetSize();
+}
+
+/*
+ * Append a child that sorts after every child already in me, used when bulk
+ * loading. The first child's key must be my low key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Append(const KeyType &key, const ValueType &child) {
+  this->InsertAt(this->GetSize(), key, child);
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Remove half of key & value pairs from this page to "recipient" page. The
+ * first key moved is the recipient's low key and my new high key, and the
+ * caller pushes it up into the parent, so the shortest key near the middle is
+ * picked.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeCompressedInternalPage *recipient,
+                                                           BufferPoolManager *buffer_pool_manager) {
+  auto entries = this->GetEntries();
+  int size = this->GetSize();
+  int middle = size / 2;
+  int window = size / 8;
+  int start = middle;
+  for (int i = std::max(middle - window, 1); i <= std::min(middle + window, size - 1); i++) {
+    int key_size = this->TrimmedSize(entries[i].first);
+    int start_size = this->TrimmedSize(entries[start].first);
+    if (key_size < start_size || (key_size == start_size && std::abs(i - middle) < std::abs(start - middle))) {
+      start = i;
+    }
+  }
+  KeyType middle_key = entries[start].first;
+  recipient->Rebuild({entries.begin() + start, entries.end()}, middle_key, this->GetHighKey());
+  this->Rebuild({entries.begin(), entries.begin() + start}, this->GetLowKey(), middle_key);
+  for (int i = 0; i < recipient->GetSize(); i++) {
+    recipient->Adopt(recipient->ValueRef(i), buffer_pool_manager);
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove the key & value pair in internal page according to input index(a.k.a
+ * array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Remove(int index) {
+  BUSTUB_ASSERT(index > 0, "key 0 is the low key");
+  this->RemoveAt(index);
+}
+
+/*
+ * Remove the only key & value pair in internal page and return the value
+ * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  ValueType child = this->ValueRef(0);
+  this->Rebuild({}, this->GetLowKey(), this->GetHighKey());
+  return child;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+/*
+ * Remove all of my key & value pairs to my left sibling "recipient". The
+ * middle key from the parent replaces my key 0, and the recipient takes over
+ * my key range.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeCompressedInternalPage *recipient,
+                                                          const KeyType &middle_key,
+                                                          BufferPoolManager *buffer_pool_manager) {
+  auto entries = recipient->GetEntries();
+  auto mine = this->GetEntries();
+  mine[0].first = middle_key;
+  entries.insert(entries.end(), mine.begin(), mine.end());
+  recipient->Rebuild(entries, recipient->GetLowKey(), this->GetHighKey());
+  for (const auto &entry : mine) {
+    recipient->Adopt(entry.second, buffer_pool_manager);
+  }
+  this->Rebuild({}, this->GetLowKey(), this->GetHighKey());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::CanMergeFrom(const BPlusTreeCompressedInternalPage *right,
+                                                             const KeyType &middle_key) const -> bool {
+  auto entries = this->GetEntries();
+  auto theirs = right->GetEntries();
+  theirs[0].first = middle_key;
+  entries.insert(entries.end(), theirs.begin(), theirs.end());
+  return this->Fits(entries, this->GetLowKey(), right->GetHighKey());
+}
+
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+/*
+ * Remove my first key & value pair to the tail of "recipient" page, under the
+ * middle key from the parent. My key 1 becomes my low key and the recipient's
+ * high key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeCompressedInternalPage *recipient,
+                                                                 const KeyType &middle_key,
+                                                                 BufferPoolManager *buffer_pool_manager) {
+  auto entries = this->GetEntries();
+  KeyType separator = entries[1].first;
+  auto left = recipient->GetEntries();
+  left.emplace_back(middle_key, entries[0].second);
+  recipient->Rebuild(left, recipient->GetLowKey(), separator);
+  this->Rebuild({entries.begin() + 1, entries.end()}, separator, this->GetHighKey());
+  recipient->Adopt(entries[0].second, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::CanTakeFirstOf(const BPlusTreeCompressedInternalPage *right,
+                                                               const KeyType &middle_key) const -> bool {
+  if (right->GetSize() < 2) {
+    return false;
+  }
+  auto entries = this->GetEntries();
+  entries.emplace_back(middle_key, right->ValueAt(0));
+  return this->Fits(entries, this->GetLowKey(), right->KeyAt(1));
+}
+
+/*
+ * Remove my last key & value pair to the head of "recipient" page. Its key
+ * becomes the recipient's low key and my high key, and the middle key from the
+ * parent moves down to the recipient's old first child.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeCompressedInternalPage *recipient,
+                                                                  const KeyType &middle_key,
+                                                                  BufferPoolManager *buffer_pool_manager) {
+  auto entries = this->GetEntries();
+  auto last = entries.back();
+  entries.pop_back();
+  auto right = recipient->GetEntries();
+  right[0].first = middle_key;
+  right.insert(right.begin(), last);
+  recipient->Rebuild(right, last.first, recipient->GetHighKey());
+  this->Rebuild(entries, this->GetLowKey(), last.first);
+  recipient->Adopt(last.second, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::CanTakeLastOf(const BPlusTreeCompressedInternalPage *left,
+                                                              const KeyType &middle_key) const -> bool {
+  int size = left->GetSize();
+  if (size < 2) {
+    return false;
+  }
+  auto entries = this->GetEntries();
+  entries[0].first = middle_key;
+  entries.emplace(entries.begin(), left->KeyAt(size - 1), left->ValueAt(size - 1));
+  return this->Fits(entries, left->KeyAt(size - 1), this->GetHighKey());
+}
+
+/*
+ * Make me the parent of the given child page, persisting the change through the buffer pool.
+ * B-link trees do not keep parent pointers and pass a null buffer pool manager.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager) {
+  if (buffer_pool_manager == nullptr) {
+    return;
+  }
+  auto *page = buffer_pool_manager->FetchPage(child);
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(this->GetPageId());
+  buffer_pool_manager->UnpinPage(child, true);
+}
+
+template class BPlusTreeCompressedInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
+}  // namespace bustub
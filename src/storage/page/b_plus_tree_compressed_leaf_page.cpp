@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_leaf_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_compressed_leaf_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_compressed_leaf_page.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "common/rid.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new leaf page: set page type, page id/parent id
+ * and max size, and make the page responsible for every key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  this->Reset();
+  this->SetPageType(IndexPageType::LEAF_PAGE);
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->SetMaxSize(max_size);
+}
+
+/**
+ * Helper method to find the first index i so that KeyAt(i) >= key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const
+    -> int {
+  return this->LowerBound(0, key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  return {this->KeyAt(index), this->ValueRef(index)};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  this->ValueRef(index) = value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::CoversKey(const KeyType &key, const KeyComparator &comparator) const
+    -> bool {
+  return this->GetNextPageId() == INVALID_PAGE_ID || comparator(key, this->GetHighKey()) < 0;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert key & value pair into leaf page ordered by key
+ * If the key already exists, nothing is inserted.
+ * @return  page size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                                                   const KeyComparator &comparator) -> int {
+  int index = this->LowerBound(0, key);
+  if (index < this->GetSize() && this->KeyEquals(index, key)) {
+    return this->GetSize();
+  }
+  this->InsertAt(index, key, value);
+  return this->GetSize();
+}
+
+/*
+ * Append {size} items that sort after every key already in me, used when bulk loading.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Append(const MappingType *items, int size) {
+  for (int i = 0; i < size; i++) {
+    this->InsertAt(this->GetSize(), items[i].first, items[i].second);
+  }
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Move the upper half of my entries to "recipient", which takes over my key
+ * range above the separator. Of the cut points near the middle, the one with
+ * the shortest separator wins, so that the parent stores as little as possible.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeCompressedLeafPage *recipient) {
+  auto entries = this->GetEntries();
+  int size = this->GetSize();
+  int middle = size / 2;
+  int window = size / 8;
+  int start = middle;
+  KeyType separator = this->Separator(entries[middle - 1].first, entries[middle].first);
+  for (int i = std::max(middle - window, 1); i <= std::min(middle + window, size - 1); i++) {
+    KeyType candidate = this->Separator(entries[i - 1].first, entries[i].first);
+    int candidate_size = this->TrimmedSize(candidate);
+    int separator_size = this->TrimmedSize(separator);
+    if (candidate_size < separator_size ||
+        (candidate_size == separator_size && std::abs(i - middle) < std::abs(start - middle))) {
+      start = i;
+      separator = candidate;
+    }
+  }
+  recipient->Rebuild({entries.begin() + start, entries.end()}, separator, this->GetHighKey());
+  this->Rebuild({entries.begin(), entries.begin() + start}, this->GetLowKey(), separator);
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * For the given key, check to see whether it exists in the leaf page. If it
+ * does, then store its corresponding value in input "value" and return true.
+ * If the key does not exist, then return false
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value,
+                                                   const KeyComparator &comparator) const -> bool {
+  int index = this->LowerBound(0, key);
+  if (index < this->GetSize() && this->KeyEquals(index, key)) {
+    *value = this->ValueRef(index);
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * First look through leaf page to see whether delete key exist or not. If
+ * exist, perform deletion, otherwise return immediately.
+ * @return   page size after deletion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator)
+    -> int {
+  int index = this->LowerBound(0, key);
+  if (index < this->GetSize() && this->KeyEquals(index, key)) {
+    this->RemoveAt(index);
+  }
+  return this->GetSize();
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+/*
+ * Remove all of my entries to my left sibling "recipient", which takes over my
+ * key range and my right sibling.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeCompressedLeafPage *recipient) {
+  auto entries = recipient->GetEntries();
+  auto mine = this->GetEntries();
+  entries.insert(entries.end(), mine.begin(), mine.end());
+  recipient->Rebuild(entries, recipient->GetLowKey(), this->GetHighKey());
+  recipient->SetNextPageId(this->GetNextPageId());
+  this->Rebuild({}, this->GetLowKey(), this->GetHighKey());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::CanMergeFrom(const BPlusTreeCompressedLeafPage *right) const -> bool {
+  auto entries = this->GetEntries();
+  auto theirs = right->GetEntries();
+  entries.insert(entries.end(), theirs.begin(), theirs.end());
+  return this->Fits(entries, this->GetLowKey(), right->GetHighKey());
+}
+
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+/*
+ * Remove my first entry to the end of my left sibling "recipient". The key
+ * range boundary between us moves to the separator between my first two keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeCompressedLeafPage *recipient) {
+  auto entries = this->GetEntries();
+  KeyType separator = this->Separator(entries[0].first, entries[1].first);
+  auto left = recipient->GetEntries();
+  left.push_back(entries[0]);
+  recipient->Rebuild(left, recipient->GetLowKey(), separator);
+  this->Rebuild({entries.begin() + 1, entries.end()}, separator, this->GetHighKey());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::CanTakeFirstOf(const BPlusTreeCompressedLeafPage *right) const -> bool {
+  if (right->GetSize() < 2) {
+    return false;
+  }
+  auto entries = this->GetEntries();
+  entries.push_back(right->GetItem(0));
+  return this->Fits(entries, this->GetLowKey(), this->Separator(right->KeyAt(0), right->KeyAt(1)));
+}
+
+/*
+ * Remove my last entry to the front of my right sibling "recipient". The key
+ * range boundary between us moves to the separator between my last two keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeCompressedLeafPage *recipient) {
+  auto entries = this->GetEntries();
+  auto last = entries.back();
+  entries.pop_back();
+  KeyType separator = this->Separator(entries.back().first, last.first);
+  auto right = recipient->GetEntries();
+  right.insert(right.begin(), last);
+  recipient->Rebuild(right, separator, recipient->GetHighKey());
+  this->Rebuild(entries, this->GetLowKey(), separator);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::CanTakeLastOf(const BPlusTreeCompressedLeafPage *left) const -> bool {
+  int size = left->GetSize();
+  if (size < 2) {
+    return false;
+  }
+  auto entries = this->GetEntries();
+  entries.insert(entries.begin(), left->GetItem(size - 1));
+  return this->Fits(entries, this->Separator(left->KeyAt(size - 2), left->KeyAt(size - 1)), this->GetHighKey());
+}
+
+template class BPlusTreeCompressedLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<256>, RID, GenericComparator<256>>;
+}  // namespace bustub
@@ -0,0 +1,367 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_compressed_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_compressed_page.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_COMPRESSED_PAGE_TYPE BPlusTreeCompressedPage<KeyType, ValueType>
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetNextPageId() const -> page_id_t {
+  return next_page_id_;
+}
+
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+/*
+ * Helper methods to get/set the key range. The keys are decoded from their
+ * trimmed copies at the end of the page. The prefix follows the range, so
+ * changing it re-encodes every entry.
+ */
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetHighKey() const -> KeyType {
+  KeyType key;
+  if (high_key_size_ == 0) {
+    memset(key.data_, 0xFF, sizeof(KeyType));
+    return key;
+  }
+  memset(key.data_, 0, sizeof(KeyType));
+  memcpy(key.data_, Data() + PAGE_SIZE - high_key_size_, high_key_size_);
+  return key;
+}
+
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetHighKey(const KeyType &high_key) {
+  KeyType old_high_key = GetHighKey();
+  if (memcmp(high_key.data_, old_high_key.data_, sizeof(KeyType)) != 0) {
+    Rebuild(GetEntries(), GetLowKey(), high_key);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetLowKey() const -> KeyType {
+  KeyType key;
+  memset(key.data_, 0, sizeof(KeyType));
+  memcpy(key.data_, LowKeyData(), low_key_size_);
+  return key;
+}
+
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetLowKey(const KeyType &low_key) {
+  KeyType old_low_key = GetLowKey();
+  if (memcmp(low_key.data_, old_low_key.data_, sizeof(KeyType)) != 0) {
+    Rebuild(GetEntries(), low_key, GetHighKey());
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetPrefixSize() const -> int {
+  return prefix_size_;
+}
+
+/*
+ * Decode the key at index: the prefix of the range, then the stored suffix,
+ * then the zero padding that was trimmed.
+ */
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  const Slot &slot = slots_[index];
+  KeyType key;
+  memset(key.data_, 0, sizeof(KeyType));
+  memcpy(key.data_, LowKeyData(), prefix_size_);
+  memcpy(key.data_ + prefix_size_, Data() + slot.offset_, slot.size_);
+  return key;
+}
+
+/*
+ * Space helper methods. A page that has room for n entries fits n more
+ * entries whatever their keys are.
+ */
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::HasRoomFor(int entries) const -> bool {
+  return UsedBytes() + entries * MaxEntrySize() <= CAPACITY;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::StaysHalfFull(int removed_entries) const -> bool {
+  return (UsedBytes() - removed_entries * MaxEntrySize()) * 2 >= CAPACITY;
+}
+
+/*
+ * The separator is right cut after the first byte that differs from left.
+ * It keeps that byte, so it is greater than left, and drops the rest, so it is
+ * not greater than right.
+ */
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Separator(const KeyType &left, const KeyType &right) -> KeyType {
+  int size = std::min(CommonPrefix(left, right) + 1, static_cast<int>(sizeof(KeyType)));
+  KeyType separator;
+  memset(separator.data_, 0, sizeof(KeyType));
+  memcpy(separator.data_, right.data_, size);
+  return separator;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::TrimmedSize(const KeyType &key) -> int {
+  int size = sizeof(KeyType);
+  while (size > 0 && key.data_[size - 1] == 0) {
+    size--;
+  }
+  return size;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::CapacityFor(int key_size) -> int {
+  // The key range of the page consists of separators, which are no longer than the keys they separate.
+  return (CAPACITY - 2 * key_size - static_cast<int>(sizeof(Slot) + sizeof(KeyType))) /
+         static_cast<int>(sizeof(Slot) + key_size);
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::EncodedSize(const std::vector<std::pair<KeyType, ValueType>> &entries,
+                                                   const KeyType &low_key, const KeyType &high_key) -> int {
+  int prefix_size = CommonPrefix(low_key, high_key);
+  int size = FenceSize(low_key, high_key, prefix_size);
+  for (const auto &entry : entries) {
+    size += sizeof(Slot) + SuffixSize(entry.first, prefix_size);
+  }
+  return size;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Fits(const std::vector<std::pair<KeyType, ValueType>> &entries,
+                                            const KeyType &low_key, const KeyType &high_key) -> bool {
+  int max_entry_size = sizeof(Slot) + sizeof(KeyType) - CommonPrefix(low_key, high_key);
+  return EncodedSize(entries, low_key, high_key) + max_entry_size <= CAPACITY;
+}
+
+/*
+ * Empty the page and make it responsible for every key: the low key is the
+ * smallest key and the high key the largest, so there is no prefix and neither
+ * key takes up any space.
+ */
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Reset() {
+  BUSTUB_ASSERT(reinterpret_cast<const char *>(slots_) - Data() == COMPRESSED_PAGE_HEADER_SIZE,
+                "unexpected page layout");
+  SetSize(0);
+  next_page_id_ = INVALID_PAGE_ID;
+  prefix_size_ = 0;
+  heap_begin_ = PAGE_SIZE;
+  key_bytes_ = 0;
+  low_key_size_ = 0;
+  high_key_size_ = 0;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ValueRef(int index) const -> const ValueType & {
+  return slots_[index].value_;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ValueRef(int index) -> ValueType & {
+  return slots_[index].value_;
+}
+
+/*
+ * Binary search over the suffixes. A key whose prefix differs from the range's
+ * sorts before or after every key in the page.
+ */
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::LowerBound(int begin, const KeyType &key) const -> int {
+  int cmp = memcmp(key.data_, LowKeyData(), prefix_size_);
+  if (cmp != 0) {
+    return cmp < 0 ? begin : GetSize();
+  }
+  const char *suffix = key.data_ + prefix_size_;
+  int size = SuffixSize(key, prefix_size_);
+  int left = begin;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (CompareSuffix(mid, suffix, size) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::UpperBound(int begin, const KeyType &key) const -> int {
+  int cmp = memcmp(key.data_, LowKeyData(), prefix_size_);
+  if (cmp != 0) {
+    return cmp < 0 ? begin : GetSize();
+  }
+  const char *suffix = key.data_ + prefix_size_;
+  int size = SuffixSize(key, prefix_size_);
+  int left = begin;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (CompareSuffix(mid, suffix, size) <= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::KeyEquals(int index, const KeyType &key) const -> bool {
+  return memcmp(key.data_, LowKeyData(), prefix_size_) == 0 &&
+         CompareSuffix(index, key.data_ + prefix_size_, SuffixSize(key, prefix_size_)) == 0;
+}
+
+/*
+ * Insert an entry at index, shifting the slots after it. Suffixes of removed
+ * entries are only reclaimed, by re-encoding the page, once the free space in
+ * the middle runs out.
+ */
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(memcmp(key.data_, LowKeyData(), prefix_size_) == 0, "key outside of the page's range");
+  int size = SuffixSize(key, prefix_size_);
+  int slots_end = COMPRESSED_PAGE_HEADER_SIZE + (GetSize() + 1) * sizeof(Slot);
+  if (heap_begin_ - slots_end < size) {
+    Rebuild(GetEntries(), GetLowKey(), GetHighKey());
+  }
+  BUSTUB_ASSERT(heap_begin_ - slots_end >= size, "page is full");
+  std::copy_backward(slots_ + index, slots_ + GetSize(), slots_ + GetSize() + 1);
+  heap_begin_ -= size;
+  memcpy(Data() + heap_begin_, key.data_ + prefix_size_, size);
+  slots_[index] = Slot{value, heap_begin_, static_cast<uint16_t>(size)};
+  key_bytes_ += size;
+  IncreaseSize(1);
+}
+
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::RemoveAt(int index) {
+  key_bytes_ -= slots_[index].size_;
+  std::copy(slots_ + index + 1, slots_ + GetSize(), slots_ + index);
+  IncreaseSize(-1);
+}
+
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ReplaceKeyAt(int index, const KeyType &key) {
+  ValueType value = slots_[index].value_;
+  RemoveAt(index);
+  InsertAt(index, key, value);
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::GetEntries() const -> std::vector<std::pair<KeyType, ValueType>> {
+  std::vector<std::pair<KeyType, ValueType>> entries;
+  entries.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    entries.emplace_back(KeyAt(i), slots_[i].value_);
+  }
+  return entries;
+}
+
+/*
+ * The key range is taken by value: callers may pass keys decoded from this
+ * page, whose stored copies are overwritten here. The high key is stored
+ * first, at the very end of the page, then the low key in front of it, both
+ * trimmed; the low key keeps at least the prefix, which entries are decoded
+ * and searched against.
+ */
+template <typename KeyType, typename ValueType>
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Rebuild(const std::vector<std::pair<KeyType, ValueType>> &entries,
+                                               KeyType low_key, KeyType high_key) {
+  BUSTUB_ASSERT(EncodedSize(entries, low_key, high_key) <= CAPACITY, "entries do not fit in the page");
+  SetSize(0);
+  prefix_size_ = CommonPrefix(low_key, high_key);
+  high_key_size_ = IsLargestKey(high_key) ? 0 : TrimmedSize(high_key);
+  low_key_size_ = std::max(TrimmedSize(low_key), static_cast<int>(prefix_size_));
+  memcpy(Data() + PAGE_SIZE - high_key_size_, high_key.data_, high_key_size_);
+  memcpy(Data() + PAGE_SIZE - high_key_size_ - low_key_size_, low_key.data_, low_key_size_);
+  heap_begin_ = PAGE_SIZE - high_key_size_ - low_key_size_;
+  key_bytes_ = 0;
+  for (const auto &entry : entries) {
+    InsertAt(GetSize(), entry.first, entry.second);
+  }
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::IsLargestKey(const KeyType &key) -> bool {
+  for (size_t i = 0; i < sizeof(KeyType); i++) {
+    if (static_cast<uint8_t>(key.data_[i]) != 0xFF) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::FenceSize(const KeyType &low_key, const KeyType &high_key, int prefix_size)
+    -> int {
+  return std::max(TrimmedSize(low_key), prefix_size) + (IsLargestKey(high_key) ? 0 : TrimmedSize(high_key));
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::CommonPrefix(const KeyType &lhs, const KeyType &rhs) -> int {
+  int size = 0;
+  while (size < static_cast<int>(sizeof(KeyType)) && lhs.data_[size] == rhs.data_[size]) {
+    size++;
+  }
+  return size;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SuffixSize(const KeyType &key, int prefix_size) -> int {
+  return std::max(TrimmedSize(key) - prefix_size, 0);
+}
+
+/*
+ * Suffixes compare like the padded keys they stand for: on their common
+ * length, and otherwise the shorter one, whose padding is zeros, first.
+ */
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::CompareSuffix(int index, const char *suffix, int size) const -> int {
+  const Slot &slot = slots_[index];
+  int cmp = memcmp(Data() + slot.offset_, suffix, std::min(static_cast<int>(slot.size_), size));
+  if (cmp != 0) {
+    return cmp;
+  }
+  return static_cast<int>(slot.size_) - size;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::UsedBytes() const -> int {
+  return GetSize() * static_cast<int>(sizeof(Slot)) + key_bytes_ + low_key_size_ + high_key_size_;
+}
+
+template <typename KeyType, typename ValueType>
+auto B_PLUS_TREE_COMPRESSED_PAGE_TYPE::MaxEntrySize() const -> int {
+  return static_cast<int>(sizeof(Slot) + sizeof(KeyType)) - prefix_size_;
+}
+
+template class BPlusTreeCompressedPage<GenericKey<32>, RID>;
+template class BPlusTreeCompressedPage<GenericKey<32>, page_id_t>;
+template class BPlusTreeCompressedPage<GenericKey<64>, RID>;
+template class BPlusTreeCompressedPage<GenericKey<64>, page_id_t>;
+template class BPlusTreeCompressedPage<GenericKey<128>, RID>;
+template class BPlusTreeCompressedPage<GenericKey<128>, page_id_t>;
+template class BPlusTreeCompressedPage<GenericKey<256>, RID>;
+template class BPlusTreeCompressedPage<GenericKey<256>, page_id_t>;
+}  // namespace bustub
@@ -0,0 +1,207 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search.cpp
+//
+// Identification: src/storage/page/b_plus_tree_key_search.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_key_search.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BUSTUB_KEY_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Bytes of keys a SIMD kernel scans after the binary search: four cache lines. */
+constexpr int WINDOW_BYTES = 256;
+
+/** The key as a signed integer that orders like the normalized key bytes. */
+inline auto SearchValue(const GenericKey<4> &key) -> int32_t {
+  uint32_t bits;
+  memcpy(&bits, key.data_, sizeof(bits));
+  return static_cast<int32_t>(__builtin_bswap32(bits) ^ 0x80000000U);
+}
+
+inline auto SearchValue(const GenericKey<8> &key) -> int64_t {
+  uint64_t bits;
+  memcpy(&bits, key.data_, sizeof(bits));
+  return static_cast<int64_t>(__builtin_bswap64(bits) ^ (uint64_t{1} << 63));
+}
+
+template <typename Key, typename Int>
+auto ScalarCount(const Key *keys, int begin, int end, Int probe, bool or_equal) -> int {
+  int count = 0;
+  for (int i = begin; i < end; i++) {
+    auto value = SearchValue(keys[i]);
+    count += static_cast<int>(or_equal ? value <= probe : value < probe);
+  }
+  return count;
+}
+
+#ifdef BUSTUB_KEY_SEARCH_X86
+// The kernels count the keys in [begin, end) that are below the probe: either greater-than-probe is counted and
+// subtracted, for or_equal, or probe-greater-than-key is counted directly.
+
+__attribute__((target("avx2"))) auto Avx2Count(const GenericKey<8> *keys, int begin, int end, int64_t probe,
+                                               bool or_equal) -> int {
+  const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                        15, 14, 13, 12, 11, 10, 9, 8);
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i target = _mm256_set1_epi64x(probe);
+  int count = 0;
+  int i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    lanes = _mm256_xor_si256(_mm256_shuffle_epi8(lanes, swap), sign);
+    __m256i mask = or_equal ? _mm256_cmpgt_epi64(lanes, target) : _mm256_cmpgt_epi64(target, lanes);
+    int bits = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    count += or_equal ? 4 - bits : bits;
+  }
+  return count + ScalarCount(keys, i, end, probe, or_equal);
+}
+
+__attribute__((target("avx2"))) auto Avx2Count(const GenericKey<4> *keys, int begin, int end, int32_t probe,
+                                               bool or_equal) -> int {
+  const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4,
+                                        11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+  const __m256i target = _mm256_set1_epi32(probe);
+  int count = 0;
+  int i = begin;
+  for (; i + 8 <= end; i += 8) {
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    lanes = _mm256_xor_si256(_mm256_shuffle_epi8(lanes, swap), sign);
+    __m256i mask = or_equal ? _mm256_cmpgt_epi32(lanes, target) : _mm256_cmpgt_epi32(target, lanes);
+    int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+    count += or_equal ? 8 - bits : bits;
+  }
+  return count + ScalarCount(keys, i, end, probe, or_equal);
+}
+
+__attribute__((target("sse4.2"))) auto Sse42Count(const GenericKey<8> *keys, int begin, int end, int64_t probe,
+                                                  bool or_equal) -> int {
+  const __m128i swap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+  const __m128i target = _mm_set1_epi64x(probe);
+  int count = 0;
+  int i = begin;
+  for (; i + 2 <= end; i += 2) {
+    __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    lanes = _mm_xor_si128(_mm_shuffle_epi8(lanes, swap), sign);
+    __m128i mask = or_equal ? _mm_cmpgt_epi64(lanes, target) : _mm_cmpgt_epi64(target, lanes);
+    int bits = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(mask)));
+    count += or_equal ? 2 - bits : bits;
+  }
+  return count + ScalarCount(keys, i, end, probe, or_equal);
+}
+
+__attribute__((target("sse4.2"))) auto Sse42Count(const GenericKey<4> *keys, int begin, int end, int32_t probe,
+                                                  bool or_equal) -> int {
+  const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i sign = _mm_set1_epi32(INT32_MIN);
+  const __m128i target = _mm_set1_epi32(probe);
+  int count = 0;
+  int i = begin;
+  for (; i + 4 <= end; i += 4) {
+    __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    lanes = _mm_xor_si128(_mm_shuffle_epi8(lanes, swap), sign);
+    __m128i mask = or_equal ? _mm_cmpgt_epi32(lanes, target) : _mm_cmpgt_epi32(target, lanes);
+    int bits = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+    count += or_equal ? 4 - bits : bits;
+  }
+  return count + ScalarCount(keys, i, end, probe, or_equal);
+}
+#endif
+
+auto Supports(KeySearch::Kernel kernel) -> bool {
+#ifdef BUSTUB_KEY_SEARCH_X86
+  __builtin_cpu_init();
+  switch (kernel) {
+    case KeySearch::Kernel::AVX2:
+      return __builtin_cpu_supports("avx2");
+    case KeySearch::Kernel::SSE42:
+      return __builtin_cpu_supports("sse4.2");
+    case KeySearch::Kernel::SCALAR:
+      return true;
+  }
+#endif
+  return kernel == KeySearch::Kernel::SCALAR;
+}
+
+auto DetectKernel() -> KeySearch::Kernel {
+  for (auto kernel : {KeySearch::Kernel::AVX2, KeySearch::Kernel::SSE42}) {
+    if (Supports(kernel)) {
+      return kernel;
+    }
+  }
+  return KeySearch::Kernel::SCALAR;
+}
+
+/** The kernel in use, detected on first use so that searches from static initializers work as well. */
+auto CurrentKernel() -> std::atomic<KeySearch::Kernel> & {
+  static std::atomic<KeySearch::Kernel> kernel{DetectKernel()};
+  return kernel;
+}
+
+template <typename Key>
+auto Count(const Key *keys, int size, const Key &key, bool or_equal) -> int {
+  auto probe = SearchValue(key);
+  auto current = CurrentKernel().load(std::memory_order_relaxed);
+  // The scalar kernel binary searches all the way down.
+  int window = current == KeySearch::Kernel::SCALAR ? 0 : WINDOW_BYTES / static_cast<int>(sizeof(Key));
+  int left = 0;
+  int right = size;
+  while (right - left > window) {
+    int mid = left + (right - left) / 2;
+    auto value = SearchValue(keys[mid]);
+    if (or_equal ? value <= probe : value < probe) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+#ifdef BUSTUB_KEY_SEARCH_X86
+  if (current == KeySearch::Kernel::AVX2) {
+    return left + Avx2Count(keys, left, right, probe, or_equal);
+  }
+  if (current == KeySearch::Kernel::SSE42) {
+    return left + Sse42Count(keys, left, right, probe, or_equal);
+  }
+#endif
+  return left + ScalarCount(keys, left, right, probe, or_equal);
+}
+
+}  // namespace
+
+auto KeySearch::CountLess(const GenericKey<4> *keys, int size, const GenericKey<4> &key) -> int {
+  return Count(keys, size, key, false);
+}
+
+auto KeySearch::CountLess(const GenericKey<8> *keys, int size, const GenericKey<8> &key) -> int {
+  return Count(keys, size, key, false);
+}
+
+auto KeySearch::CountLessEqual(const GenericKey<4> *keys, int size, const GenericKey<4> &key) -> int {
+  return Count(keys, size, key, true);
+}
+
+auto KeySearch::CountLessEqual(const GenericKey<8> *keys, int size, const GenericKey<8> &key) -> int {
+  return Count(keys, size, key, true);
+}
+
+auto KeySearch::GetKernel() -> Kernel { return CurrentKernel().load(); }
+
+void KeySearch::SetKernel(Kernel kernel) { CurrentKernel().store(Supports(kernel) ? kernel : Kernel::SCALAR); }
+
+}  // namespace bustub
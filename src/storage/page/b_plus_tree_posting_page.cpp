@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_posting_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+auto BPlusTreePostingPage::Create(BufferPoolManager *buffer_pool_manager, const RID &first, const RID &second) -> RID {
+  page_id_t page_id;
+  auto *page = buffer_pool_manager->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+  }
+  auto *head = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+  head->Init();
+  head->rids_[head->size_++] = first;
+  head->rids_[head->size_++] = second;
+  buffer_pool_manager->UnpinPage(page_id, true);
+  return RID(page_id, POSTING_LIST_SLOT_NUM);
+}
+
+/*
+ * A full head moves all of its RIDs into a new page linked right after it, so
+ * that the head keeps its page id and every page but the head stays full.
+ */
+void BPlusTreePostingPage::Append(BufferPoolManager *buffer_pool_manager, const RID &marker, const RID &rid) {
+  auto *head = Fetch(buffer_pool_manager, marker.GetPageId());
+  if (head->IsFull()) {
+    page_id_t page_id;
+    auto *page = buffer_pool_manager->NewPage(&page_id);
+    if (page == nullptr) {
+      buffer_pool_manager->UnpinPage(marker.GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate page from the buffer pool");
+    }
+    auto *second = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+    second->next_page_id_ = head->next_page_id_;
+    second->size_ = head->size_;
+    std::copy(head->rids_, head->rids_ + head->size_, second->rids_);
+    buffer_pool_manager->UnpinPage(page_id, true);
+    head->next_page_id_ = page_id;
+    head->size_ = 0;
+  }
+  head->rids_[head->size_++] = rid;
+  buffer_pool_manager->UnpinPage(marker.GetPageId(), true);
+}
+
+/*
+ * The hole is filled with the last RID of the head. A head that becomes empty
+ * takes over the (full) page after it, and a posting list down to one RID is
+ * freed, so that the RID moves back inline.
+ */
+auto BPlusTreePostingPage::Remove(BufferPoolManager *buffer_pool_manager, const RID &marker, const RID &rid,
+                                  RID *remaining) -> bool {
+  page_id_t head_page_id = marker.GetPageId();
+  auto *head = Fetch(buffer_pool_manager, head_page_id);
+  bool found = false;
+  for (page_id_t page_id = head_page_id; page_id != INVALID_PAGE_ID && !found;) {
+    auto *posting = page_id == head_page_id ? head : Fetch(buffer_pool_manager, page_id);
+    auto *end = posting->rids_ + posting->size_;
+    auto *position = std::find(posting->rids_, end, rid);
+    found = position != end;
+    if (found) {
+      *position = head->rids_[--head->size_];
+    }
+    page_id_t next_page_id = posting->next_page_id_;
+    if (posting != head) {
+      buffer_pool_manager->UnpinPage(page_id, found);
+    }
+    page_id = next_page_id;
+  }
+  *remaining = marker;
+  if (!found) {
+    buffer_pool_manager->UnpinPage(head_page_id, false);
+    return false;
+  }
+
+  if (head->size_ == 0 && head->next_page_id_ != INVALID_PAGE_ID) {
+    page_id_t second_page_id = head->next_page_id_;
+    auto *second = Fetch(buffer_pool_manager, second_page_id);
+    head->next_page_id_ = second->next_page_id_;
+    head->size_ = second->size_;
+    std::copy(second->rids_, second->rids_ + second->size_, head->rids_);
+    buffer_pool_manager->UnpinPage(second_page_id, false);
+    buffer_pool_manager->DeletePage(second_page_id);
+  }
+  bool single = head->next_page_id_ == INVALID_PAGE_ID && head->size_ == 1;
+  if (single) {
+    *remaining = head->rids_[0];
+  }
+  buffer_pool_manager->UnpinPage(head_page_id, true);
+  if (single) {
+    buffer_pool_manager->DeletePage(head_page_id);
+  }
+  return true;
+}
+
+void BPlusTreePostingPage::Collect(BufferPoolManager *buffer_pool_manager, const RID &marker,
+                                   std::vector<RID> *result) {
+  for (page_id_t page_id = marker.GetPageId(); page_id != INVALID_PAGE_ID;) {
+    auto *posting = Fetch(buffer_pool_manager, page_id);
+    result->insert(result->end(), posting->rids_, posting->rids_ + posting->size_);
+    page_id_t next_page_id = posting->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void BPlusTreePostingPage::Free(BufferPoolManager *buffer_pool_manager, const RID &marker) {
+  for (page_id_t page_id = marker.GetPageId(); page_id != INVALID_PAGE_ID;) {
+    page_id_t next_page_id = Fetch(buffer_pool_manager, page_id)->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+void BPlusTreePostingPage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+}
+
+auto BPlusTreePostingPage::Fetch(BufferPoolManager *buffer_pool_manager, page_id_t page_id)
+    -> BPlusTreePostingPage * {
+  auto *page = buffer_pool_manager->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page from the buffer pool");
+  }
+  return reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+}
+
+}  // namespace bustub
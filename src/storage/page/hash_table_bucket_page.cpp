@@ -11,6 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#define BUSTUB_BUCKET_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,63 +28,199 @@
 
 namespace bustub {
 
+namespace {
+
+/** @return the 64 bits of bitmap that start at bit 64 * word_idx; bytes past the end of the bitmap read as zero */
+inline auto LoadBitmapWord(const char *bitmap, size_t bitmap_bytes, size_t word_idx) -> uint64_t {
+  uint64_t word = 0;
+  size_t offset = word_idx * sizeof(uint64_t);
+  memcpy(&word, bitmap + offset, std::min(sizeof(uint64_t), bitmap_bytes - offset));
+  return word;
+}
+
+inline auto NumBitmapWords(size_t bitmap_bytes) -> size_t { return (bitmap_bytes - 1) / sizeof(uint64_t) + 1; }
+
+}  // namespace
+
+/*
+ * Slots are taken in order and occupied_ bits are never cleared, so the
+ * occupied slots form a prefix of the array and scans stop at the first slot
+ * that was never used. Scans go a group of slots at a time, and only visit the
+ * readable slots of a group whose fingerprint matches.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+  bool found = false;
+  uint8_t fingerprint = Fingerprint(key);
+  uint32_t num_occupied = NumOccupied();
+  for (uint32_t group_start = 0; group_start < num_occupied; group_start += FINGERPRINT_GROUP_SIZE) {
+    for (uint32_t mask = MatchFingerprint(group_start, fingerprint); mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = group_start + __builtin_ctz(mask);
+      if (cmp(array_[bucket_idx].first, key) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  uint8_t fingerprint = Fingerprint(key);
+  uint32_t num_occupied = NumOccupied();
+  for (uint32_t group_start = 0; group_start < num_occupied; group_start += FINGERPRINT_GROUP_SIZE) {
+    for (uint32_t mask = MatchFingerprint(group_start, fingerprint); mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = group_start + __builtin_ctz(mask);
+      if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+        return false;
+      }
+    }
+  }
+  uint32_t free_idx = FreeSlot();
+  if (free_idx == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  fingerprints_[free_idx] = fingerprint;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  uint8_t fingerprint = Fingerprint(key);
+  uint32_t num_occupied = NumOccupied();
+  for (uint32_t group_start = 0; group_start < num_occupied; group_start += FINGERPRINT_GROUP_SIZE) {
+    for (uint32_t mask = MatchFingerprint(group_start, fingerprint); mask != 0; mask &= mask - 1) {
+      uint32_t bucket_idx = group_start + __builtin_ctz(mask);
+      if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] = static_cast<char>(readable_[bucket_idx / 8] & ~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] = static_cast<char>(occupied_[bucket_idx / 8] | (1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] = static_cast<char>(readable_[bucket_idx / 8] | (1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  uint32_t count = 0;
+  for (size_t word_idx = 0; word_idx < NumBitmapWords(sizeof(readable_)); word_idx++) {
+    count += __builtin_popcountll(LoadBitmapWord(readable_, sizeof(readable_), word_idx));
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  for (size_t word_idx = 0; word_idx < NumBitmapWords(sizeof(readable_)); word_idx++) {
+    if (LoadBitmapWord(readable_, sizeof(readable_), word_idx) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::Fingerprint(const KeyType &key) -> uint8_t {
+  // Multiply-xor over the key a word at a time; the top byte of the product depends on every bit of the key.
+  const auto *bytes = reinterpret_cast<const char *>(&key);
+  uint64_t hash = 0;
+  for (size_t offset = 0; offset < sizeof(KeyType); offset += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + offset, std::min(sizeof(uint64_t), sizeof(KeyType) - offset));
+    hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+  }
+  return static_cast<uint8_t>(hash >> 56);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::MatchFingerprint(uint32_t group_start, uint8_t fingerprint) const -> uint32_t {
+#ifdef BUSTUB_BUCKET_SSE2
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + group_start));
+  auto matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(fingerprint))));
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < FINGERPRINT_GROUP_SIZE; i++) {
+    matches |= static_cast<uint32_t>(fingerprints_[group_start + i] == fingerprint) << i;
+  }
+#endif
+  // A group starts on a byte boundary of the bitmap and covers two of its bytes.
+  size_t byte_idx = group_start / 8;
+  uint32_t readable = static_cast<uint8_t>(readable_[byte_idx]);
+  if (byte_idx + 1 < sizeof(readable_)) {
+    readable |= static_cast<uint32_t>(static_cast<uint8_t>(readable_[byte_idx + 1])) << 8;
+  }
+  return matches & readable;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::NumOccupied() const -> uint32_t {
+  uint32_t count = 0;
+  for (size_t word_idx = 0; word_idx < NumBitmapWords(sizeof(occupied_)); word_idx++) {
+    count += __builtin_popcountll(LoadBitmapWord(occupied_, sizeof(occupied_), word_idx));
+  }
+  return count;
+}
+
+/*
+ * The first tombstone, i.e. an occupied slot that is not readable, or else the
+ * first slot that was never used.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::FreeSlot() const -> uint32_t {
+  uint32_t num_occupied = 0;
+  for (size_t word_idx = 0; word_idx < NumBitmapWords(sizeof(occupied_)); word_idx++) {
+    uint64_t occupied = LoadBitmapWord(occupied_, sizeof(occupied_), word_idx);
+    uint64_t tombstones = occupied & ~LoadBitmapWord(readable_, sizeof(readable_), word_idx);
+    if (tombstones != 0) {
+      return word_idx * 64 + __builtin_ctzll(tombstones);
+    }
+    num_occupied += __builtin_popcountll(occupied);
+  }
+  return num_occupied;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -108,6 +253,8 @@ template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class HashTableBucketPage<GenericKey<128>, RID, GenericComparator<128>>;
+template class HashTableBucketPage<GenericKey<256>, RID, GenericComparator<256>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
@@ -286,8 +286,8 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
     return false;
   }
 
-  // Otherwise we have a valid tuple, try to acquire at least a shared lock.
-  if (enable_logging) {
+  // Otherwise we have a valid tuple, try to acquire at least a shared lock. Optimistic readers validate instead.
+  if (enable_logging && txn->GetConcurrencyMode() == ConcurrencyMode::TWO_PHASE_LOCKING) {
     if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
       return false;
     }
@@ -13,6 +13,7 @@
 #include <cassert>
 
 #include "common/logger.h"
+#include "concurrency/transaction_manager.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -91,6 +92,14 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
 }
 
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
+  if (txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC) {
+    txn->GetBufferedWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+    return true;
+  }
+  return MarkDeleteInPlace(rid, txn);
+}
+
+auto TableHeap::MarkDeleteInPlace(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -110,6 +119,14 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
 }
 
 auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool {
+  if (txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC) {
+    txn->GetBufferedWriteSet()->emplace_back(rid, WType::UPDATE, tuple, this);
+    return true;
+  }
+  return UpdateTupleInPlace(tuple, rid, txn);
+}
+
+auto TableHeap::UpdateTupleInPlace(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -123,8 +140,8 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
-  // Update the transaction's write set.
-  if (is_updated && txn->GetState() != TransactionState::ABORTED) {
+  // Update the transaction's write set. A wounded transaction may still be writing, so record even when aborted.
+  if (is_updated) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   }
   return is_updated;
@@ -154,6 +171,24 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
 }
 
 auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
+  if (txn != nullptr && txn->GetConcurrencyMode() == ConcurrencyMode::OPTIMISTIC) {
+    // Read your own writes: the latest buffered image of the tuple wins.
+    auto write_set = txn->GetBufferedWriteSet();
+    for (auto it = write_set->rbegin(); it != write_set->rend(); ++it) {
+      if (it->table_ == this && it->rid_ == rid) {
+        if (it->wtype_ == WType::DELETE) {
+          return false;
+        }
+        // rid may alias tuple->rid_, as it does for the table iterator.
+        *tuple = it->tuple_;
+        tuple->rid_ = it->rid_;
+        return true;
+      }
+    }
+    // No lock is taken; the version is validated at commit instead. It must be taken before the tuple: a writer that
+    // slips in between bumps it afterwards and fails us.
+    txn->AddIntoReadSet(rid, TransactionManager::version_table.Get(rid));
+  }
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
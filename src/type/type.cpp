@@ -17,6 +17,7 @@
 #include "type/decimal_type.h"
 #include "type/integer_type.h"
 #include "type/smallint_type.h"
+#include "type/timestamp_type.h"
 #include "type/tinyint_type.h"
 #include "type/value.h"
 #include "type/varlen_type.h"
@@ -26,6 +27,7 @@ namespace bustub {
 Type *Type::k_types[] = {
     new Type(TypeId::INVALID),        new BooleanType(), new TinyintType(), new SmallintType(),
     new IntegerType(TypeId::INTEGER), new BigintType(),  new DecimalType(), new VarlenType(TypeId::VARCHAR),
+    new TimestampType(),
 };
 
 // Get the size of this data type in bytes
@@ -12,11 +12,13 @@
 
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/catalog.h"
 #include "catalog/table_generator.h"
+#include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
@@ -688,4 +690,313 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+
+// Should be able to index a VARCHAR column whose values are longer than 64 bytes with a B+ tree index, both for the
+// rows already in the table and for entries inserted afterwards
+TEST(CatalogTest, VariableLengthKeyIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"pages"};
+  const std::string index_name{"url_index"};
+
+  // Construct a new table of URLs that only differ after their first 64 bytes
+  std::vector<Column> columns{{"url", TypeId::VARCHAR, 200}, {"id", TypeId::BIGINT}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(nullptr, table_name, table_schema);
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  auto url = [](int i) {
+    return "https://www.example.com/catalog/electronics/computers/laptops/product-" + std::to_string(i) +
+           "/reviews?sort=newest";
+  };
+  const int num_rows = 2000;
+  std::vector<RID> rids(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetVarcharValue(url(i)), ValueFactory::GetBigIntValue(i)},
+                &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rids[i], txn.get()));
+  }
+
+  // Construct a B+ tree index on the URL column, which populates it with the existing rows
+  std::vector<Column> key_columns{{"url", TypeId::VARCHAR, 200}};
+  std::vector<uint32_t> key_attrs{0};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<GenericKey<256>, RID, GenericComparator<256>>(
+      txn.get(), index_name, table_name, table_schema, key_schema, key_attrs, 256, HashFunction<GenericKey<256>>{},
+      IndexType::BPLUS_TREE);
+  EXPECT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+
+  // Every URL should find exactly its own row
+  auto make_key = [&](const std::string &value) {
+    return Tuple{std::vector<Value>{ValueFactory::GetVarcharValue(value)}, &key_schema};
+  };
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<RID> results{};
+    index->ScanKey(make_key(url(i)), &results, txn.get());
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(rids[i], results[0]);
+  }
+
+  // Insert and delete an entry after construction
+  const Tuple new_key = make_key(url(num_rows));
+  index->InsertEntry(new_key, RID{1000, 0}, txn.get());
+  std::vector<RID> results{};
+  index->ScanKey(new_key, &results, txn.get());
+  ASSERT_EQ(1, results.size());
+  index->DeleteEntry(new_key, RID{1000, 0}, txn.get());
+  results.clear();
+  index->ScanKey(new_key, &results, txn.get());
+  ASSERT_TRUE(results.empty());
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// A B+ tree index can store included columns after its key; lookups still go by the key columns alone, and the
+// entries are written in the entry schema
+TEST(CatalogTest, CoveringIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  // B+ tree indexes record their roots in the header page, which must not be a table page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"orders"};
+  Schema table_schema{std::vector<Column>{{"customer", TypeId::BIGINT}, {"total", TypeId::INTEGER},
+                                          {"note", TypeId::VARCHAR, 64}}};
+  auto *table_info = catalog->CreateTable(nullptr, table_name, table_schema);
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  for (int i = 0; i < 300; i++) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(i % 100), ValueFactory::GetIntegerValue(i),
+                                   ValueFactory::GetVarcharValue("note")},
+                &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  Schema key_schema{std::vector<Column>{{"customer", TypeId::BIGINT}}};
+  auto create = [&](const std::string &index_name, IndexType index_type, const std::vector<uint32_t> &include_attrs) {
+    return catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+        txn.get(), index_name, table_name, table_schema, key_schema, {0}, 16, HashFunction<GenericKey<16>>{},
+        index_type, include_attrs);
+  };
+  // Hash indexes cannot include columns, and every entry must fit into the key
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, create("hash_index", IndexType::EXTENDIBLE_HASH, {1}));
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, create("wide_index", IndexType::BPLUS_TREE, {1, 2}));
+  auto *index_info = create("customer_index", IndexType::BPLUS_TREE, {1});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, create("second_index", IndexType::BPLUS_TREE, {1}));
+  auto *index = index_info->index_.get();
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}), index->GetEntryAttrs());
+  EXPECT_TRUE(index->CoversColumns({1, 0}));
+  EXPECT_FALSE(index->CoversColumns({0, 2}));
+
+  auto make_key = [&](int64_t customer) {
+    return Tuple{std::vector<Value>{ValueFactory::GetBigIntValue(customer)}, &key_schema};
+  };
+  for (int64_t customer = 0; customer < 100; customer++) {
+    std::vector<RID> results{};
+    index->ScanKey(make_key(customer), &results, txn.get());
+    EXPECT_EQ(3, results.size());
+  }
+
+  // Entries are inserted and deleted with their included columns
+  Tuple entry{std::vector<Value>{ValueFactory::GetBigIntValue(7), ValueFactory::GetIntegerValue(1000)},
+              index->GetEntrySchema()};
+  index->InsertEntry(entry, RID{1000, 0}, txn.get());
+  std::vector<std::pair<Tuple, RID>> entries{};
+  index->ScanEntries(&entries, txn.get());
+  ASSERT_EQ(301, entries.size());
+  for (size_t i = 1; i < entries.size(); i++) {
+    EXPECT_LE(entries[i - 1].first.GetValue(index->GetEntrySchema(), 0).GetAs<int64_t>(),
+              entries[i].first.GetValue(index->GetEntrySchema(), 0).GetAs<int64_t>());
+  }
+  index->DeleteEntry(entry, RID{1000, 0}, txn.get());
+  std::vector<RID> results{};
+  index->ScanKey(make_key(7), &results, txn.get());
+  EXPECT_EQ(3, results.size());
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// A B+ tree index streams the entries of a scan through a cursor, the same ones in the same order as ScanEntries(),
+// whether the scan takes key-range locks or not
+// NOLINTNEXTLINE
+TEST(CatalogTest, IndexEntryCursor) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), &lock_manager, nullptr);
+
+  const std::string table_name{"orders"};
+  Schema table_schema{std::vector<Column>{{"customer", TypeId::BIGINT}, {"total", TypeId::INTEGER}}};
+  Schema key_schema{std::vector<Column>{{"customer", TypeId::BIGINT}}};
+  auto *txn = txn_mgr.Begin();
+  auto *table_info = catalog->CreateTable(txn, table_name, table_schema);
+  for (int i = 0; i < 300; i++) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(i % 100), ValueFactory::GetIntegerValue(i)},
+                &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn));
+  }
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn, "customer_index", table_name, table_schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{},
+      IndexType::BPLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  txn_mgr.Commit(txn);
+  delete txn;
+  auto *index = index_info->index_.get();
+
+  auto make_key = [&](int64_t customer) {
+    return Tuple{std::vector<Value>{ValueFactory::GetBigIntValue(customer)}, &key_schema};
+  };
+  auto expect_same = [&](std::unique_ptr<IndexCursor> cursor, const std::vector<std::pair<Tuple, RID>> &expected) {
+    size_t count = 0;
+    Tuple entry;
+    RID rid;
+    while (cursor->Next(&entry, &rid)) {
+      ASSERT_LT(count, expected.size());
+      EXPECT_EQ(expected[count].second, rid);
+      EXPECT_EQ(expected[count].first.GetValue(index->GetEntrySchema(), 0).GetAs<int64_t>(),
+                entry.GetValue(index->GetEntrySchema(), 0).GetAs<int64_t>());
+      count++;
+    }
+    EXPECT_EQ(expected.size(), count);
+  };
+
+  for (auto isolation_level : {IsolationLevel::READ_COMMITTED, IsolationLevel::REPEATABLE_READ}) {
+    txn = txn_mgr.Begin(nullptr, isolation_level);
+    // The cursors go first, so that they take the key-range locks themselves.
+    auto full = index->GetEntryCursor(txn);
+    auto equal = index->GetEntryCursor(make_key(7), txn);
+    auto range = index->GetEntryCursor(make_key(10), make_key(19), txn);
+    auto empty = index->GetEntryCursor(make_key(200), make_key(300), txn);
+
+    std::vector<std::pair<Tuple, RID>> entries{};
+    index->ScanEntries(&entries, txn);
+    ASSERT_EQ(300, entries.size());
+    expect_same(std::move(full), entries);
+    entries.clear();
+    index->ScanEntries(make_key(7), &entries, txn);
+    ASSERT_EQ(3, entries.size());
+    expect_same(std::move(equal), entries);
+    entries.clear();
+    index->ScanEntries(make_key(10), make_key(19), &entries, txn);
+    ASSERT_EQ(30, entries.size());
+    expect_same(std::move(range), entries);
+    expect_same(std::move(empty), {});
+
+    // Only repeatable reads lock the keys they scan, and the supremum above the last one.
+    EXPECT_EQ(isolation_level == IsolationLevel::REPEATABLE_READ, !txn->GetSharedLockSet()->empty());
+    txn_mgr.Commit(txn);
+    delete txn;
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// A cuckoo hash index is built over the existing tuples and answers point lookups.
+// NOLINTNEXTLINE
+TEST(CatalogTest, CuckooHashIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"accounts"};
+  Schema table_schema{std::vector<Column>{{"id", TypeId::BIGINT}, {"balance", TypeId::INTEGER}}};
+  auto *table_info = catalog->CreateTable(nullptr, table_name, table_schema);
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  for (int64_t i = 0; i < 2000; i++) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(i), ValueFactory::GetIntegerValue(0)}, &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  Schema key_schema{std::vector<Column>{{"id", TypeId::BIGINT}}};
+  auto create = [&](const std::string &index_name, const std::vector<uint32_t> &include_attrs) {
+    return catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        txn.get(), index_name, table_name, table_schema, key_schema, {0}, 8, HashFunction<GenericKey<8>>{},
+        IndexType::CUCKOO_HASH, include_attrs);
+  };
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, create("covering_index", {1}));
+  auto *index_info = create("id_index", {});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  for (int64_t id = 0; id < 2100; id++) {
+    std::vector<RID> results{};
+    index_info->index_->ScanKey(Tuple{std::vector<Value>{ValueFactory::GetBigIntValue(id)}, &key_schema}, &results,
+                                txn.get());
+    ASSERT_EQ(id < 2000 ? 1 : 0, results.size()) << id;
+    if (id < 2000) {
+      Tuple tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(results[0], &tuple, txn.get()));
+      EXPECT_EQ(id, tuple.GetValue(&table_schema, 0).GetAs<int64_t>());
+    }
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, LinearProbeHashIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"sessions"};
+  Schema table_schema{std::vector<Column>{{"token", TypeId::VARCHAR, 64}, {"user", TypeId::INTEGER}}};
+  auto *table_info = catalog->CreateTable(nullptr, table_name, table_schema);
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  // More entries than the index starts with slots for, so building it resizes the table.
+  for (int32_t i = 0; i < 2000; i++) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetVarcharValue("token-" + std::to_string(i)),
+                                   ValueFactory::GetIntegerValue(i)},
+                &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  Schema key_schema{std::vector<Column>{{"token", TypeId::VARCHAR, 64}}};
+  auto *index_info = catalog->CreateIndex<GenericKey<128>, RID, GenericComparator<128>>(
+      txn.get(), "token_index", table_name, table_schema, key_schema, {0}, 128, HashFunction<GenericKey<128>>{},
+      IndexType::LINEAR_PROBE_HASH);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  auto key = [&](const std::string &token) {
+    return Tuple{std::vector<Value>{ValueFactory::GetVarcharValue(token)}, &key_schema};
+  };
+  for (int32_t i = 0; i < 2100; i++) {
+    std::vector<RID> results{};
+    index_info->index_->ScanKey(key("token-" + std::to_string(i)), &results, txn.get());
+    ASSERT_EQ(i < 2000 ? 1 : 0, results.size()) << i;
+    if (i < 2000) {
+      Tuple tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(results[0], &tuple, txn.get()));
+      EXPECT_EQ(i, tuple.GetValue(&table_schema, 1).GetAs<int32_t>());
+    }
+  }
+
+  // A hash index is not ordered.
+  std::vector<std::pair<Tuple, RID>> entries;
+  EXPECT_THROW(index_info->index_->ScanEntries(key("token-0"), key("token-9"), &entries, txn.get()),
+               NotImplementedException);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager_test.cpp
+//
+// Identification: test/common/epoch_manager_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/epoch_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+std::atomic<int> live_objects{0};
+
+/** An object that counts its live instances and poisons itself on destruction. */
+struct Tracked {
+  Tracked() { live_objects++; }
+  ~Tracked() {
+    magic_ = 0;
+    live_objects--;
+  }
+  int magic_{42};
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(EpochManagerTest, PinDefersReclamationTest) {
+  live_objects = 0;
+  {
+    EpochManager epoch_manager;
+    std::atomic<Tracked *> shared{new Tracked()};
+
+    Tracked *seen;
+    std::thread reader;
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> release{false};
+    reader = std::thread([&] {
+      auto guard = epoch_manager.Pin();
+      seen = shared.load();
+      pinned = true;
+      while (!release) {
+        std::this_thread::yield();
+      }
+      // Still protected: the object must not have been freed under us.
+      EXPECT_EQ(42, seen->magic_);
+    });
+    while (!pinned) {
+      std::this_thread::yield();
+    }
+
+    epoch_manager.Retire(shared.exchange(new Tracked()));
+    for (int i = 0; i < 10; i++) {
+      epoch_manager.Collect();
+    }
+    EXPECT_EQ(2, live_objects);
+    EXPECT_EQ(1, epoch_manager.GetRetiredCount());
+
+    release = true;
+    reader.join();
+    epoch_manager.Synchronize();
+    epoch_manager.Collect();
+    EXPECT_EQ(1, live_objects);
+    EXPECT_EQ(0, epoch_manager.GetRetiredCount());
+
+    // Whatever is still retired when the manager goes away is freed by it.
+    epoch_manager.Retire(shared.exchange(nullptr));
+  }
+  EXPECT_EQ(0, live_objects);
+}
+
+// NOLINTNEXTLINE
+TEST(EpochManagerTest, ConcurrentRetireTest) {
+  live_objects = 0;
+  {
+    EpochManager epoch_manager;
+    std::atomic<Tracked *> shared{new Tracked()};
+    std::atomic<bool> stop{false};
+    const int num_readers = 4;
+    const int num_swaps = 20000;
+
+    std::vector<std::thread> readers;
+    for (int tid = 0; tid < num_readers; tid++) {
+      readers.emplace_back([&] {
+        while (!stop) {
+          auto guard = epoch_manager.Pin();
+          EXPECT_EQ(42, shared.load()->magic_);
+        }
+      });
+    }
+    std::vector<std::thread> writers;
+    for (int tid = 0; tid < 2; tid++) {
+      writers.emplace_back([&] {
+        for (int i = 0; i < num_swaps; i++) {
+          epoch_manager.Retire(shared.exchange(new Tracked()));
+        }
+      });
+    }
+    for (auto &writer : writers) {
+      writer.join();
+    }
+    stop = true;
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    // Reclamation keeps up with retirement instead of deferring everything to the end.
+    EXPECT_LT(epoch_manager.GetRetiredCount(), 2 * num_swaps);
+    epoch_manager.Synchronize();
+    epoch_manager.Collect();
+    EXPECT_EQ(1, live_objects);
+    delete shared.load();
+  }
+  EXPECT_EQ(0, live_objects);
+}
+
+}  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_util_test.cpp
+//
+// Identification: test/common/hash_util_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+// The byte-at-a-time hash that HashUtil::HashBytes used before, for comparison.
+auto LegacyHashBytes(const char *bytes, size_t length) -> hash_t {
+  hash_t hash = length;
+  for (size_t i = 0; i < length; ++i) {
+    hash = ((hash << 5) ^ (hash >> 27)) ^ bytes[i];
+  }
+  return hash;
+}
+
+auto Murmur3Hash(const char *bytes, size_t length) -> hash_t {
+  uint64_t hash[2];
+  murmur3::MurmurHash3_x64_128(bytes, static_cast<int>(length), 0, hash);
+  return hash[0];
+}
+
+// Flipping any input bit flips every output bit with probability close to one half.
+// NOLINTNEXTLINE
+TEST(HashUtilTest, AvalancheTest) {
+  std::mt19937_64 rng(15445);
+  const int samples = 400;
+  for (size_t length : {1, 3, 4, 7, 8, 12, 16, 24, 40, 100}) {
+    std::vector<char> input(length);
+    for (size_t bit = 0; bit < 8 * length; bit++) {
+      std::vector<int> flips(64);
+      for (int sample = 0; sample < samples; sample++) {
+        for (auto &byte : input) {
+          byte = static_cast<char>(rng());
+        }
+        hash_t before = HashUtil::HashBytes(input.data(), length);
+        input[bit / 8] = static_cast<char>(input[bit / 8] ^ (1 << (bit % 8)));
+        hash_t changed = before ^ HashUtil::HashBytes(input.data(), length);
+        for (int out = 0; out < 64; out++) {
+          flips[out] += static_cast<int>((changed >> out) & 1);
+        }
+      }
+      for (int out = 0; out < 64; out++) {
+        // A fair coin stays within [0.3, 0.7] over 400 flips with overwhelming probability.
+        ASSERT_NEAR(0.5, static_cast<double>(flips[out]) / samples, 0.2)
+            << "length " << length << " input bit " << bit << " output bit " << out;
+      }
+    }
+  }
+}
+
+// Sequential keys, the worst case for a weak hash, spread evenly over buckets chosen by the low bits of the hash, as
+// extendible hashing does, and by the high bits, and do not collide.
+// NOLINTNEXTLINE
+TEST(HashUtilTest, DistributionTest) {
+  const int64_t num_keys = 200000;
+  const size_t num_buckets = 1024;
+  HashFunction<int64_t> int_hash;
+  HashFunction<GenericKey<8>> key_hash;
+  HashFunction<GenericKey<64>> wide_key_hash;
+  std::vector<std::vector<hash_t>> hashes(3);
+  for (int64_t i = 0; i < num_keys; i++) {
+    GenericKey<8> key;
+    key.SetFromInteger(i);
+    GenericKey<64> wide_key;
+    wide_key.SetFromInteger(i);
+    hashes[0].push_back(int_hash.GetHash(i));
+    hashes[1].push_back(key_hash.GetHash(key));
+    hashes[2].push_back(wide_key_hash.GetHash(wide_key));
+  }
+  // Chi-square over 1023 degrees of freedom stays below its mean plus six standard deviations.
+  const double bound = (num_buckets - 1) + 6 * std::sqrt(2.0 * (num_buckets - 1));
+  for (const auto &values : hashes) {
+    for (int shift : {0, 54}) {
+      std::vector<double> counts(num_buckets);
+      for (hash_t hash : values) {
+        counts[(hash >> shift) % num_buckets]++;
+      }
+      double expected = static_cast<double>(num_keys) / num_buckets;
+      double chi_square = 0;
+      for (double count : counts) {
+        chi_square += (count - expected) * (count - expected) / expected;
+      }
+      EXPECT_LT(chi_square, bound) << "shift " << shift;
+    }
+    EXPECT_EQ(num_keys, std::unordered_set<hash_t>(values.begin(), values.end()).size());
+  }
+  // Integers hash the same whichever way they get to the hash.
+  int64_t value = -15445;
+  EXPECT_EQ(HashUtil::HashBytes(reinterpret_cast<const char *>(&value), sizeof(value)), int_hash.GetHash(value));
+  EXPECT_EQ(HashUtil::HashBytes(reinterpret_cast<const char *>(&value), sizeof(value)), HashUtil::Hash(&value));
+}
+
+// Compares the throughput of the byte-at-a-time hash, MurmurHash3 and HashUtil::HashBytes over keys of the sizes of
+// GenericKeys and of short strings.
+// NOLINTNEXTLINE
+TEST(HashUtilTest, DISABLED_ThroughputBenchmarkTest) {
+  const size_t num_hashes = 1000000;
+  std::vector<char> buffer(4096);
+  std::mt19937_64 rng(15445);
+  for (auto &byte : buffer) {
+    byte = static_cast<char>(rng());
+  }
+  auto run = [&](const char *name, size_t length, auto hash) {
+    hash_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_hashes; i++) {
+      sum += hash(buffer.data() + (i * 8) % (buffer.size() - length), length);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << " bytes=" << length << " ns_per_hash=" << elapsed * 1e9 / num_hashes << " (" << sum % 10
+              << ")" << std::endl;
+  };
+  for (size_t length : {8, 16, 64, 256}) {
+    run("legacy", length, LegacyHashBytes);
+    run("murmur3", length, Murmur3Hash);
+    run("hash_util", length, HashUtil::HashBytes);
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -20,7 +23,7 @@ namespace bustub {
 
 class Counter {
  public:
-  Counter() = default;
+  explicit Counter(bool prefer_writers = true) : mutex_(prefer_writers) {}
   void Add(int num) {
     mutex_.WLock();
     count_ += num;
@@ -36,7 +39,7 @@ class Counter {
 
  private:
   int count_{0};
-  ReaderWriterLatch mutex_{};
+  ReaderWriterLatch mutex_;
 };
 
 // NOLINTNEXTLINE
@@ -57,4 +60,94 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, ReaderPreferenceTest) {
+  int num_threads = 100;
+  Counter counter{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&counter, tid]() {
+      for (int i = 0; i < 100; i++) {
+        if (tid % 2 == 0) {
+          counter.Read();
+        } else {
+          counter.Add(1);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter.Read(), 5000);
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, WriterPreferenceTest) {
+  for (bool prefer_writers : {true, false}) {
+    ReaderWriterLatch latch{prefer_writers};
+    latch.RLock();
+    std::atomic<bool> writer_done{false};
+    std::thread writer([&] {
+      latch.WLock();
+      writer_done = true;
+      latch.WUnlock();
+    });
+    // Give the writer time to start waiting behind our read latch.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(writer_done);
+    EXPECT_FALSE(latch.TryWLock());
+
+    // A waiting writer only keeps new readers out with writer preference.
+    bool admitted = latch.TryRLock();
+    EXPECT_EQ(!prefer_writers, admitted);
+    if (admitted) {
+      latch.RUnlock();
+    }
+    latch.RUnlock();
+    writer.join();
+    EXPECT_TRUE(writer_done);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, ParkTest) {
+  ReaderWriterLatch latch;
+  latch.WLock();
+  // Hold the write latch long enough for everybody to give up spinning and park.
+  std::atomic<int> readers{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 8; tid++) {
+    threads.emplace_back([&] {
+      latch.RLock();
+      readers++;
+      latch.RUnlock();
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(0, readers);
+  latch.WUnlock();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(8, readers);
+  EXPECT_TRUE(latch.TryWLock());
+  latch.WUnlock();
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, DISABLED_UncontendedReadBenchmark) {
+  const int iterations = 1000000;
+  ReaderWriterLatch latch;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    latch.RLock();
+    latch.RUnlock();
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "RLock+RUnlock ns/op=" << elapsed / iterations << std::endl;
+  EXPECT_TRUE(latch.TryWLock());
+  latch.WUnlock();
+}
 }  // namespace bustub
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_range_lock_test.cpp
+//
+// Identification: test/concurrency/key_range_lock_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class KeyRangeLockTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    disk_manager_ = std::make_unique<DiskManager>("key_range_lock_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(50, disk_manager_.get());
+    page_id_t header_page_id;
+    bpm_->NewPage(&header_page_id);
+    schema_ = std::make_unique<Schema>(std::vector<Column>{Column("a", TypeId::BIGINT)});
+    auto metadata = std::make_unique<IndexMetadata>("a_idx", "t", schema_.get(), std::vector<uint32_t>{0});
+    index_ = std::make_unique<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(std::move(metadata),
+                                                                                         bpm_.get(), &lock_mgr_);
+    auto *txn = txn_mgr_.Begin();
+    for (int64_t key : {5, 10, 15, 20, 25}) {
+      index_->InsertEntry(Key(key), RID(0, key), txn);
+    }
+    txn_mgr_.Commit(txn);
+    delete txn;
+  }
+
+  void TearDown() override {
+    bpm_->UnpinPage(HEADER_PAGE_ID, true);
+    remove("key_range_lock_test.db");
+    remove("key_range_lock_test.log");
+  }
+
+  auto Key(int64_t key) -> Tuple { return Tuple({ValueFactory::GetBigIntValue(key)}, schema_.get()); }
+
+  auto Scan(int64_t low, int64_t high, Transaction *txn) -> std::vector<uint32_t> {
+    std::vector<RID> rids;
+    index_->ScanRange(Key(low), Key(high), &rids, txn);
+    std::vector<uint32_t> slots;
+    for (auto &rid : rids) {
+      slots.push_back(rid.GetSlotNum());
+    }
+    return slots;
+  }
+
+  /** Inserts key in a younger transaction on another thread, which is still running when this returns. */
+  auto StartInsert(int64_t key, std::atomic<bool> *done) -> std::thread {
+    auto *txn = txn_mgr_.Begin();
+    return std::thread([this, key, done, txn] {
+      index_->InsertEntry(Key(key), RID(0, key), txn);
+      *done = true;
+      txn_mgr_.Commit(txn);
+      delete txn;
+    });
+  }
+
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManagerInstance> bpm_;
+  std::unique_ptr<Schema> schema_;
+  LockManager lock_mgr_;
+  TransactionManager txn_mgr_{&lock_mgr_};
+  std::unique_ptr<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>> index_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(KeyRangeLockTest, ScanBlocksPhantomInsertTest) {
+  auto *scanner = txn_mgr_.Begin();
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 20}), Scan(10, 20, scanner));
+
+  std::atomic<bool> inserted{false};
+  auto writer = StartInsert(17, &inserted);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(inserted);
+  // Repeating the scan sees no phantom.
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 20}), Scan(10, 20, scanner));
+
+  txn_mgr_.Commit(scanner);
+  delete scanner;
+  writer.join();
+  EXPECT_TRUE(inserted);
+
+  auto *reader = txn_mgr_.Begin();
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 17, 20}), Scan(10, 20, reader));
+  txn_mgr_.Commit(reader);
+  delete reader;
+}
+
+// NOLINTNEXTLINE
+TEST_F(KeyRangeLockTest, InsertOutsideRangeTest) {
+  auto *scanner = txn_mgr_.Begin();
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 20}), Scan(10, 20, scanner));
+
+  // Neither gap is covered by the scan: the successor of 3 is 5, the successor of 30 is the supremum.
+  for (int64_t key : {3, 30}) {
+    std::atomic<bool> inserted{false};
+    auto writer = StartInsert(key, &inserted);
+    writer.join();
+    EXPECT_TRUE(inserted);
+  }
+
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 20}), Scan(10, 20, scanner));
+  txn_mgr_.Commit(scanner);
+  delete scanner;
+}
+
+// NOLINTNEXTLINE
+TEST_F(KeyRangeLockTest, ScanAboveLargestKeyTest) {
+  auto *scanner = txn_mgr_.Begin();
+  EXPECT_TRUE(Scan(40, 50, scanner).empty());
+
+  // The empty range above the largest key is guarded by the supremum.
+  std::atomic<bool> inserted{false};
+  auto writer = StartInsert(45, &inserted);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(inserted);
+  EXPECT_TRUE(Scan(40, 50, scanner).empty());
+
+  txn_mgr_.Commit(scanner);
+  delete scanner;
+  writer.join();
+  EXPECT_TRUE(inserted);
+}
+
+// NOLINTNEXTLINE
+TEST_F(KeyRangeLockTest, DeleteInRangeTest) {
+  auto *scanner = txn_mgr_.Begin();
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 20}), Scan(10, 20, scanner));
+
+  auto *deleter = txn_mgr_.Begin();
+  std::atomic<bool> deleted{false};
+  std::thread writer([&] {
+    index_->DeleteEntry(Key(15), RID(0, 15), deleter);
+    deleted = true;
+    txn_mgr_.Commit(deleter);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(deleted);
+  EXPECT_EQ((std::vector<uint32_t>{10, 15, 20}), Scan(10, 20, scanner));
+
+  txn_mgr_.Commit(scanner);
+  delete scanner;
+  writer.join();
+  delete deleter;
+  EXPECT_TRUE(deleted);
+}
+
+}  // namespace bustub
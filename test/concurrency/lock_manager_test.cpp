@@ -2,6 +2,7 @@
  * lock_manager_test.cpp
  */
 
+#include <chrono>  // NOLINT
 #include <random>
 #include <thread>  // NOLINT
 
@@ -77,7 +78,7 @@ void BasicTest1() {
     delete txns[i];
   }
 }
-TEST(LockManagerTest, DISABLED_BasicTest) { BasicTest1(); }
+TEST(LockManagerTest, BasicTest) { BasicTest1(); }
 
 void TwoPLTest() {
   LockManager lock_mgr{};
@@ -123,7 +124,7 @@ void TwoPLTest() {
 
   delete txn;
 }
-TEST(LockManagerTest, DISABLED_TwoPLTest) { TwoPLTest(); }
+TEST(LockManagerTest, TwoPLTest) { TwoPLTest(); }
 
 void UpgradeTest() {
   LockManager lock_mgr{};
@@ -150,7 +151,7 @@ void UpgradeTest() {
   txn_mgr.Commit(&txn);
   CheckCommitted(&txn);
 }
-TEST(LockManagerTest, DISABLED_UpgradeLockTest) { UpgradeTest(); }
+TEST(LockManagerTest, UpgradeLockTest) { UpgradeTest(); }
 
 void WoundWaitBasicTest() {
   LockManager lock_mgr{};
@@ -202,6 +203,91 @@ void WoundWaitBasicTest() {
   txn_mgr.Commit(&txn_hold);
   CheckCommitted(&txn_hold);
 }
-TEST(LockManagerTest, DISABLED_WoundWaitBasicTest) { WoundWaitBasicTest(); }
+TEST(LockManagerTest, WoundWaitBasicTest) { WoundWaitBasicTest(); }
+
+void ContentionStatisticsTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID hot{0, 0};
+  RID cold{0, 1};
+
+  // The older transaction holds the hot row while a younger one waits for it.
+  auto *holder = txn_mgr.Begin();
+  auto *waiter = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockExclusive(holder, hot));
+  EXPECT_TRUE(lock_mgr.LockShared(holder, cold));
+  std::thread wait_thread([&] {
+    EXPECT_TRUE(lock_mgr.LockShared(waiter, hot));
+    EXPECT_TRUE(lock_mgr.LockShared(waiter, cold));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // The wait in progress shows up before it is counted.
+  auto snapshot = lock_mgr.GetContentionSnapshot(10);
+  ASSERT_EQ(snapshot.size(), 1);
+  EXPECT_EQ(snapshot[0].rid_, hot);
+  EXPECT_EQ(snapshot[0].wait_count_, 0);
+  EXPECT_EQ(snapshot[0].holders_, std::vector<txn_id_t>{holder->GetTransactionId()});
+  EXPECT_EQ(snapshot[0].waiters_, std::vector<txn_id_t>{waiter->GetTransactionId()});
+
+  txn_mgr.Commit(holder);
+  wait_thread.join();
+  snapshot = lock_mgr.GetContentionSnapshot(10);
+  ASSERT_EQ(snapshot.size(), 1);
+  EXPECT_EQ(snapshot[0].rid_, hot);
+  EXPECT_EQ(snapshot[0].wait_count_, 1);
+  EXPECT_GE(snapshot[0].total_wait_us_, 50000);
+  EXPECT_EQ(snapshot[0].max_wait_us_, snapshot[0].total_wait_us_);
+  EXPECT_EQ(snapshot[0].holders_, std::vector<txn_id_t>{waiter->GetTransactionId()});
+  EXPECT_TRUE(snapshot[0].waiters_.empty());
+
+  // Every granted request is recorded, the one that waited lands in a slow bucket.
+  auto shared = lock_mgr.GetLatencyHistogram(LockManager::LockOperation::SHARED);
+  EXPECT_EQ(shared.GetCount(), 3);
+  EXPECT_GE(shared.GetPercentile(100), 50000);
+  EXPECT_EQ(lock_mgr.GetLatencyHistogram(LockManager::LockOperation::EXCLUSIVE).GetCount(), 1);
+  EXPECT_EQ(lock_mgr.GetLatencyHistogram(LockManager::LockOperation::UPGRADE).GetCount(), 0);
+
+  txn_mgr.Commit(waiter);
+  lock_mgr.ResetStatistics();
+  EXPECT_TRUE(lock_mgr.GetContentionSnapshot(10).empty());
+  EXPECT_EQ(lock_mgr.GetLatencyHistogram(LockManager::LockOperation::SHARED).GetCount(), 0);
+  delete holder;
+  delete waiter;
+}
+TEST(LockManagerTest, ContentionStatisticsTest) { ContentionStatisticsTest(); }
+
+void UpgradeConflictStatisticsTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  RID rid{0, 0};
+
+  // The younger transaction starts upgrading and waits for the older one's shared lock.
+  auto *older = txn_mgr.Begin();
+  auto *younger = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockShared(older, rid));
+  EXPECT_TRUE(lock_mgr.LockShared(younger, rid));
+  std::thread upgrade_thread([&] {
+    try {
+      lock_mgr.LockUpgrade(younger, rid);
+    } catch (TransactionAbortException &e) {
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // A second upgrade of the same lock conflicts.
+  EXPECT_THROW(lock_mgr.LockUpgrade(older, rid), TransactionAbortException);
+  txn_mgr.Abort(older);
+  upgrade_thread.join();
+  txn_mgr.Commit(younger);
+
+  auto snapshot = lock_mgr.GetContentionSnapshot(1);
+  ASSERT_EQ(snapshot.size(), 1);
+  EXPECT_EQ(snapshot[0].upgrade_conflicts_, 1);
+  EXPECT_EQ(snapshot[0].wait_count_, 1);
+  delete older;
+  delete younger;
+}
+TEST(LockManagerTest, UpgradeConflictStatisticsTest) { UpgradeConflictStatisticsTest(); }
 
 }  // namespace bustub
@@ -0,0 +1,363 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimistic_transaction_test.cpp
+//
+// Identification: test/concurrency/optimistic_transaction_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class OptimisticTransactionTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    ::testing::Test::SetUp();
+    disk_manager_ = std::make_unique<DiskManager>("optimistic_transaction_test.db");
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(64, disk_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get());
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), lock_manager_.get(), nullptr);
+    schema_ = std::make_unique<Schema>(std::vector<Column>{{"id", TypeId::INTEGER}, {"value", TypeId::INTEGER}});
+  }
+
+  void TearDown() override {
+    disk_manager_->ShutDown();
+    remove("optimistic_transaction_test.db");
+  }
+
+  /** Creates a table of num_rows counters, all zero, and returns their RIDs. */
+  auto CreateCounters(const std::string &name, int num_rows) -> std::vector<RID> {
+    auto *txn = txn_mgr_->Begin();
+    table_ = catalog_->CreateTable(txn, name, *schema_)->table_.get();
+    std::vector<RID> rids(num_rows);
+    for (int i = 0; i < num_rows; i++) {
+      EXPECT_TRUE(table_->InsertTuple(MakeCounter(i, 0), &rids[i], txn));
+    }
+    txn_mgr_->Commit(txn);
+    delete txn;
+    return rids;
+  }
+
+  auto MakeCounter(int id, int value) -> Tuple {
+    return Tuple{{ValueFactory::GetIntegerValue(id), ValueFactory::GetIntegerValue(value)}, schema_.get()};
+  }
+
+  auto CounterValue(const Tuple &tuple) -> int { return tuple.GetValue(schema_.get(), 1).GetAs<int32_t>(); }
+
+  auto ReadCommitted(const RID &rid) -> int {
+    auto *txn = txn_mgr_->Begin();
+    Tuple tuple;
+    EXPECT_TRUE(table_->GetTuple(rid, &tuple, txn));
+    txn_mgr_->Commit(txn);
+    delete txn;
+    return CounterValue(tuple);
+  }
+
+  /** Increments the counters at the given RIDs under 2PL, retrying until it commits. @return number of aborts */
+  auto IncrementTwoPhaseLocking(const std::vector<RID> &rids) -> int {
+    for (int aborts = 0;; aborts++) {
+      auto *txn = txn_mgr_->Begin();
+      try {
+        for (const auto &rid : rids) {
+          Tuple tuple;
+          if (!lock_manager_->LockExclusive(txn, rid) || !table_->GetTuple(rid, &tuple, txn)) {
+            break;
+          }
+          auto id = tuple.GetValue(schema_.get(), 0).GetAs<int32_t>();
+          table_->UpdateTuple(MakeCounter(id, CounterValue(tuple) + 1), rid, txn);
+        }
+      } catch (TransactionAbortException &e) {
+      }
+      // We may also have been wounded while holding our locks.
+      if (txn->GetState() != TransactionState::ABORTED) {
+        txn_mgr_->Commit(txn);
+        delete txn;
+        return aborts;
+      }
+      txn_mgr_->Abort(txn);
+      delete txn;
+    }
+  }
+
+  /** Increments the counters at the given RIDs optimistically, retrying until it commits. @return number of aborts */
+  auto IncrementOptimistic(const std::vector<RID> &rids) -> int {
+    for (int aborts = 0;; aborts++) {
+      auto *txn = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+      for (const auto &rid : rids) {
+        Tuple tuple;
+        EXPECT_TRUE(table_->GetTuple(rid, &tuple, txn));
+        auto id = tuple.GetValue(schema_.get(), 0).GetAs<int32_t>();
+        EXPECT_TRUE(table_->UpdateTuple(MakeCounter(id, CounterValue(tuple) + 1), rid, txn));
+      }
+      try {
+        txn_mgr_->Commit(txn);
+        delete txn;
+        return aborts;
+      } catch (TransactionAbortException &e) {
+        EXPECT_EQ(e.GetAbortReason(), AbortReason::VALIDATION_FAILED);
+        EXPECT_EQ(txn->GetState(), TransactionState::ABORTED);
+        delete txn;
+      }
+    }
+  }
+
+  /**
+   * Runs num_threads workers that each commit txns_per_thread transactions incrementing two random counters out of
+   * num_rows, and reports throughput and aborts. Fewer rows means higher contention.
+   *
+   * The workload stands in for the executor tests: the sequential scan and update executors are still stubs, so the
+   * workers make the TableHeap::GetTuple and TableHeap::UpdateTuple calls that those executors would make.
+   */
+  void RunContention(ConcurrencyMode mode, int num_rows, int num_threads, int txns_per_thread) {
+    auto rids = CreateCounters((mode == ConcurrencyMode::OPTIMISTIC ? "occ_" : "2pl_") + std::to_string(num_rows),
+                               num_rows);
+    std::atomic<int> total_aborts{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&, tid] {
+        std::mt19937 gen(tid);
+        std::uniform_int_distribution<int> dist(0, num_rows - 1);
+        for (int i = 0; i < txns_per_thread; i++) {
+          auto first = dist(gen);
+          auto second = (first + 1 + dist(gen) % (num_rows - 1)) % num_rows;
+          std::vector<RID> targets{rids[first], rids[second]};
+          total_aborts += mode == ConcurrencyMode::OPTIMISTIC ? IncrementOptimistic(targets)
+                                                              : IncrementTwoPhaseLocking(targets);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int total = 0;
+    for (const auto &rid : rids) {
+      total += ReadCommitted(rid);
+    }
+    EXPECT_EQ(total, 2 * num_threads * txns_per_thread);
+    std::cout << (mode == ConcurrencyMode::OPTIMISTIC ? "OCC" : "2PL") << " rows=" << num_rows
+              << " txns/s=" << num_threads * txns_per_thread / elapsed << " aborts=" << total_aborts << std::endl;
+  }
+
+ protected:
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Catalog> catalog_;
+  std::unique_ptr<Schema> schema_;
+  TableHeap *table_{nullptr};
+};
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, BufferedWritesTest) {
+  auto rids = CreateCounters("counters", 1);
+
+  auto *txn = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  Tuple tuple;
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, txn));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 42), rids[0], txn));
+
+  // Our own write is visible to us, but nobody else sees it before commit.
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, txn));
+  EXPECT_EQ(42, CounterValue(tuple));
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+
+  txn_mgr_->Abort(txn);
+  delete txn;
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+
+  txn = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 42), rids[0], txn));
+  txn_mgr_->Commit(txn);
+  EXPECT_EQ(TransactionState::COMMITTED, txn->GetState());
+  delete txn;
+  EXPECT_EQ(42, ReadCommitted(rids[0]));
+}
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, ValidationTest) {
+  auto rids = CreateCounters("counters", 2);
+
+  auto *txn1 = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  auto *txn2 = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  Tuple tuple;
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, txn1));
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, txn2));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 1), rids[0], txn1));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 2), rids[0], txn2));
+
+  // First committer wins, the second one read a stale version.
+  txn_mgr_->Commit(txn1);
+  EXPECT_EQ(TransactionState::COMMITTED, txn1->GetState());
+  EXPECT_THROW(txn_mgr_->Commit(txn2), TransactionAbortException);
+  EXPECT_EQ(TransactionState::ABORTED, txn2->GetState());
+  EXPECT_EQ(1, ReadCommitted(rids[0]));
+  delete txn1;
+  delete txn2;
+
+  // Disjoint read sets do not conflict.
+  txn1 = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  txn2 = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, txn1));
+  ASSERT_TRUE(table_->GetTuple(rids[1], &tuple, txn2));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 5), rids[0], txn1));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(1, 6), rids[1], txn2));
+  txn_mgr_->Commit(txn2);
+  txn_mgr_->Commit(txn1);
+  EXPECT_EQ(5, ReadCommitted(rids[0]));
+  EXPECT_EQ(6, ReadCommitted(rids[1]));
+  delete txn1;
+  delete txn2;
+}
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, FailedWritePhaseTest) {
+  auto rids = CreateCounters("counters", 2);
+
+  // A committed 2PL transaction deletes the second counter.
+  auto *deleter = txn_mgr_->Begin();
+  ASSERT_TRUE(table_->MarkDelete(rids[1], deleter));
+  txn_mgr_->Commit(deleter);
+  delete deleter;
+
+  // The first write applies, the blind write to the deleted counter fails, and the first one is undone.
+  auto *reader = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  Tuple tuple;
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, reader));
+  auto *txn = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 7), rids[0], txn));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(1, 8), rids[1], txn));
+  EXPECT_THROW(txn_mgr_->Commit(txn), TransactionAbortException);
+  EXPECT_EQ(TransactionState::ABORTED, txn->GetState());
+  delete txn;
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+
+  // The counter holds its old value again, but under a new version.
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 1), rids[0], reader));
+  EXPECT_THROW(txn_mgr_->Commit(reader), TransactionAbortException);
+  delete reader;
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+}
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, AbortTest) {
+  auto rids = CreateCounters("counters", 1);
+
+  // The insert is applied at once, the update is only buffered; the abort undoes both.
+  auto *txn = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  RID inserted;
+  ASSERT_TRUE(table_->InsertTuple(MakeCounter(1, 9), &inserted, txn));
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 3), rids[0], txn));
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+  txn_mgr_->Abort(txn);
+  delete txn;
+
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+  txn = txn_mgr_->Begin();
+  Tuple tuple;
+  EXPECT_FALSE(table_->GetTuple(inserted, &tuple, txn));
+  txn_mgr_->Commit(txn);
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, TableScanTest) {
+  auto rids = CreateCounters("counters", 3);
+
+  // A scan reads every tuple through TableHeap::GetTuple, seeing our buffered update and recording each version.
+  auto *reader = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 4), rids[0], reader));
+  int total = 0;
+  for (auto it = table_->Begin(reader); it != table_->End(); ++it) {
+    total += CounterValue(*it);
+  }
+  EXPECT_EQ(4, total);
+  // The tuple we updated was read from the buffer and needs no version.
+  EXPECT_EQ(2U, reader->GetReadSet()->size());
+
+  // A conflicting commit to a tuple that was scanned fails the reader.
+  auto *writer = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(2, 5), rids[2], writer));
+  txn_mgr_->Commit(writer);
+  delete writer;
+  try {
+    txn_mgr_->Commit(reader);
+    FAIL() << "the scan read a stale version";
+  } catch (TransactionAbortException &e) {
+    EXPECT_EQ(AbortReason::VALIDATION_FAILED, e.GetAbortReason());
+  }
+  EXPECT_EQ(TransactionState::ABORTED, reader->GetState());
+  delete reader;
+  EXPECT_EQ(0, ReadCommitted(rids[0]));
+  EXPECT_EQ(5, ReadCommitted(rids[2]));
+}
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, VersionPruningTest) {
+  auto rids = CreateCounters("counters", 1);
+  auto &versions = TransactionManager::version_table;
+
+  // The reader began before the write, so the version it must fail against is kept while it runs.
+  auto *reader = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  Tuple tuple;
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, reader));
+  auto *writer = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 1), rids[0], writer));
+  txn_mgr_->Commit(writer);
+  delete writer;
+  EXPECT_NE(0, versions.Get(rids[0]));
+
+  // Once no running transaction predates the write, its version is dropped.
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 2), rids[0], reader));
+  EXPECT_THROW(txn_mgr_->Commit(reader), TransactionAbortException);
+  delete reader;
+  EXPECT_EQ(0, versions.Get(rids[0]));
+  EXPECT_EQ(0U, versions.Size());
+
+  // A tuple whose version was dropped still fails the readers that overlap its next write.
+  reader = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->GetTuple(rids[0], &tuple, reader));
+  EXPECT_EQ(1, CounterValue(tuple));
+  writer = txn_mgr_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyMode::OPTIMISTIC);
+  ASSERT_TRUE(table_->UpdateTuple(MakeCounter(0, 3), rids[0], writer));
+  txn_mgr_->Commit(writer);
+  delete writer;
+  EXPECT_THROW(txn_mgr_->Commit(reader), TransactionAbortException);
+  delete reader;
+  EXPECT_EQ(3, ReadCommitted(rids[0]));
+  EXPECT_EQ(0U, versions.Size());
+}
+
+// NOLINTNEXTLINE
+TEST_F(OptimisticTransactionTest, DISABLED_ContentionBenchmark) {
+  const int num_threads = 4;
+  const int txns_per_thread = 200;
+  for (int num_rows : {4, 1024}) {
+    RunContention(ConcurrencyMode::TWO_PHASE_LOCKING, num_rows, num_threads, txns_per_thread);
+    RunContention(ConcurrencyMode::OPTIMISTIC, num_rows, num_threads, txns_per_thread);
+  }
+}
+
+}  // namespace bustub
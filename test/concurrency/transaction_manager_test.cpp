@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// transaction_manager_test.cpp
+//
+// Identification: test/concurrency/transaction_manager_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TransactionManagerTest, TransactionMapTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  std::vector<Transaction *> txns;
+  for (int i = 0; i < 200; i++) {
+    txns.push_back(txn_mgr.Begin());
+  }
+  for (auto *txn : txns) {
+    EXPECT_EQ(txn, TransactionManager::GetTransaction(txn->GetTransactionId()));
+    txn_mgr.Commit(txn);
+    // Finished transactions are unregistered, so a lookup cannot hand out a transaction its owner may delete.
+    EXPECT_EQ(nullptr, TransactionManager::txn_map.Find(txn->GetTransactionId()));
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TransactionManagerTest, CheckpointBlockTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+
+  // A checkpoint waits for running transactions to finish.
+  auto *running = txn_mgr.Begin();
+  std::atomic<bool> blocked{false};
+  std::thread checkpoint([&] {
+    txn_mgr.BlockAllTransactions();
+    blocked = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(blocked);
+  txn_mgr.Commit(running);
+  delete running;
+  checkpoint.join();
+  EXPECT_TRUE(blocked);
+
+  // New transactions wait for the checkpoint to finish.
+  std::atomic<bool> begun{false};
+  std::thread worker([&] {
+    auto *txn = txn_mgr.Begin();
+    begun = true;
+    txn_mgr.Commit(txn);
+    delete txn;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(begun);
+  txn_mgr.ResumeTransactions();
+  worker.join();
+  EXPECT_TRUE(begun);
+}
+
+// NOLINTNEXTLINE
+TEST(TransactionManagerTest, ConcurrentBeginCommitTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  const int num_threads = 8;
+  const int txns_per_thread = 5000;
+  std::atomic<bool> stop{false};
+  std::atomic<int> checkpoints{0};
+
+  // Checkpoint repeatedly while the workers run, to exercise the block/resume handshake under load.
+  std::thread checkpointer([&] {
+    while (!stop) {
+      txn_mgr.BlockAllTransactions();
+      checkpoints++;
+      txn_mgr.ResumeTransactions();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < txns_per_thread; i++) {
+        auto *txn = txn_mgr.Begin();
+        EXPECT_EQ(txn, TransactionManager::GetTransaction(txn->GetTransactionId()));
+        txn_mgr.Commit(txn);
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stop = true;
+  checkpointer.join();
+  EXPECT_GT(checkpoints, 0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/container/bloom_filter_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/bloom_filter.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+// The filter grows from a small first generation to many times its size without false negatives, and the false
+// positive rates of its generations add up to a few percent.
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, GrowthTest) {
+  BloomFilter filter(64);
+  HashFunction<int64_t> hash_fn;
+  const int64_t num_keys = 100000;
+  for (int64_t i = 0; i < num_keys; i++) {
+    filter.Insert(hash_fn.GetHash(i));
+  }
+  EXPECT_LT(10, filter.NumGenerations());
+  for (int64_t i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(filter.MayContain(hash_fn.GetHash(i))) << i;
+  }
+  int64_t false_positives = 0;
+  for (int64_t i = num_keys; i < 2 * num_keys; i++) {
+    false_positives += filter.MayContain(hash_fn.GetHash(i)) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, num_keys / 25);
+}
+
+// Keys are never lost while threads insert and look up at the same time as the filter grows.
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, ConcurrentTest) {
+  BloomFilter filter(16);
+  HashFunction<int64_t> hash_fn;
+  const int num_threads = 4;
+  const int64_t keys_per_thread = 20000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&filter, &hash_fn, t] {
+      HashFunction<int64_t> thread_hash_fn = hash_fn;
+      for (int64_t i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        filter.Insert(thread_hash_fn.GetHash(i));
+        EXPECT_TRUE(filter.MayContain(thread_hash_fn.GetHash(i)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int64_t i = 0; i < num_threads * keys_per_thread; i++) {
+    ASSERT_TRUE(filter.MayContain(hash_fn.GetHash(i))) << i;
+  }
+}
+
+// An extendible hash table with a Bloom filter finds every key it holds, also after splits and removals, and finds
+// none of the keys it never held, with a buffer pool smaller than the table.
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, ExtendibleHashTableTest) {
+  const int64_t num_keys = 40000;
+  for (bool bloom_filter : {false, true}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(32, disk_manager);
+    ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("foo_pk", bpm, GenericComparator<8>(nullptr),
+                                                                      HashFunction<GenericKey<8>>(), bloom_filter);
+    GenericKey<8> key;
+    for (int64_t i = 0; i < num_keys; i++) {
+      key.SetFromInteger(i);
+      ASSERT_TRUE(ht.Insert(nullptr, key, RID(i, 0)));
+    }
+    for (int64_t i = 0; i < num_keys; i += 2) {
+      key.SetFromInteger(i);
+      ASSERT_TRUE(ht.Remove(nullptr, key, RID(i, 0)));
+    }
+    ht.VerifyIntegrity();
+    for (int64_t i = 0; i < num_keys; i++) {
+      std::vector<RID> result;
+      key.SetFromInteger(i);
+      ASSERT_EQ(i % 2 == 1, ht.GetValue(nullptr, key, &result)) << i;
+    }
+
+    size_t found = 0;
+    for (int64_t i = num_keys; i < 2 * num_keys; i++) {
+      std::vector<RID> result;
+      key.SetFromInteger(i);
+      found += ht.GetValue(nullptr, key, &result) ? 1 : 0;
+    }
+    EXPECT_EQ(0, found);
+
+    disk_manager->ShutDown();
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cuckoo_hash_table_test.cpp
+//
+// Identification: test/container/cuckoo_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/cuckoo_hash_table.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+using CuckooTable = CuckooHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** Counts the pages that are fetched from it. */
+class CountingBufferPoolManager : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+  size_t fetches_{0};
+
+ protected:
+  auto FetchPgImp(page_id_t page_id) -> Page * override {
+    fetches_++;
+    return BufferPoolManagerInstance::FetchPgImp(page_id);
+  }
+};
+
+auto CuckooKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+// NOLINTNEXTLINE
+TEST(CuckooHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  CuckooHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+  }
+  // duplicate values for the same key are not allowed
+  EXPECT_FALSE(ht.Insert(nullptr, 3, 3));
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ((std::vector<int>{i, 2 * i + 1}), res);
+  }
+  EXPECT_TRUE(ht.Remove(nullptr, 2, 2));
+  EXPECT_FALSE(ht.Remove(nullptr, 2, 2));
+  EXPECT_FALSE(ht.Remove(nullptr, 7, 7));
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 2, &res));
+  EXPECT_EQ(std::vector<int>{5}, res);
+  EXPECT_EQ(2, ht.GetNumBuckets());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// A table that starts with two buckets grows to hold many keys, some with several values, while every lookup reads
+// the header page and at most two bucket pages.
+// NOLINTNEXTLINE
+TEST(CuckooHashTableTest, GrowthTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  // A small pool makes a leaked pin fail the test.
+  auto *bpm = new CountingBufferPoolManager(16, disk_manager);
+  CuckooTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), HashFunction<GenericKey<8>>());
+
+  const int64_t key_range = 30000;
+  auto inserted_values = [](int64_t key) -> int64_t { return key % 10 == 0 ? 3 : 1; };
+  int64_t num_pairs = 0;
+  for (int64_t key = 0; key < key_range; key++) {
+    for (int64_t value = 0; value < inserted_values(key); value++) {
+      ASSERT_TRUE(ht.Insert(nullptr, CuckooKey(key), RID(key, value))) << key;
+      num_pairs++;
+    }
+    ASSERT_FALSE(ht.Insert(nullptr, CuckooKey(key), RID(key, 0)));
+  }
+  // Cuckoo hashing fills most of the slots before the table doubles.
+  double load = static_cast<double>(num_pairs) / (ht.GetNumBuckets() * 236);
+  std::cout << "pairs=" << num_pairs << " buckets=" << ht.GetNumBuckets() << " load=" << load << std::endl;
+
+  auto check = [&](auto values) {
+    for (int64_t key = 0; key < key_range + 1000; key++) {
+      std::vector<RID> result;
+      size_t fetches = bpm->fetches_;
+      ASSERT_EQ(values(key) > 0, ht.GetValue(nullptr, CuckooKey(key), &result)) << key;
+      EXPECT_LE(bpm->fetches_ - fetches, 3);
+      std::sort(result.begin(), result.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+      ASSERT_EQ(values(key), result.size()) << key;
+      for (int64_t value = 0; value < values(key); value++) {
+        EXPECT_EQ(RID(key, value), result[value]);
+      }
+    }
+  };
+  check([&](int64_t key) { return key < key_range ? inserted_values(key) : 0; });
+
+  // Every other key loses its last value.
+  for (int64_t key = 0; key < key_range; key += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, CuckooKey(key), RID(key, inserted_values(key) - 1)));
+    ASSERT_FALSE(ht.Remove(nullptr, CuckooKey(key), RID(key, inserted_values(key) - 1)));
+  }
+  check([&](int64_t key) { return key < key_range ? inserted_values(key) - (key % 2 == 0 ? 1 : 0) : 0; });
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Lookups of keys that stay in the table run while other threads insert and remove keys and grow the table.
+// NOLINTNEXTLINE
+TEST(CuckooHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  CuckooTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), HashFunction<GenericKey<8>>());
+
+  // Multiples of 4 stay in the table, the other keys come and go.
+  const int64_t key_range = 20000;
+  for (int64_t key = 0; key < key_range; key += 4) {
+    ASSERT_TRUE(ht.Insert(nullptr, CuckooKey(key), RID(key, 0)));
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int64_t key = 1 + t; key < key_range; key += 4) {
+        EXPECT_TRUE(ht.Insert(nullptr, CuckooKey(key), RID(key, 0)));
+      }
+      for (int64_t key = 1 + t; key < key_range; key += 8) {
+        EXPECT_TRUE(ht.Remove(nullptr, CuckooKey(key), RID(key, 0)));
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = 4 * t; key < key_range; key += 8) {
+          std::vector<RID> result;
+          EXPECT_TRUE(ht.GetValue(nullptr, CuckooKey(key), &result)) << key;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int64_t key = 0; key < key_range; key++) {
+    std::vector<RID> result;
+    EXPECT_EQ(key % 4 == 0 || (key % 4 != 3 && key % 8 >= 4), ht.GetValue(nullptr, CuckooKey(key), &result)) << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Inserts the same random keys into a cuckoo and an extendible hash table, then looks up present and absent keys in
+// both, with a buffer pool that holds a small part of either table.
+// NOLINTNEXTLINE
+TEST(CuckooHashTableTest, DISABLED_ExtendibleHashBenchmarkTest) {
+  const int64_t num_keys = 50000;
+  std::vector<int64_t> keys(num_keys);
+  std::mt19937_64 rng(15445);
+  for (auto &key : keys) {
+    key = static_cast<int64_t>(rng() >> 1);
+  }
+  std::vector<int64_t> lookups(2 * num_keys);
+  for (size_t i = 0; i < lookups.size(); i++) {
+    // Every other lookup is for a key that was never inserted.
+    lookups[i] = i % 2 == 0 ? keys[rng() % num_keys] : static_cast<int64_t>(rng() >> 1);
+  }
+
+  auto run = [&](const char *name, auto *ht, CountingBufferPoolManager *bpm) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key : keys) {
+      ht->Insert(nullptr, CuckooKey(key), RID(key >> 32, key & 0xffffffff));
+    }
+    auto inserted = std::chrono::steady_clock::now();
+    size_t fetches = bpm->fetches_;
+    size_t found = 0;
+    for (int64_t key : lookups) {
+      std::vector<RID> result;
+      found += ht->GetValue(nullptr, CuckooKey(key), &result) ? 1 : 0;
+    }
+    auto looked_up = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_keys, found);
+    std::cout << name << " inserts=" << num_keys
+              << " insert_seconds=" << std::chrono::duration<double>(inserted - start).count()
+              << " lookups=" << lookups.size()
+              << " lookup_seconds=" << std::chrono::duration<double>(looked_up - inserted).count()
+              << " fetches_per_lookup=" << static_cast<double>(bpm->fetches_ - fetches) / lookups.size() << std::endl;
+  };
+
+  {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new CountingBufferPoolManager(64, disk_manager);
+    CuckooTable ht("cuckoo", bpm, GenericComparator<8>(nullptr), HashFunction<GenericKey<8>>());
+    run("cuckoo", &ht, bpm);
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+  {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new CountingBufferPoolManager(64, disk_manager);
+    ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("extendible", bpm, GenericComparator<8>(nullptr),
+                                                                     HashFunction<GenericKey<8>>());
+    run("extendible", &ht, bpm);
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_concurrent_test.cpp
+//
+// Identification: test/container/hash_table_concurrent_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+using ConcurrentHashTable = ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto HashKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+// Threads insert and remove keys of their own, which splits and merges buckets and grows and shrinks the directory,
+// while other threads look up keys that stay in the table throughout.
+// NOLINTNEXTLINE
+TEST(HashTableConcurrentTest, InsertRemoveLookupTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  ConcurrentHashTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), HashFunction<GenericKey<8>>());
+
+  // Multiples of 4 stay in the table, the other keys come and go.
+  const int64_t key_range = 40000;
+  for (int64_t key = 0; key < key_range; key += 4) {
+    ASSERT_TRUE(ht.Insert(nullptr, HashKey(key), RID(key, 0)));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int round = 0; round < 2; round++) {
+        for (int64_t key = 1 + t; key < key_range; key += 4) {
+          EXPECT_TRUE(ht.Insert(nullptr, HashKey(key), RID(key, 0)));
+        }
+        for (int64_t key = 1 + t; key < key_range; key += 4) {
+          EXPECT_TRUE(ht.Remove(nullptr, HashKey(key), RID(key, 0)));
+        }
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = 4 * t; key < key_range; key += 8) {
+          std::vector<RID> result;
+          EXPECT_TRUE(ht.GetValue(nullptr, HashKey(key), &result)) << key;
+          EXPECT_EQ(1, result.size());
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ht.VerifyIntegrity();
+  for (int64_t key = 0; key < key_range; key++) {
+    std::vector<RID> result;
+    ASSERT_EQ(key % 4 == 0, ht.GetValue(nullptr, HashKey(key), &result)) << key;
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// Throughput of a mix of inserts and lookups of random keys, with 1, 2 and 4 threads sharing one table.
+// NOLINTNEXTLINE
+TEST(HashTableConcurrentTest, DISABLED_ScalingBenchmarkTest) {
+  const int64_t ops_per_run = 100000;
+  for (int num_threads : {1, 2, 4}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+    ConcurrentHashTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), HashFunction<GenericKey<8>>());
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&ht, t, num_threads] {
+        int64_t ops = ops_per_run / num_threads;
+        for (int64_t i = 0; i < ops; i++) {
+          // Every thread inserts keys of its own, and looks up the key it inserted half a run ago.
+          int64_t key = (i / 2) * num_threads + t;
+          if (i % 2 == 0) {
+            ht.Insert(nullptr, HashKey(key), RID(key, 0));
+          } else {
+            std::vector<RID> result;
+            ht.GetValue(nullptr, HashKey(key / 2), &result);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "threads=" << num_threads << " ops=" << ops_per_run << " seconds=" << elapsed
+              << " ops/s=" << static_cast<int64_t>(ops_per_run / elapsed) << std::endl;
+    ht.VerifyIntegrity();
+
+    disk_manager->ShutDown();
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+  }
+}
+
+}  // namespace bustub
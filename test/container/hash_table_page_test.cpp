@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
+#include <iostream>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -17,13 +19,14 @@
 #include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/index/generic_key.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -57,7 +60,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -114,4 +117,99 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// Lookups through the fingerprints find every value of a key, across groups of slots and around tombstones, and the
+// bitmap counts agree with the slots.
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFingerprintTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  EXPECT_TRUE(bucket_page->IsEmpty());
+
+  // Fill the bucket with 20 keys, each with many values.
+  int size = 0;
+  while (bucket_page->Insert(size % 20, size, IntComparator())) {
+    size++;
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(size, bucket_page->NumReadable());
+  EXPECT_FALSE(bucket_page->Insert(size % 20, size, IntComparator()));
+  for (int key = 0; key < 20; key++) {
+    std::vector<int> result;
+    EXPECT_TRUE(bucket_page->GetValue(key, IntComparator(), &result));
+    EXPECT_EQ((size - key + 19) / 20, result.size());
+    for (int value : result) {
+      EXPECT_EQ(key, value % 20);
+    }
+  }
+  std::vector<int> result;
+  EXPECT_FALSE(bucket_page->GetValue(20, IntComparator(), &result));
+
+  // Remove every third pair: the first free slot is the first tombstone, and the pairs are found at their new slots.
+  for (int value = 0; value < size; value += 3) {
+    EXPECT_TRUE(bucket_page->Remove(value % 20, value, IntComparator()));
+  }
+  EXPECT_FALSE(bucket_page->IsFull());
+  EXPECT_FALSE(bucket_page->Insert(1, 1, IntComparator()));
+  EXPECT_EQ(size - (size + 2) / 3, bucket_page->NumReadable());
+  EXPECT_TRUE(bucket_page->Insert(100, 100, IntComparator()));
+  EXPECT_EQ(100, bucket_page->KeyAt(0));
+  result.clear();
+  EXPECT_TRUE(bucket_page->GetValue(100, IntComparator(), &result));
+  EXPECT_EQ(std::vector<int>{100}, result);
+
+  for (int value = 0; value < size; value++) {
+    bucket_page->Remove(value % 20, value, IntComparator());
+  }
+  EXPECT_FALSE(bucket_page->IsEmpty());
+  EXPECT_TRUE(bucket_page->Remove(100, 100, IntComparator()));
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  EXPECT_EQ(0, bucket_page->NumReadable());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Times lookups, present and absent, and inserts into a full bucket of 8-byte keys.
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, DISABLED_BucketPageBenchmarkTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  GenericComparator<8> comparator(nullptr);
+
+  GenericKey<8> key;
+  int64_t size = 0;
+  for (key.SetFromInteger(size); bucket_page->Insert(key, RID(size, 0), comparator); key.SetFromInteger(size)) {
+    size++;
+  }
+  const int64_t num_ops = 200000;
+  int64_t found = 0;
+  int64_t expected_found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < num_ops; i++) {
+    std::vector<RID> result;
+    key.SetFromInteger(i % (2 * size));
+    found += bucket_page->GetValue(key, comparator, &result) ? 1 : 0;
+    expected_found += i % (2 * size) < size ? 1 : 0;
+    bucket_page->Insert(key, RID(i, 1), comparator);
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(expected_found, found);
+  std::cout << "slots=" << size << " lookups+inserts=" << num_ops << " seconds=" << elapsed << std::endl;
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/linear_probe_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+using ProbeHashTable = LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto ProbeKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+// Checks that every key below key_range has exactly the values 0..values(key)-1.
+template <typename ValueCount>
+void CheckTable(ProbeHashTable *ht, int64_t key_range, ValueCount values) {
+  for (int64_t key = 0; key < key_range; key++) {
+    std::vector<RID> result;
+    ASSERT_EQ(values(key) > 0, ht->GetValue(nullptr, ProbeKey(key), &result)) << key;
+    std::sort(result.begin(), result.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+    ASSERT_EQ(values(key), result.size()) << key;
+    for (int64_t value = 0; value < values(key); value++) {
+      EXPECT_EQ(RID(key, value), result[value]);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+  }
+  // duplicate values for the same key are not allowed
+  EXPECT_FALSE(ht.Insert(nullptr, 3, 3));
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ((std::vector<int>{i, 2 * i + 1}), res);
+  }
+
+  EXPECT_TRUE(ht.Remove(nullptr, 2, 2));
+  EXPECT_FALSE(ht.Remove(nullptr, 2, 2));
+  EXPECT_FALSE(ht.Remove(nullptr, 7, 7));
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 2, &res));
+  EXPECT_EQ(std::vector<int>{5}, res);
+  EXPECT_TRUE(ht.Remove(nullptr, 2, 5));
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 2, &res));
+  EXPECT_EQ(1000, ht.GetSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// A table that starts with a few slots grows many times over, with lookups, duplicate inserts and removes in the
+// middle of each resize, and an explicit resize on top.
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, IncrementalResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  // A small pool makes a leaked pin fail the test.
+  auto *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  ProbeHashTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), 10, HashFunction<GenericKey<8>>());
+
+  const int64_t key_range = 20000;
+  auto inserted_values = [](int64_t key) -> int64_t { return key % 10 == 0 ? 3 : 1; };
+  size_t size = ht.GetSize();
+  for (int64_t key = 0; key < key_range; key++) {
+    for (int64_t value = 0; value < inserted_values(key); value++) {
+      ASSERT_TRUE(ht.Insert(nullptr, ProbeKey(key), RID(key, value))) << key;
+    }
+    ASSERT_FALSE(ht.Insert(nullptr, ProbeKey(key), RID(key, 0)));
+    // Pairs that were inserted before the resize started are found wherever they are now.
+    std::vector<RID> result;
+    ASSERT_TRUE(ht.GetValue(nullptr, ProbeKey(key / 2), &result)) << key;
+    EXPECT_EQ(inserted_values(key / 2), result.size());
+    EXPECT_GE(ht.GetSize(), size);
+    size = ht.GetSize();
+  }
+  EXPECT_GE(ht.GetSize(), key_range);
+  CheckTable(&ht, key_range + 100, [&](int64_t key) { return key < key_range ? inserted_values(key) : 0; });
+
+  // Every other key loses its last value, and keys with a single value disappear.
+  auto remaining_values = [&](int64_t key) { return inserted_values(key) - (key % 2 == 0 ? 1 : 0); };
+  for (int64_t key = 0; key < key_range; key += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, ProbeKey(key), RID(key, inserted_values(key) - 1))) << key;
+    ASSERT_FALSE(ht.Remove(nullptr, ProbeKey(key), RID(key, inserted_values(key) - 1))) << key;
+  }
+  CheckTable(&ht, key_range, remaining_values);
+
+  ht.Resize(ht.GetSize());
+  CheckTable(&ht, key_range, remaining_values);
+  for (int64_t key = key_range; key < key_range + 1000; key++) {
+    ASSERT_TRUE(ht.Insert(nullptr, ProbeKey(key), RID(key, 0)));
+  }
+  CheckTable(&ht, key_range + 1000, [&](int64_t key) { return key < key_range ? remaining_values(key) : 1; });
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Lookups of keys that stay in the table run while other threads insert and remove keys and grow the table.
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  ProbeHashTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), 100, HashFunction<GenericKey<8>>());
+
+  // Multiples of 4 stay in the table, the other keys come and go.
+  const int64_t key_range = 8000;
+  for (int64_t key = 0; key < key_range; key += 4) {
+    ASSERT_TRUE(ht.Insert(nullptr, ProbeKey(key), RID(key, 0)));
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int64_t key = 1 + t; key < key_range; key += 4) {
+        EXPECT_TRUE(ht.Insert(nullptr, ProbeKey(key), RID(key, 0)));
+      }
+      for (int64_t key = 1 + t; key < key_range; key += 8) {
+        EXPECT_TRUE(ht.Remove(nullptr, ProbeKey(key), RID(key, 0)));
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = 4 * t; key < key_range; key += 8) {
+          std::vector<RID> result;
+          EXPECT_TRUE(ht.GetValue(nullptr, ProbeKey(key), &result)) << key;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  CheckTable(&ht, key_range, [](int64_t key) -> int64_t { return key % 4 == 0 || (key % 4 != 3 && key % 8 >= 4); });
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Inserts into a table that starts small and grows to hold every key, and reports the slowest single insert: a resize
+// is spread over the inserts that follow it rather than paid for by one of them.
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, DISABLED_TailLatencyBenchmarkTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  ProbeHashTable ht("foo_pk", bpm, GenericComparator<8>(nullptr), 100, HashFunction<GenericKey<8>>());
+
+  const int64_t num_keys = 50000;
+  double slowest = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t key = 0; key < num_keys; key++) {
+    auto insert_start = std::chrono::steady_clock::now();
+    ht.Insert(nullptr, ProbeKey(key), RID(key, 0));
+    slowest = std::max(slowest,
+                       std::chrono::duration<double>(std::chrono::steady_clock::now() - insert_start).count());
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "inserts=" << num_keys << " slots=" << ht.GetSize() << " seconds=" << elapsed
+            << " slowest_insert_ms=" << slowest * 1000 << std::endl;
+  std::vector<RID> result;
+  EXPECT_TRUE(ht.GetValue(nullptr, ProbeKey(num_keys / 2), &result));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
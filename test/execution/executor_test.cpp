@@ -23,6 +23,7 @@
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
@@ -31,7 +32,9 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
 #include "executor_test_util.h"  // NOLINT
@@ -653,4 +656,194 @@ TEST_F(ExecutorTest, DISABLED_SimpleDistinctTest) {
   ASSERT_TRUE(std::equal(results.cbegin(), results.cend(), expected.cbegin()));
 }
 
+// Emits a fixed list of tuples, to drive an executor without a child plan.
+class TupleListExecutor : public AbstractExecutor {
+ public:
+  TupleListExecutor(ExecutorContext *exec_ctx, const Schema *schema, std::vector<Tuple> tuples)
+      : AbstractExecutor(exec_ctx), schema_(schema), tuples_(std::move(tuples)) {}
+
+  void Init() override { next_ = 0; }
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override {
+    if (next_ == tuples_.size()) {
+      return false;
+    }
+    *tuple = tuples_[next_++];
+    return true;
+  }
+
+  auto GetOutputSchema() -> const Schema * override { return schema_; }
+
+ private:
+  const Schema *schema_;
+  std::vector<Tuple> tuples_;
+  size_t next_{0};
+};
+
+// SELECT outer.a, inner_table.b FROM outer JOIN inner_table ON outer.a = inner_table.a, with a B+ tree index on
+// inner_table.a and more outer tuples than the join looks up in one batch
+TEST_F(ExecutorTest, NestedIndexJoinBatchTest) {
+  Schema inner_schema({Column("a", TypeId::BIGINT), Column("b", TypeId::BIGINT)});
+  auto *inner_info = GetCatalog()->CreateTable(GetTxn(), "inner_table", inner_schema);
+  for (int64_t i = 0; i < 1500; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetBigIntValue(i % 500), ValueFactory::GetBigIntValue(i)}, &inner_schema);
+    ASSERT_TRUE(inner_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(GetTxn(), "inner_index", "inner_table", inner_schema,
+                                                                key_schema, {0}, 8, HashFunctionType{},
+                                                                IndexType::BPLUS_TREE);
+
+  // Outer keys in descending order; only those below 500 have matches, three each.
+  Schema outer_schema({Column("a", TypeId::BIGINT)});
+  std::vector<Tuple> outer_tuples;
+  for (int64_t i = 0; i < 1000; i++) {
+    outer_tuples.emplace_back(std::vector<Value>{ValueFactory::GetBigIntValue(999 - i)}, &outer_schema);
+  }
+  auto *outer_a = MakeColumnValueExpression(outer_schema, 0, "a");
+  auto *inner_a = MakeColumnValueExpression(inner_schema, 1, "a");
+  auto *inner_b = MakeColumnValueExpression(inner_schema, 1, "b");
+  const auto *out_schema = MakeOutputSchema({{"a", outer_a}, {"b", inner_b}});
+  NestedIndexJoinPlanNode plan(out_schema, {}, MakeComparisonExpression(outer_a, inner_a, ComparisonType::Equal),
+                               inner_info->oid_, "inner_index", &outer_schema, &inner_schema);
+
+  // Key-range locking looks keys up one by one, so read without it to take the batched path.
+  auto *txn = GetTxnManager()->Begin(nullptr, IsolationLevel::READ_COMMITTED);
+  ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  NestIndexJoinExecutor executor(&exec_ctx, &plan,
+                                 std::make_unique<TupleListExecutor>(&exec_ctx, &outer_schema, outer_tuples));
+  executor.Init();
+  Tuple tuple;
+  RID rid;
+  size_t count = 0;
+  int64_t previous = 1000;
+  while (executor.Next(&tuple, &rid)) {
+    int64_t a = tuple.GetValue(out_schema, 0).GetAs<int64_t>();
+    int64_t b = tuple.GetValue(out_schema, 1).GetAs<int64_t>();
+    EXPECT_EQ(a, b % 500);
+    EXPECT_LE(a, previous);
+    previous = a;
+    count++;
+  }
+  EXPECT_EQ(1500, count);
+  GetTxnManager()->Commit(txn);
+  delete txn;
+}
+
+// SELECT a, b FROM covered WHERE b >= 100 with an index on a that includes b, which answers the query on its own,
+// and SELECT a, c FROM covered, which has to read c from the table
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::INTEGER), Column("c", TypeId::VARCHAR, 16)});
+  auto *table_info = GetCatalog()->CreateTable(GetTxn(), "covered", schema);
+  std::vector<RID> rids(300);
+  for (int64_t i = 0; i < 300; i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(299 - i), ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                 ValueFactory::GetVarcharValue("row")},
+                &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rids[i], GetTxn()));
+  }
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  auto *index_info = GetCatalog()->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      GetTxn(), "covered_index", "covered", schema, key_schema, {0}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::BPLUS_TREE, {1});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  // Change c in the table, behind the back of the index, to tell which scans read the table.
+  for (int64_t i = 0; i < 300; i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(299 - i), ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                 ValueFactory::GetVarcharValue("new")},
+                &schema);
+    ASSERT_TRUE(table_info->table_->UpdateTuple(tuple, rids[i], GetTxn()));
+  }
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "a");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "b");
+  auto *col_c = MakeColumnValueExpression(schema, 0, "c");
+  auto *predicate =
+      MakeComparisonExpression(col_b, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                               ComparisonType::GreaterThanOrEqual);
+  const auto *covered_schema = MakeOutputSchema({{"a", col_a}, {"b", col_b}});
+  IndexScanPlanNode covered_plan(covered_schema, predicate, index_info->index_oid_);
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&covered_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(200, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    // In key order, and the included column comes back as it was when the index was built.
+    int64_t a = result_set[i].GetValue(covered_schema, 0).GetAs<int64_t>();
+    EXPECT_EQ(static_cast<int64_t>(i), a);
+    EXPECT_EQ(299 - a, result_set[i].GetValue(covered_schema, 1).GetAs<int32_t>());
+  }
+
+  const auto *uncovered_schema = MakeOutputSchema({{"a", col_a}, {"c", col_c}});
+  IndexScanPlanNode uncovered_plan(uncovered_schema, nullptr, index_info->index_oid_);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&uncovered_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(300, result_set.size());
+  for (const auto &tuple : result_set) {
+    EXPECT_EQ("new", tuple.GetValue(uncovered_schema, 1).ToString());
+  }
+}
+
+// SELECT ts, id FROM events WHERE ts BETWEEN 2000 AND 2490 AND id >= 120 through a range scan of an index on ts,
+// SELECT id FROM events WHERE ts = 3000 through an equality scan of it, and SELECT ts FROM events WHERE id = 42 through
+// an equality scan of a hash index on id
+TEST_F(ExecutorTest, IndexRangeScanTest) {
+  Schema schema({Column("ts", TypeId::TIMESTAMP), Column("id", TypeId::INTEGER)});
+  auto *table_info = GetCatalog()->CreateTable(GetTxn(), "events", schema);
+  for (int32_t i = 0; i < 500; i++) {
+    // Inserted latest first, so that key order differs from table order.
+    int32_t id = 499 - i;
+    Tuple tuple({ValueFactory::GetTimestampValue(1000 + 10 * id), ValueFactory::GetIntegerValue(id)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+  Schema ts_key_schema({Column("ts", TypeId::TIMESTAMP)});
+  auto *ts_index = GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "events_ts", "events", schema, ts_key_schema, {0}, 8, HashFunction<GenericKey<8>>{},
+      IndexType::BPLUS_TREE);
+  Schema id_key_schema({Column("id", TypeId::INTEGER)});
+  auto *id_index = GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "events_id", "events", schema, id_key_schema, {1}, 8, HashFunction<GenericKey<8>>{},
+      IndexType::LINEAR_PROBE_HASH);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, ts_index);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, id_index);
+
+  auto *col_ts = MakeColumnValueExpression(schema, 0, "ts");
+  auto *col_id = MakeColumnValueExpression(schema, 0, "id");
+  const auto *out_schema = MakeOutputSchema({{"ts", col_ts}, {"id", col_id}});
+  auto *predicate = MakeComparisonExpression(col_id, MakeConstantValueExpression(ValueFactory::GetIntegerValue(120)),
+                                             ComparisonType::GreaterThanOrEqual);
+
+  IndexScanPlanNode range_plan(out_schema, predicate, ts_index->index_oid_, {ValueFactory::GetTimestampValue(2000)},
+                               {ValueFactory::GetTimestampValue(2490)});
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&range_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(30, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    // In key order, and the predicate still filters the range.
+    EXPECT_EQ(2200 + 10 * i, result_set[i].GetValue(out_schema, 0).GetAs<uint64_t>());
+    EXPECT_EQ(120 + static_cast<int32_t>(i), result_set[i].GetValue(out_schema, 1).GetAs<int32_t>());
+  }
+
+  IndexScanPlanNode ts_plan(out_schema, nullptr, ts_index->index_oid_, {ValueFactory::GetTimestampValue(3000)});
+  result_set.clear();
+  GetExecutionEngine()->Execute(&ts_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+  EXPECT_EQ(200, result_set[0].GetValue(out_schema, 1).GetAs<int32_t>());
+
+  IndexScanPlanNode id_plan(out_schema, nullptr, id_index->index_oid_, {ValueFactory::GetIntegerValue(42)});
+  result_set.clear();
+  GetExecutionEngine()->Execute(&id_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+  EXPECT_EQ(1420, result_set[0].GetValue(out_schema, 0).GetAs<uint64_t>());
+
+  // Nothing in range.
+  IndexScanPlanNode empty_plan(out_schema, nullptr, ts_index->index_oid_, {ValueFactory::GetTimestampValue(6000)},
+                               {ValueFactory::GetTimestampValue(7000)});
+  result_set.clear();
+  GetExecutionEngine()->Execute(&empty_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_TRUE(result_set.empty());
+}
+
 }  // namespace bustub
@@ -0,0 +1,269 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_batch_lookup_test.cpp
+//
+// Identification: test/storage/b_plus_tree_batch_lookup_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using BatchTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto MakeKeys(const std::vector<int64_t> &values) -> std::vector<GenericKey<8>> {
+  std::vector<GenericKey<8>> keys(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    keys[i].SetFromInteger(values[i]);
+  }
+  return keys;
+}
+
+// Every result of a batch lookup must match a lookup of the key on its own.
+void CheckBatch(BatchTree *tree, const std::vector<int64_t> &values) {
+  auto keys = MakeKeys(values);
+  std::vector<std::vector<RID>> results;
+  size_t found = tree->GetValues(keys, &results);
+  ASSERT_EQ(values.size(), results.size());
+  size_t expected_found = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    std::vector<RID> expected;
+    expected_found += tree->GetValue(keys[i], &expected) ? 1 : 0;
+    auto by_rid = [](const RID &a, const RID &b) { return a.Get() < b.Get(); };
+    std::sort(expected.begin(), expected.end(), by_rid);
+    std::sort(results[i].begin(), results[i].end(), by_rid);
+    ASSERT_EQ(expected, results[i]) << "key " << values[i];
+  }
+  EXPECT_EQ(expected_found, found);
+}
+
+// Batches in random order, with repeated and missing keys, keys past either end of the tree, and keys with posting
+// lists, over small pages so that a batch crosses many leaves and parents, in both tree modes.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBatchLookupTest, GetValuesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    // A small pool makes a leaked pin fail the test.
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BatchTree tree("foo_pk", bpm, comparator, 4, 5, mode, false);
+
+    std::vector<std::vector<RID>> results;
+    EXPECT_EQ(0, tree.GetValues(MakeKeys({1, 2, 3}), &results));
+    EXPECT_EQ(3, results.size());
+
+    // Every even key up to 2000, and a few values more for every 100th.
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < 2000; key += 2) {
+      index_key.SetFromInteger(key);
+      for (int64_t value = 0; value <= (key % 100 == 0 ? 3 : 0); value++) {
+        EXPECT_TRUE(tree.Insert(index_key, RID(key, value)));
+      }
+    }
+
+    std::mt19937 rng(15445);
+    for (size_t batch_size : {1, 2, 10, 100, 1000, 5000}) {
+      std::vector<int64_t> values(batch_size);
+      for (auto &value : values) {
+        value = static_cast<int64_t>(rng() % 2100) - 50;
+      }
+      CheckBatch(&tree, values);
+    }
+    // A dense batch stays on each leaf for several keys, a sparse one jumps over leaves and parents.
+    std::vector<int64_t> dense(2000);
+    std::vector<int64_t> sparse;
+    for (int64_t i = 0; i < 2000; i++) {
+      dense[i] = 1999 - i;
+      if (i % 97 == 0) {
+        sparse.push_back(i);
+      }
+    }
+    CheckBatch(&tree, dense);
+    CheckBatch(&tree, sparse);
+    CheckBatch(&tree, {});
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// Batch lookups run while other threads split and merge the leaves around the keys they look for, which stay in the
+// tree throughout.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBatchLookupTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BatchTree tree("foo_pk", bpm, comparator, 4, 5, mode);
+
+    // Multiples of 4 stay in the tree, the other keys come and go.
+    const int64_t key_range = 4000;
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < key_range; key += 4) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(key, 0));
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; t++) {
+      threads.emplace_back([&tree, t] {
+        GenericKey<8> key;
+        for (int round = 0; round < 3; round++) {
+          for (int64_t i = 1 + t; i < key_range; i += 4) {
+            key.SetFromInteger(i);
+            tree.Insert(key, RID(i, 0));
+          }
+          for (int64_t i = 1 + t; i < key_range; i += 4) {
+            key.SetFromInteger(i);
+            tree.Remove(key);
+          }
+        }
+      });
+    }
+    for (int t = 0; t < 2; t++) {
+      threads.emplace_back([&tree, t] {
+        std::mt19937 rng(t);
+        for (int round = 0; round < 20; round++) {
+          std::vector<int64_t> values(200);
+          for (auto &value : values) {
+            value = (rng() % (key_range / 4)) * 4;
+          }
+          std::vector<std::vector<RID>> results;
+          EXPECT_EQ(values.size(), tree.GetValues(MakeKeys(values), &results));
+          for (size_t i = 0; i < values.size(); i++) {
+            ASSERT_EQ(1, results[i].size());
+            EXPECT_EQ(values[i], results[i][0].GetPageId());
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// The index looks up a batch of key tuples the same as one by one.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBatchLookupTest, IndexScanKeysTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Schema schema({Column("a", TypeId::BIGINT)});
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(
+      std::make_unique<IndexMetadata>("index", "table", &schema, std::vector<uint32_t>{0}), bpm);
+
+  auto tuple = [&schema](int64_t value) { return Tuple({ValueFactory::GetBigIntValue(value)}, &schema); };
+  for (int64_t i = 0; i < 3000; i++) {
+    index.InsertEntry(tuple(i % 1000), RID(i, 0), nullptr);
+  }
+  std::vector<Tuple> keys;
+  for (int64_t i = 0; i < 1200; i += 7) {
+    keys.push_back(tuple(1199 - i));
+  }
+  std::vector<std::vector<RID>> results;
+  index.ScanKeys(keys, &results, nullptr);
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RID> expected;
+    index.ScanKey(keys[i], &expected, nullptr);
+    std::sort(expected.begin(), expected.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+    std::sort(results[i].begin(), results[i].end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+    EXPECT_EQ(expected, results[i]);
+    EXPECT_EQ(keys[i].GetValue(&schema, 0).GetAs<int64_t>() < 1000 ? 3 : 0, results[i].size());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Compares looking up a large batch of random keys one at a time and as a batch, with a buffer pool that holds only a
+// small part of the tree, as for the inner index of a join with a large outer input.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBatchLookupTest, DISABLED_BatchBenchmarkTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 200000;
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BatchTree tree("foo_pk", bpm, comparator);
+  std::vector<std::pair<GenericKey<8>, RID>> entries(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    entries[i].first.SetFromInteger(i);
+    entries[i].second = RID(i, 0);
+  }
+  EXPECT_TRUE(tree.BulkLoad(&entries));
+
+  std::vector<int64_t> values(num_keys / 2);
+  std::mt19937 rng(15445);
+  for (auto &value : values) {
+    value = rng() % num_keys;
+  }
+  auto keys = MakeKeys(values);
+  for (bool batch : {false, true}) {
+    std::vector<std::vector<RID>> results(keys.size());
+    auto start = std::chrono::steady_clock::now();
+    if (batch) {
+      tree.GetValues(keys, &results);
+    } else {
+      for (size_t i = 0; i < keys.size(); i++) {
+        tree.GetValue(keys[i], &results[i]);
+      }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (size_t i = 0; i < keys.size(); i++) {
+      ASSERT_EQ(1, results[i].size());
+      EXPECT_EQ(values[i], results[i][0].GetPageId());
+    }
+    std::cout << (batch ? "GetValues" : "GetValue") << " keys=" << keys.size() << " seconds=" << elapsed << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_blink_test.cpp
+//
+// Identification: test/storage/b_plus_tree_blink_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BLinkTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// Compares a full scan of the tree with the expected keys.
+void CheckScan(BLinkTree *tree, const std::set<int64_t> &expected) {
+  std::vector<int64_t> keys;
+  for (auto iterator = tree->Begin(); !iterator.IsEnd(); ++iterator) {
+    keys.push_back((*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(keys, std::vector<int64_t>(expected.begin(), expected.end()));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBLinkTest, InsertRemoveTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // Tiny pages so that splits reach several levels.
+  BLinkTree tree("foo_pk", bpm, comparator, 3, 3, BPlusTreeMode::B_LINK);
+
+  std::mt19937 rng(15445);
+  std::set<int64_t> expected;
+  GenericKey<8> index_key;
+  for (int i = 0; i < 5000; i++) {
+    int64_t key = rng() % 1000;
+    index_key.SetFromInteger(key);
+    if (rng() % 3 != 0) {
+      EXPECT_EQ(tree.Insert(index_key, RID(0, key)), expected.insert(key).second);
+    } else {
+      tree.Remove(index_key);
+      expected.erase(key);
+    }
+  }
+  CheckScan(&tree, expected);
+  for (int64_t key = 0; key < 1000; key++) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) == 1);
+  }
+
+  // Pages are not merged, so the tree keeps its empty leaves but finds no keys in them.
+  for (auto key : expected) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  CheckScan(&tree, {});
+  EXPECT_FALSE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Time-ordered ingest: every writer appends at the right edge of the tree, racing each other's splits, while readers
+// look up keys that are known to be inserted already.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBLinkTest, ConcurrentAppendTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BLinkTree tree("foo_pk", bpm, comparator, 4, 4, BPlusTreeMode::B_LINK);
+
+  const int num_writers = 4;
+  const int num_readers = 4;
+  const int64_t keys_per_writer = 2000;
+  std::array<std::atomic<int64_t>, num_writers> inserted{};
+  std::atomic<int> writers_done{0};
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_writers; tid++) {
+    threads.emplace_back([&, tid] {
+      GenericKey<8> index_key;
+      for (int64_t i = 0; i < keys_per_writer; i++) {
+        int64_t key = i * num_writers + tid;
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, key)));
+        inserted[tid] = i + 1;
+      }
+      writers_done++;
+    });
+  }
+  for (int tid = 0; tid < num_readers; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 rng(tid);
+      GenericKey<8> index_key;
+      while (writers_done < num_writers) {
+        int writer = rng() % num_writers;
+        int64_t count = inserted[writer];
+        if (count == 0) {
+          continue;
+        }
+        int64_t key = static_cast<int64_t>(rng() % count) * num_writers + writer;
+        std::vector<RID> rids;
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<int64_t> expected;
+  for (int64_t key = 0; key < num_writers * keys_per_writer; key++) {
+    expected.insert(key);
+  }
+  CheckScan(&tree, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
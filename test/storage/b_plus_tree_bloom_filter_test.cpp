@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bloom_filter_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bloom_filter_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using FilteredTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// Keys that were inserted one by one, bulk loaded, removed and inserted again are all found by single and batch
+// lookups through the filter, in both tree modes.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBloomFilterTest, LookupTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(32, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    FilteredTree tree("foo_pk", bpm, comparator, 4, 5, mode, false, true);
+
+    // Even keys are bulk loaded, multiples of 3 come in one by one, multiples of 5 are removed.
+    std::vector<std::pair<GenericKey<8>, RID>> entries;
+    for (int64_t key = 0; key < 3000; key += 2) {
+      entries.emplace_back();
+      entries.back().first.SetFromInteger(key);
+      entries.back().second = RID(key, 0);
+    }
+    ASSERT_TRUE(tree.BulkLoad(&entries));
+    GenericKey<8> index_key;
+    for (int64_t key = 3; key < 3000; key += 6) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.Insert(index_key, RID(key, 0)));
+    }
+    for (int64_t key = 0; key < 3000; key += 5) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    auto present = [](int64_t key) { return (key % 2 == 0 || key % 3 == 0) && key % 5 != 0 && key < 3000; };
+
+    std::vector<GenericKey<8>> keys;
+    for (int64_t key = 0; key < 6000; key++) {
+      std::vector<RID> result;
+      index_key.SetFromInteger(key);
+      ASSERT_EQ(present(key), tree.GetValue(index_key, &result)) << key;
+      keys.push_back(index_key);
+    }
+    std::vector<std::vector<RID>> results;
+    tree.GetValues(keys, &results);
+    for (int64_t key = 0; key < 6000; key++) {
+      ASSERT_EQ(present(key) ? 1 : 0, results[key].size()) << key;
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// Lookups never miss a key that is in the tree while other threads insert keys and grow the filter.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBloomFilterTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  FilteredTree tree("foo_pk", bpm, comparator, 4, 5, BPlusTreeMode::LOCK_COUPLING, true, true);
+
+  const int num_threads = 4;
+  const int64_t keys_per_thread = 3000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&tree, t] {
+      GenericKey<8> key;
+      for (int64_t i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        key.SetFromInteger(i);
+        tree.Insert(key, RID(i, 0));
+        std::vector<RID> result;
+        EXPECT_TRUE(tree.GetValue(key, &result)) << i;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Compares the cost of looking up absent keys, as a uniqueness check before each insert does, with and without the
+// filter, with a buffer pool that holds only a small part of the tree.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBloomFilterTest, DISABLED_AbsentKeyBenchmarkTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 200000;
+  for (bool bloom_filter : {false, true}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(32, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    FilteredTree tree("foo_pk", bpm, comparator, FilteredTree::LEAF_PAGE_CAPACITY, FilteredTree::INTERNAL_PAGE_CAPACITY,
+                      BPlusTreeMode::LOCK_COUPLING, true, bloom_filter);
+    std::vector<std::pair<GenericKey<8>, RID>> entries(num_keys);
+    for (int64_t i = 0; i < num_keys; i++) {
+      // Every other key, so that absent keys fall between present ones.
+      entries[i].first.SetFromInteger(2 * i);
+      entries[i].second = RID(i, 0);
+    }
+    ASSERT_TRUE(tree.BulkLoad(&entries));
+
+    GenericKey<8> key;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < num_keys; i++) {
+      std::vector<RID> result;
+      // A spread-out order of absent keys, so that consecutive lookups hit different leaves.
+      key.SetFromInteger(2 * ((i * 7919) % num_keys) + 1);
+      found += tree.GetValue(key, &result) ? 1 : 0;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(0, found);
+    std::cout << "bloom_filter=" << bloom_filter << " absent lookups=" << num_keys << " seconds=" << elapsed
+              << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,230 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BulkTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto MakeEntries(const std::vector<int64_t> &keys) -> std::vector<std::pair<GenericKey<8>, RID>> {
+  std::vector<std::pair<GenericKey<8>, RID>> entries(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    entries[i].first.SetFromInteger(keys[i]);
+    entries[i].second = RID(0, keys[i]);
+  }
+  return entries;
+}
+
+auto ScanKeys(BulkTree *tree) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  for (auto iterator = tree->Begin(); !iterator.IsEnd(); ++iterator) {
+    keys.push_back((*iterator).second.GetSlotNum());
+  }
+  return keys;
+}
+
+// Loads shuffled keys, then checks that the tree keeps working under random inserts and removes, which exercises the
+// parent pointers, sibling links and page sizes that the bulk load set up.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, LoadThenModifyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    for (double fill_factor : {0.1, 0.5, 1.0}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      BulkTree tree("foo_pk", bpm, comparator, 4, 5, mode);
+
+      std::mt19937 rng(15445);
+      std::vector<int64_t> keys;
+      for (int64_t key = 0; key < 2000; key += 2) {
+        keys.push_back(key);
+      }
+      std::shuffle(keys.begin(), keys.end(), rng);
+      auto entries = MakeEntries(keys);
+      EXPECT_TRUE(tree.BulkLoad(&entries, fill_factor));
+      std::set<int64_t> expected(keys.begin(), keys.end());
+      EXPECT_EQ(ScanKeys(&tree), std::vector<int64_t>(expected.begin(), expected.end()));
+
+      // Loading into a tree that is not empty is refused.
+      EXPECT_FALSE(tree.BulkLoad(&entries, fill_factor));
+
+      GenericKey<8> index_key;
+      for (int i = 0; i < 4000; i++) {
+        int64_t key = rng() % 2000;
+        index_key.SetFromInteger(key);
+        if (rng() % 2 == 0) {
+          EXPECT_EQ(tree.Insert(index_key, RID(0, key)), expected.insert(key).second);
+        } else {
+          tree.Remove(index_key);
+          expected.erase(key);
+        }
+      }
+      EXPECT_EQ(ScanKeys(&tree), std::vector<int64_t>(expected.begin(), expected.end()));
+      for (int64_t key = 0; key < 2000; key++) {
+        std::vector<RID> rids;
+        index_key.SetFromInteger(key);
+        EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) == 1);
+      }
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, DuplicateKeyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkTree tree("foo_pk", bpm, comparator);
+
+  auto entries = MakeEntries({3, 1, 2, 1});
+  EXPECT_FALSE(tree.BulkLoad(&entries));
+  EXPECT_TRUE(tree.IsEmpty());
+  auto single = MakeEntries({7});
+  EXPECT_TRUE(tree.BulkLoad(&single));
+  EXPECT_EQ(ScanKeys(&tree), std::vector<int64_t>{7});
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Sorts with runs and a fan-in small enough that runs are spilled and merged ahead of time, then loads the sorted
+// entries into trees with unique and with repeated keys.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, ExternalSortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  {
+    // Every multiple of 7 comes twice. The sort and the trees go before the buffer pool they live in.
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 3000; key++) {
+      keys.push_back(key);
+      if (key % 7 == 0) {
+        keys.push_back(key);
+      }
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    ExternalSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator, 100, 3);
+    for (const auto &entry : MakeEntries(keys)) {
+      sort.Add(entry.first, entry.second);
+    }
+    EXPECT_GT(sort.SpilledRuns(), 3);
+    sort.Finish();
+    EXPECT_LE(sort.SpilledRuns(), 3);
+
+    std::sort(keys.begin(), keys.end());
+    std::vector<int64_t> merged;
+    {
+      ExternalSort<GenericKey<8>, RID, GenericComparator<8>>::Merger merge(sort);
+      std::pair<GenericKey<8>, RID> entry;
+      while (merge.Next(&entry)) {
+        merged.push_back(entry.second.GetSlotNum());
+      }
+    }
+    EXPECT_EQ(merged, keys);
+
+    BulkTree unique_tree("unique_pk", bpm, comparator, 4, 5);
+    EXPECT_FALSE(unique_tree.BulkLoad(&sort));
+    EXPECT_TRUE(unique_tree.IsEmpty());
+
+    BulkTree tree("foo_pk", bpm, comparator, 4, 5, BPlusTreeMode::LOCK_COUPLING, false);
+    EXPECT_TRUE(tree.BulkLoad(&sort));
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < 3000; key++) {
+      std::vector<RID> rids;
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids.size(), key % 7 == 0 ? 2U : 1U);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Compares building an index from random-order keys by inserting them one at a time and by bulk loading them.
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, DISABLED_BuildBenchmarkTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 200000;
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (bool bulk : {false, true}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BulkTree tree("foo_pk", bpm, comparator);
+
+    auto start = std::chrono::steady_clock::now();
+    if (bulk) {
+      auto entries = MakeEntries(keys);
+      EXPECT_TRUE(tree.BulkLoad(&entries));
+    } else {
+      GenericKey<8> index_key;
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, key));
+      }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(num_keys, static_cast<int64_t>(ScanKeys(&tree).size()));
+    std::cout << (bulk ? "BulkLoad" : "Insert") << " keys=" << num_keys << " seconds=" << elapsed << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+}  // namespace bustub
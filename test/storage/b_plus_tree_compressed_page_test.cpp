@@ -0,0 +1,276 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_page_test.cpp
+//
+// Identification: test/storage/b_plus_tree_compressed_page_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using CompressedTree = BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+using CompressedLeaf = BPlusTreeCompressedLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+// Composite keys with a long shared prefix, like the keys of a secondary index on (customer name, order id).
+class CompressedKeys {
+ public:
+  CompressedKeys()
+      : schema_({Column("name", TypeId::VARCHAR, 24), Column("id", TypeId::BIGINT)}), comparator_(&schema_) {}
+
+  auto Make(int64_t n) const -> GenericKey<64> {
+    char name[32];
+    snprintf(name, sizeof(name), "customer#%09ld", static_cast<long>(n / 8));  // NOLINT
+    GenericKey<64> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(name), ValueFactory::GetBigIntValue(n)}, &schema_), schema_);
+    return key;
+  }
+
+  auto Comparator() const -> const GenericComparator<64> & { return comparator_; }
+
+ private:
+  Schema schema_;
+  GenericComparator<64> comparator_;
+};
+
+auto ScanIds(CompressedTree *tree) -> std::vector<int64_t> {
+  std::vector<int64_t> ids;
+  for (auto iterator = tree->Begin(); !iterator.IsEnd(); ++iterator) {
+    ids.push_back((*iterator).second.GetSlotNum());
+  }
+  return ids;
+}
+
+// Separators are the shortest keys between their neighbours, and encoding a page under a narrower key range shares
+// the prefix without changing the keys it decodes to.
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressedPageTest, EncodingTest) {
+  CompressedKeys keys;
+  std::mt19937 rng(15445);
+  for (int i = 0; i < 1000; i++) {
+    auto left = keys.Make(rng() % 100000);
+    auto right = keys.Make(rng() % 100000);
+    if (memcmp(left.data_, right.data_, 64) >= 0) {
+      continue;
+    }
+    auto separator = CompressedLeaf::Separator(left, right);
+    EXPECT_LT(memcmp(left.data_, separator.data_, 64), 0);
+    EXPECT_LE(memcmp(separator.data_, right.data_, 64), 0);
+    EXPECT_LE(CompressedLeaf::TrimmedSize(separator), CompressedLeaf::TrimmedSize(right));
+  }
+
+  // Entries inserted while the page is responsible for every key are stored without a prefix, and re-encoded with
+  // one once the key range narrows.
+  alignas(8) char data[PAGE_SIZE];
+  auto *leaf = reinterpret_cast<CompressedLeaf *>(data);
+  leaf->Init(1, INVALID_PAGE_ID, 1000);
+  std::vector<GenericKey<64>> inserted;
+  for (int64_t n = 800; n < 1000; n += 3) {
+    inserted.push_back(keys.Make(n));
+    leaf->Insert(inserted.back(), RID(0, n), keys.Comparator());
+  }
+  EXPECT_EQ(0, leaf->GetPrefixSize());
+  leaf->SetLowKey(keys.Make(800));
+  leaf->SetHighKey(keys.Make(1000));
+  EXPECT_GT(leaf->GetPrefixSize(), 10);
+  ASSERT_EQ(inserted.size(), leaf->GetSize());
+  for (size_t i = 0; i < inserted.size(); i++) {
+    EXPECT_EQ(0, memcmp(inserted[i].data_, leaf->KeyAt(i).data_, 64));
+    RID rid;
+    EXPECT_TRUE(leaf->Lookup(inserted[i], &rid, keys.Comparator()));
+    EXPECT_EQ(leaf->GetItem(i).second, rid);
+  }
+  RID rid;
+  EXPECT_FALSE(leaf->Lookup(keys.Make(801), &rid, keys.Comparator()));
+  EXPECT_EQ(0, leaf->KeyIndex(keys.Make(0), keys.Comparator()));
+  EXPECT_EQ(leaf->GetSize(), leaf->KeyIndex(keys.Make(5000), keys.Comparator()));
+
+  // With the prefix shared, a full page holds several times as many entries as an uncompressed leaf page.
+  leaf->Init(1, INVALID_PAGE_ID, 1000);
+  leaf->SetLowKey(keys.Make(8000));
+  leaf->SetHighKey(keys.Make(16000));
+  for (int64_t n = 8000; leaf->HasRoomFor(1); n++) {
+    leaf->Insert(keys.Make(n), RID(0, n), keys.Comparator());
+  }
+  std::cout << "compressed leaf entries=" << leaf->GetSize() << " prefix=" << leaf->GetPrefixSize() << std::endl;
+  EXPECT_GT(leaf->GetSize(), 2 * static_cast<int>((PAGE_SIZE - 28 - 64) / (64 + sizeof(RID))));
+}
+
+// Random inserts and removes in both tree modes, with max sizes small enough to split and merge on entry counts, and
+// with max sizes out of reach, so that pages split and merge on bytes.
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressedPageTest, RandomInsertRemoveTest) {
+  CompressedKeys keys;
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    for (int max_size : {5, 1000}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      CompressedTree tree("foo_pk", bpm, keys.Comparator(), max_size - 1, max_size, mode);
+
+      std::mt19937 rng(15445);
+      std::set<int64_t> expected;
+      const int64_t key_range = max_size == 5 ? 2000 : 20000;
+      for (int i = 0; i < 4 * key_range; i++) {
+        int64_t n = rng() % key_range;
+        // Inserts outnumber removes at first, so that the tree grows before it shrinks.
+        if (rng() % 8 < (i < 2 * key_range ? 5U : 3U)) {
+          EXPECT_EQ(expected.insert(n).second, tree.Insert(keys.Make(n), RID(0, n)));
+        } else {
+          tree.Remove(keys.Make(n));
+          expected.erase(n);
+        }
+      }
+      EXPECT_EQ(std::vector<int64_t>(expected.begin(), expected.end()), ScanIds(&tree));
+      for (int64_t n = 0; n < key_range; n += 7) {
+        std::vector<RID> rids;
+        EXPECT_EQ(expected.count(n) == 1, tree.GetValue(keys.Make(n), &rids));
+      }
+      for (int64_t n = 0; n < key_range; n++) {
+        tree.Remove(keys.Make(n));
+      }
+      EXPECT_TRUE(mode == BPlusTreeMode::B_LINK || tree.IsEmpty());
+      EXPECT_TRUE(ScanIds(&tree).empty());
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+// Builds trees of keys with long shared prefixes by bulk loading and by inserting in random order, and compares their
+// number of pages with the number of leaves that uncompressed pages would take even when completely full.
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressedPageTest, FanoutTest) {
+  CompressedKeys keys;
+  const int64_t num_keys = 50000;
+  const int64_t plain_leaf_size = (PAGE_SIZE - 28 - 64) / (64 + sizeof(RID));
+  for (bool bulk_load : {true, false}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    CompressedTree tree("foo_pk", bpm, keys.Comparator(), 1000, 1000);
+
+    std::vector<std::pair<GenericKey<64>, RID>> entries;
+    for (int64_t n = 0; n < num_keys; n++) {
+      entries.emplace_back(keys.Make(n), RID(0, n));
+    }
+    if (bulk_load) {
+      EXPECT_TRUE(tree.BulkLoad(&entries, 1.0));
+    } else {
+      std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+      for (const auto &entry : entries) {
+        EXPECT_TRUE(tree.Insert(entry.first, entry.second));
+      }
+    }
+    auto ids = ScanIds(&tree);
+    ASSERT_EQ(num_keys, ids.size());
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+    for (int64_t n = 0; n < num_keys; n += 97) {
+      std::vector<RID> rids;
+      EXPECT_TRUE(tree.GetValue(keys.Make(n), &rids));
+    }
+
+    // Pages are allocated in order and none was deleted, so the next page id counts the pages of the tree.
+    page_id_t next_page_id;
+    bpm->NewPage(&next_page_id);
+    bpm->UnpinPage(next_page_id, false);
+    int64_t pages = next_page_id - 1;
+    std::cout << (bulk_load ? "bulk load" : "random inserts") << ": compressed pages=" << pages
+              << " full uncompressed leaves=" << num_keys / plain_leaf_size << std::endl;
+    EXPECT_LT(pages, num_keys / plain_leaf_size);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+
+// Variable-length keys in a wide key type: URLs of very different lengths, many longer than 64 bytes, in a
+// GenericKey<256>. Pages only store the bytes the keys use, so the tree takes a fraction of the leaves that
+// uncompressed pages padding every key to 256 bytes would.
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressedPageTest, VariableLengthKeyTest) {
+  Schema schema({Column("url", TypeId::VARCHAR, 250)});
+  GenericComparator<256> comparator(&schema);
+  auto make_key = [&](int64_t n) {
+    std::string url = "https://www.example.com/" + std::string(n % 150, 'a') + "/" + std::to_string(n);
+    GenericKey<256> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(url)}, &schema), schema);
+    return key;
+  };
+  const int64_t num_keys = 10000;
+  const int64_t plain_leaf_size = (PAGE_SIZE - 28 - 256) / (256 + sizeof(RID));
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<256>, RID, GenericComparator<256>> tree("foo_pk", bpm, comparator, 1000, 1000, mode);
+
+    std::vector<int64_t> order(num_keys);
+    for (int64_t n = 0; n < num_keys; n++) {
+      order[n] = n;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+    for (int64_t n : order) {
+      EXPECT_TRUE(tree.Insert(make_key(n), RID(0, n)));
+    }
+    page_id_t next_page_id;
+    bpm->NewPage(&next_page_id);
+    bpm->UnpinPage(next_page_id, false);
+    std::cout << "url keys: compressed pages=" << next_page_id - 1
+              << " full uncompressed leaves=" << num_keys / plain_leaf_size << std::endl;
+    EXPECT_LT(next_page_id - 1, num_keys / plain_leaf_size / 2);
+
+    // Remove every other key, then every key is found or not, and the scan returns the rest in key order
+    for (int64_t n = 0; n < num_keys; n += 2) {
+      tree.Remove(make_key(n));
+    }
+    for (int64_t n = 0; n < num_keys; n++) {
+      std::vector<RID> rids;
+      ASSERT_EQ(n % 2 == 1, tree.GetValue(make_key(n), &rids));
+    }
+    GenericKey<256> previous;
+    memset(previous.data_, 0, sizeof(previous.data_));
+    int64_t count = 0;
+    for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator, count++) {
+      EXPECT_LT(comparator(previous, (*iterator).first), 0);
+      previous = (*iterator).first;
+    }
+    EXPECT_EQ(num_keys / 2, count);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+}  // namespace bustub
@@ -10,9 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <iostream>
+#include <random>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -100,7 +104,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -152,7 +156,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -203,7 +207,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -245,7 +249,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -288,7 +292,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -333,4 +337,118 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+// Scans run while other keys are deleted: merges and redistributions move entries between the leaves that a scan
+// steps across, and every key that stays in the tree must still be seen exactly once, in order.
+TEST(BPlusTreeConcurrentTest, ScanDuringDeleteTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> keys;
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+    if (key % 2 == 1) {
+      odd_keys.push_back(key);
+    }
+  }
+  InsertHelper(&tree, keys);
+  std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(0));
+
+  std::atomic<bool> done{false};
+  std::thread deleter([&] {
+    DeleteHelper(&tree, odd_keys);
+    done = true;
+  });
+  int scans = 0;
+  do {
+    int64_t expected_even = 0;
+    int64_t previous = -1;
+    for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator) {
+      int64_t key = (*iterator).second.GetSlotNum();
+      ASSERT_GT(key, previous);
+      previous = key;
+      if (key % 2 == 0) {
+        ASSERT_EQ(expected_even, key);
+        expected_even += 2;
+      }
+    }
+    ASSERT_EQ(num_keys, expected_even);
+    scans++;
+  } while (!done || scans < 2);
+  deleter.join();
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Concurrent insert/lookup throughput for a growing number of threads. Inserts rarely split a leaf, so with optimistic
+// lock coupling they only write-latch their leaf and scale with readers instead of serializing at the root.
+TEST(BPlusTreeConcurrentTest, DISABLED_ScalingBenchmarkTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t preloaded_keys = 10000;
+  const int64_t ops_per_thread = 4000;
+
+  for (uint64_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Even keys are preloaded, every thread inserts its own share of the odd keys and looks up even ones.
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < preloaded_keys; key++) {
+      keys.push_back(key * 2);
+    }
+    InsertHelper(&tree, keys);
+
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t i = 0; i < ops_per_thread; i++) {
+        if (i % 2 == 0) {
+          int64_t key = (i / 2 * static_cast<int64_t>(num_threads) + static_cast<int64_t>(thread_itr)) * 2 + 1;
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.Insert(index_key, RID(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF)));
+        } else {
+          int64_t key = (i * 7919 + static_cast<int64_t>(thread_itr)) % preloaded_keys * 2;
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.GetValue(index_key, &rids));
+        }
+      }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t size = 0;
+    for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator) {
+      size++;
+    }
+    EXPECT_EQ(size, preloaded_keys + static_cast<int64_t>(num_threads) * ops_per_thread / 2);
+    std::cout << "threads=" << num_threads << " ops/s=" << static_cast<int64_t>(num_threads * ops_per_thread / seconds)
+              << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
 }  // namespace bustub
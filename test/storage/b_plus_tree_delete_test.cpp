@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <unordered_set>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -20,7 +21,24 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+/** Remembers the pages it deleted. */
+class DeleteTrackingBufferPoolManager : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+  std::unordered_set<page_id_t> deleted_;
+
+ protected:
+  auto DeletePgImp(page_id_t page_id) -> bool override {
+    bool deleted = BufferPoolManagerInstance::DeletePgImp(page_id);
+    if (deleted) {
+      deleted_.insert(page_id);
+    }
+    return deleted;
+  }
+};
+
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -98,7 +116,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -175,4 +193,51 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, DeletePinnedPageTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new DeleteTrackingBufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  for (int64_t key = 1; key <= 50; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // A reader pins the last leaf while it is merged into its left sibling.
+  index_key.SetFromInteger(50);
+  auto *page = tree.FindLeafPage(index_key);
+  ASSERT_NE(nullptr, page);
+  page_id_t pinned_page_id = page->GetPageId();
+  for (int64_t key = 50; key >= 2; key--) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_EQ(0, bpm->deleted_.count(pinned_page_id));
+
+  // Once the reader is gone, the next structure modification deletes it.
+  bpm->UnpinPage(pinned_page_id, false);
+  index_key.SetFromInteger(1);
+  tree.Remove(index_key, transaction);
+  EXPECT_EQ(1, bpm->deleted_.count(pinned_page_id));
+  EXPECT_TRUE(tree.IsEmpty());
+
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
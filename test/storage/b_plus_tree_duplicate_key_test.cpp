@@ -0,0 +1,262 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_duplicate_key_test.cpp
+//
+// Identification: test/storage/b_plus_tree_duplicate_key_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using DuplicateTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+auto IntegerKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+auto SortedValues(DuplicateTree *tree, int64_t key) -> std::vector<RID> {
+  std::vector<RID> rids;
+  tree->GetValue(IntegerKey(key), &rids);
+  std::sort(rids.begin(), rids.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+  return rids;
+}
+
+// Checks that every key has exactly its expected values, and that a scan visits each value once, in key order.
+void CheckTree(DuplicateTree *tree, const std::map<int64_t, std::set<int64_t>> &expected, int64_t key_range) {
+  for (int64_t key = 0; key < key_range; key++) {
+    std::vector<RID> rids;
+    auto it = expected.find(key);
+    if (it == expected.end()) {
+      EXPECT_FALSE(tree->GetValue(IntegerKey(key), &rids));
+      continue;
+    }
+    std::vector<RID> expected_rids;
+    for (int64_t value : it->second) {
+      expected_rids.emplace_back(key, value);
+    }
+    ASSERT_EQ(expected_rids, SortedValues(tree, key)) << "key " << key;
+  }
+  size_t total = 0;
+  for (const auto &[key, values] : expected) {
+    total += values.size();
+  }
+  size_t count = 0;
+  int64_t previous = -1;
+  for (auto iterator = tree->Begin(); !iterator.IsEnd(); ++iterator, count++) {
+    int64_t key = (*iterator).first.ToString();
+    EXPECT_LE(previous, key);
+    EXPECT_EQ(key, (*iterator).second.GetPageId());
+    previous = key;
+  }
+  EXPECT_EQ(total, count);
+}
+
+// Keys with one value, with a few, and with enough to take several posting pages, in both tree modes: values are
+// inserted, removed one by one until their posting list is gone again, and whole keys are removed with their lists.
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, PostingListTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t key_range = 200;
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    // A small pool makes a leaked pin on a posting page fail the test.
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    DuplicateTree tree("foo_pk", bpm, comparator, 4, 5, mode, false);
+
+    std::map<int64_t, std::set<int64_t>> expected;
+    auto value_count = [](int64_t key) -> int64_t { return key % 50 == 0 ? 1500 : key % 4; };
+    for (int64_t round = 0; round < 1500; round++) {
+      for (int64_t key = 0; key < key_range; key++) {
+        if (round < value_count(key)) {
+          EXPECT_TRUE(tree.Insert(IntegerKey(key), RID(key, round)));
+          expected[key].insert(round);
+        }
+      }
+    }
+    // The same pair is not inserted twice while it is a key's only value.
+    EXPECT_FALSE(tree.Insert(IntegerKey(1), RID(1, 0)));
+    CheckTree(&tree, expected, key_range);
+
+    // Remove values in random order, including values that are not there, until some lists are down to one value.
+    std::mt19937 rng(15445);
+    for (int i = 0; i < 20000; i++) {
+      int64_t key = rng() % key_range;
+      int64_t value = rng() % (value_count(key) + 1);
+      tree.Remove(IntegerKey(key), RID(key, value));
+      if (expected.count(key) == 1 && expected[key].erase(value) == 1 && expected[key].empty()) {
+        expected.erase(key);
+      }
+    }
+    CheckTree(&tree, expected, key_range);
+
+    // Removing a key takes all of its values, and inserting it again starts from scratch.
+    for (int64_t key = 0; key < key_range; key += 3) {
+      tree.Remove(IntegerKey(key));
+      expected.erase(key);
+    }
+    EXPECT_TRUE(tree.Insert(IntegerKey(0), RID(0, 7)));
+    expected[0] = {7};
+    CheckTree(&tree, expected, key_range);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// Bulk loading collapses repeated keys into posting lists, and a tree with unique keys still refuses them.
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  std::map<int64_t, std::set<int64_t>> expected;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (int64_t key = 0; key < 500; key++) {
+    for (int64_t value = 0; value <= (key % 10 == 0 ? 700 : key % 3); value++) {
+      entries.emplace_back(IntegerKey(key), RID(key, value));
+      expected[key].insert(value);
+    }
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+
+  DuplicateTree unique_tree("unique", bpm, comparator, 4, 5);
+  auto copy = entries;
+  EXPECT_FALSE(unique_tree.BulkLoad(&copy));
+  EXPECT_TRUE(unique_tree.IsEmpty());
+
+  DuplicateTree tree("foo_pk", bpm, comparator, 4, 5, BPlusTreeMode::LOCK_COUPLING, false);
+  EXPECT_TRUE(tree.BulkLoad(&entries));
+  CheckTree(&tree, expected, 500);
+  EXPECT_TRUE(tree.Insert(IntegerKey(1), RID(1, 100)));
+  tree.Remove(IntegerKey(10), RID(10, 3));
+  expected[1].insert(100);
+  expected[10].erase(3);
+  CheckTree(&tree, expected, 500);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Threads insert and remove values of a handful of hot keys, so that posting lists are created, grown, shrunk and
+// freed concurrently, while other keys split and merge the leaves around them.
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  DuplicateTree tree("foo_pk", bpm, comparator, 4, 5, BPlusTreeMode::LOCK_COUPLING, false);
+
+  const int num_threads = 4;
+  const int64_t values_per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&tree, t] {
+      // Every thread owns the values it inserts, and removes every other one of them again.
+      for (int64_t i = 0; i < values_per_thread; i++) {
+        int64_t key = i % 8 == 0 ? 1000 + i : i % 5;
+        tree.Insert(IntegerKey(key), RID(key, t * values_per_thread + i));
+      }
+      for (int64_t i = 0; i < values_per_thread; i += 2) {
+        int64_t key = i % 8 == 0 ? 1000 + i : i % 5;
+        tree.Remove(IntegerKey(key), RID(key, t * values_per_thread + i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::map<int64_t, std::set<int64_t>> expected;
+  for (int t = 0; t < num_threads; t++) {
+    for (int64_t i = 1; i < values_per_thread; i += 2) {
+      expected[i % 8 == 0 ? 1000 + i : i % 5].insert(t * values_per_thread + i);
+    }
+  }
+  CheckTree(&tree, expected, 1000 + values_per_thread);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// An index over a column with repeated values finds every tuple with a value, and deletes only the given tuple.
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, IndexScanKeyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Schema schema({Column("a", TypeId::BIGINT)});
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(
+      std::make_unique<IndexMetadata>("index", "table", &schema, std::vector<uint32_t>{0}), bpm);
+
+  auto tuple = [&schema](int64_t value) { return Tuple({ValueFactory::GetBigIntValue(value)}, &schema); };
+  for (int64_t i = 0; i < 3000; i++) {
+    index.InsertEntry(tuple(i % 3), RID(i, 0), nullptr);
+  }
+  std::vector<RID> result;
+  index.ScanKey(tuple(1), &result, nullptr);
+  EXPECT_EQ(1000, result.size());
+  for (const auto &rid : result) {
+    EXPECT_EQ(1, rid.GetPageId() % 3);
+  }
+
+  index.DeleteEntry(tuple(1), RID(1, 0), nullptr);
+  index.DeleteEntry(tuple(1), RID(2, 0), nullptr);
+  result.clear();
+  index.ScanKey(tuple(1), &result, nullptr);
+  EXPECT_EQ(999, result.size());
+  EXPECT_EQ(result.end(), std::find(result.begin(), result.end(), RID(1, 0)));
+
+  result.clear();
+  index.ScanRange(tuple(0), tuple(2), &result, nullptr);
+  EXPECT_EQ(2999, result.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
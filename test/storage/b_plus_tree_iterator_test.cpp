@@ -0,0 +1,315 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_iterator_test.cpp
+//
+// Identification: test/storage/b_plus_tree_iterator_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using IteratorTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using TreeIterator = IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
+using Entry = std::pair<int64_t, uint32_t>;
+
+auto KeyOf(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+// Collects the (key, slot) pairs an iterator visits until it becomes End().
+auto Drain(TreeIterator &&iterator) -> std::vector<Entry> {
+  std::vector<Entry> entries;
+  for (; !iterator.IsEnd(); ++iterator) {
+    entries.emplace_back((*iterator).first.ToString(), (*iterator).second.GetSlotNum());
+  }
+  return entries;
+}
+
+// The entries of expected with keys in [low, high], in ascending or descending order. Values of a key compare by slot.
+auto Expected(const std::multimap<int64_t, uint32_t> &expected, int64_t low, int64_t high, bool reverse)
+    -> std::vector<Entry> {
+  std::vector<Entry> entries;
+  for (auto it = expected.lower_bound(low); it != expected.end() && it->first <= high; ++it) {
+    entries.emplace_back(*it);
+  }
+  std::sort(entries.begin(), entries.end());
+  if (reverse) {
+    std::reverse(entries.begin(), entries.end());
+  }
+  return entries;
+}
+
+// Posting lists are in no particular order, so the values of each key are sorted before comparing.
+auto SortValues(std::vector<Entry> entries, bool reverse) -> std::vector<Entry> {
+  for (size_t begin = 0; begin < entries.size();) {
+    size_t end = begin;
+    while (end < entries.size() && entries[end].first == entries[begin].first) {
+      end++;
+    }
+    std::sort(entries.begin() + begin, entries.begin() + end);
+    if (reverse) {
+      std::reverse(entries.begin() + begin, entries.begin() + end);
+    }
+    begin = end;
+  }
+  return entries;
+}
+
+// Forward and reverse iterators, bounded and not, over small pages with posting lists, in both tree modes, before and
+// after removing most keys (which leaves empty leaves behind in a B-link tree).
+// NOLINTNEXTLINE
+TEST(BPlusTreeIteratorTest, ReverseAndBoundedTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    // A small pool makes a leaked pin fail the test.
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    IteratorTree tree("foo_pk", bpm, comparator, 4, 5, mode, false);
+
+    EXPECT_TRUE(tree.RBegin().IsEnd());
+    EXPECT_TRUE(tree.RBegin(KeyOf(5)).IsEnd());
+
+    // Every even key in [0, 1000), with three values for every 50th.
+    std::multimap<int64_t, uint32_t> expected;
+    for (int64_t key = 0; key < 1000; key += 2) {
+      for (uint32_t value = 0; value < (key % 50 == 0 ? 3U : 1U); value++) {
+        tree.Insert(KeyOf(key), RID(key, value));
+        expected.emplace(key, value);
+      }
+    }
+
+    for (int round = 0; round < 2; round++) {
+      EXPECT_EQ(Expected(expected, -1, 1000, false), SortValues(Drain(tree.Begin()), false));
+      EXPECT_EQ(Expected(expected, -1, 1000, true), SortValues(Drain(tree.RBegin()), true));
+      for (auto [low, high] : std::vector<std::pair<int64_t, int64_t>>{
+               {-10, -1}, {0, 0}, {1, 1}, {100, 100}, {99, 301}, {100, 300}, {-5, 7}, {990, 2000}, {500, 400}}) {
+        EXPECT_EQ(Expected(expected, low, high, false), SortValues(Drain(tree.Begin(KeyOf(low), KeyOf(high))), false))
+            << low << " " << high;
+        EXPECT_EQ(Expected(expected, low, high, true), SortValues(Drain(tree.RBegin(KeyOf(low), KeyOf(high))), true))
+            << low << " " << high;
+        EXPECT_EQ(Expected(expected, -1, high, true), SortValues(Drain(tree.RBegin(KeyOf(high))), true)) << high;
+      }
+
+      // Remove all but a few keys for the second round.
+      for (int64_t key = 0; key < 1000; key += 2) {
+        if (key % 300 != 0 && key != 998) {
+          tree.Remove(KeyOf(key));
+          expected.erase(key);
+        }
+      }
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// operator-- moves against the direction of an iterator, and equality covers the position, direction and bounds.
+// NOLINTNEXTLINE
+TEST(BPlusTreeIteratorTest, BidirectionalTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  IteratorTree tree("foo_pk", bpm, comparator, 4, 5);
+  for (int64_t key = 0; key < 200; key++) {
+    tree.Insert(KeyOf(key), RID(key, 0));
+  }
+
+  // Walk forward across several leaves, then back to the start, and past it.
+  auto iterator = tree.Begin(KeyOf(10));
+  for (int64_t key = 10; key < 60; key++, ++iterator) {
+    EXPECT_EQ(key, (*iterator).first.ToString());
+  }
+  for (int64_t key = 60; key > 0; key--, --iterator) {
+    EXPECT_EQ(key, (*iterator).first.ToString());
+  }
+  EXPECT_EQ(0, (*iterator).first.ToString());
+  --iterator;
+  EXPECT_TRUE(iterator.IsEnd());
+  EXPECT_TRUE(iterator == tree.End());
+
+  // The same for a reverse iterator, the other way round.
+  auto reverse = tree.RBegin(KeyOf(150));
+  EXPECT_TRUE(reverse.IsReverse());
+  for (int64_t key = 150; key > 100; key--, ++reverse) {
+    EXPECT_EQ(key, (*reverse).first.ToString());
+  }
+  for (int64_t key = 100; key < 199; key++, --reverse) {
+    EXPECT_EQ(key, (*reverse).first.ToString());
+  }
+  --reverse;
+  EXPECT_TRUE(reverse.IsEnd());
+
+  {
+    // Iterators are released before the next pair is created: each one holds a latch on its leaf.
+    auto a = tree.Begin(KeyOf(42));
+    auto b = tree.Begin(KeyOf(42));
+    EXPECT_TRUE(a == b);
+  }
+  {
+    auto forward = tree.Begin(KeyOf(42));
+    auto backward = tree.RBegin(KeyOf(42));
+    EXPECT_FALSE(forward == backward);
+  }
+  {
+    auto bounded = tree.Begin(KeyOf(42), KeyOf(50));
+    auto unbounded = tree.Begin(KeyOf(42));
+    EXPECT_TRUE(bounded != unbounded);
+  }
+  {
+    auto bounded = tree.Begin(KeyOf(42), KeyOf(50));
+    auto other = tree.Begin(KeyOf(42), KeyOf(51));
+    EXPECT_TRUE(bounded != other);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Reverse scans run while other threads split and merge the leaves around the keys they expect, in both tree modes.
+// NOLINTNEXTLINE
+TEST(BPlusTreeIteratorTest, ConcurrentReverseScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto mode : {BPlusTreeMode::LOCK_COUPLING, BPlusTreeMode::B_LINK}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    IteratorTree tree("foo_pk", bpm, comparator, 4, 5, mode);
+
+    // Multiples of 4 stay in the tree, the other keys come and go.
+    const int64_t key_range = 3000;
+    for (int64_t key = 0; key < key_range; key += 4) {
+      tree.Insert(KeyOf(key), RID(key, 0));
+    }
+    std::vector<std::thread> threads;
+    threads.emplace_back([&tree] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = 1; key < key_range; key += 2) {
+          tree.Insert(KeyOf(key), RID(key, 0));
+        }
+        for (int64_t key = 1; key < key_range; key += 2) {
+          tree.Remove(KeyOf(key));
+        }
+      }
+    });
+    threads.emplace_back([&tree] {
+      for (int round = 0; round < 10; round++) {
+        int64_t next = key_range - 4;
+        int64_t previous = key_range;
+        for (auto iterator = tree.RBegin(); !iterator.IsEnd(); ++iterator) {
+          int64_t key = (*iterator).first.ToString();
+          ASSERT_LT(key, previous);
+          previous = key;
+          if (key % 4 == 0) {
+            ASSERT_EQ(next, key);
+            next -= 4;
+          }
+        }
+        EXPECT_EQ(-4, next);
+      }
+    });
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// Long forward scans prefetch leaves in the background; every prefetched page is unpinned again, also when a scan
+// stops early or the leaves it prefetched are merged away meanwhile.
+// NOLINTNEXTLINE
+TEST(BPlusTreeIteratorTest, PrefetchTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  const size_t pool_size = 128;
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  IteratorTree tree("foo_pk", bpm, comparator, 16, 16);
+  const int64_t num_keys = 20000;
+  for (int64_t key = 0; key < num_keys; key++) {
+    tree.Insert(KeyOf(key), RID(key, 0));
+  }
+
+  int64_t next = 0;
+  for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator, next++) {
+    ASSERT_EQ(next, (*iterator).first.ToString());
+  }
+  EXPECT_EQ(num_keys, next);
+  {
+    auto iterator = tree.Begin(KeyOf(100), KeyOf(5000));
+    for (int i = 0; i < 1000; i++) {
+      ++iterator;
+    }
+    EXPECT_EQ(1100, (*iterator).first.ToString());
+  }
+  std::thread remover([&tree] {
+    for (int64_t key = 0; key < num_keys; key += 2) {
+      tree.Remove(KeyOf(key));
+    }
+  });
+  int64_t previous = -1;
+  for (auto iterator = tree.Begin(); !iterator.IsEnd(); ++iterator) {
+    int64_t key = (*iterator).first.ToString();
+    ASSERT_LT(previous, key);
+    previous = key;
+  }
+  remover.join();
+  EXPECT_EQ(num_keys / 2, Drain(tree.Begin()).size());
+
+  // Only the header page is still pinned, so every other frame can take a new page.
+  std::vector<page_id_t> page_ids(pool_size - 1);
+  for (auto &new_page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  }
+  for (auto new_page_id : page_ids) {
+    bpm->UnpinPage(new_page_id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
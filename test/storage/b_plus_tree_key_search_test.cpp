@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_key_search_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+const KeySearch::Kernel KERNELS[] = {KeySearch::Kernel::SCALAR, KeySearch::Kernel::SSE42, KeySearch::Kernel::AVX2};
+
+// Checks every kernel against std::lower_bound and std::upper_bound with the comparator on random sorted keys,
+// including duplicates, negative values, and sizes that leave a scalar tail after the SIMD loop.
+template <size_t KeySize>
+void CheckKernels(int64_t min, int64_t max) {
+  auto key_schema = ParseCreateStatement(KeySize == 4 ? "a integer" : "a bigint");
+  GenericComparator<KeySize> comparator(key_schema.get());
+  auto less = [&](const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) { return comparator(lhs, rhs) < 0; };
+  std::mt19937_64 rng(15445);
+  auto random_key = [&] {
+    auto value = min + static_cast<int64_t>(rng() % static_cast<uint64_t>(max - min));
+    GenericKey<KeySize> key;
+    key.SetFromKey(Tuple({KeySize == 4 ? ValueFactory::GetIntegerValue(static_cast<int32_t>(value))
+                                       : ValueFactory::GetBigIntValue(value)},
+                         key_schema.get()),
+                   *key_schema);
+    return key;
+  };
+
+  for (auto kernel : KERNELS) {
+    KeySearch::SetKernel(kernel);
+    for (int size : {0, 1, 3, 7, 8, 33, 64, 255, 500}) {
+      std::vector<GenericKey<KeySize>> keys(size);
+      std::generate(keys.begin(), keys.end(), random_key);
+      std::sort(keys.begin(), keys.end(), less);
+      for (int i = 0; i < 200; i++) {
+        auto probe = (i % 2 == 0 && size > 0) ? keys[rng() % size] : random_key();
+        EXPECT_EQ(std::lower_bound(keys.begin(), keys.end(), probe, less) - keys.begin(),
+                  KeySearch::CountLess(keys.data(), size, probe));
+        EXPECT_EQ(std::upper_bound(keys.begin(), keys.end(), probe, less) - keys.begin(),
+                  KeySearch::CountLessEqual(keys.data(), size, probe));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, KernelTest) {
+  auto detected = KeySearch::GetKernel();
+  CheckKernels<4>(BUSTUB_INT32_MIN + 1, BUSTUB_INT32_MAX);
+  CheckKernels<4>(-50, 50);
+  CheckKernels<8>(BUSTUB_INT64_MIN + 1, BUSTUB_INT64_MAX);
+  CheckKernels<8>(-50, 50);
+  KeySearch::SetKernel(detected);
+}
+
+// Searches within a full leaf of BIGINT keys, with the comparator through std::lower_bound and with each kernel the
+// CPU supports.
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, DISABLED_NodeSearchBenchmarkTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  // As many keys as a leaf page holds, see LEAF_PAGE_SIZE.
+  const int node_size = (PAGE_SIZE - 28 - 8) / (8 + sizeof(RID));
+  const int num_searches = 500000;
+  std::vector<GenericKey<8>> node(node_size);
+  for (int i = 0; i < node_size; i++) {
+    node[i].SetFromInteger(i * 2 - node_size);
+  }
+  std::vector<GenericKey<8>> probes(1024);
+  std::mt19937 rng(15445);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(static_cast<int64_t>(rng() % (node_size * 2)) - node_size);
+  }
+  auto less = [&](const GenericKey<8> &lhs, const GenericKey<8> &rhs) { return comparator(lhs, rhs) < 0; };
+
+  auto time_searches = [&](const std::string &name, auto &&search) {
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_searches; i++) {
+      checksum += search(probes[i % probes.size()]);
+    }
+    auto nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "node search " << name << " ns/op=" << nanos / num_searches << std::endl;
+    return checksum;
+  };
+  auto expected = time_searches("comparator", [&](const GenericKey<8> &probe) {
+    return std::lower_bound(node.begin(), node.end(), probe, less) - node.begin();
+  });
+
+  const char *names[] = {"scalar", "sse4.2", "avx2"};
+  auto detected = KeySearch::GetKernel();
+  for (auto kernel : KERNELS) {
+    KeySearch::SetKernel(kernel);
+    if (KeySearch::GetKernel() != kernel) {
+      continue;
+    }
+    EXPECT_EQ(expected, time_searches(names[static_cast<int>(kernel)], [&](const GenericKey<8> &probe) {
+                return KeySearch::CountLess(node.data(), node_size, probe);
+              }));
+  }
+  KeySearch::SetKernel(detected);
+}
+
+}  // namespace bustub
@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// The comparison GenericComparator made before keys were normalized: deserialize both sides column by column.
+auto ValueCompare(const std::vector<Value> &lhs, const std::vector<Value> &rhs) -> int {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+auto Sign(int cmp) -> int { return (cmp > 0) - (cmp < 0); }
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, OrderPreservingTest) {
+  Schema schema({Column("a", TypeId::SMALLINT), Column("b", TypeId::VARCHAR, 8), Column("c", TypeId::BIGINT),
+                 Column("d", TypeId::DECIMAL), Column("e", TypeId::INTEGER)});
+  GenericComparator<64> comparator(&schema);
+  std::mt19937 rng(15445);
+  // Few distinct values per column, so that ties on the leading columns are common.
+  auto random_row = [&] {
+    std::string varchar(rng() % 4, 'a');
+    for (auto &c : varchar) {
+      c = static_cast<char>('a' + rng() % 3);
+    }
+    auto bigint = static_cast<int64_t>(rng() % 5) * (INT64_MAX / 4) - INT64_MAX / 2;
+    return std::vector<Value>{ValueFactory::GetSmallIntValue(static_cast<int16_t>(rng() % 5) - 2),
+                              ValueFactory::GetVarcharValue(varchar), ValueFactory::GetBigIntValue(bigint),
+                              ValueFactory::GetDecimalValue((static_cast<int>(rng() % 9) - 4) * 0.75),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 5) - 2)};
+  };
+
+  for (int i = 0; i < 2000; i++) {
+    auto lhs_row = random_row();
+    auto rhs_row = random_row();
+    GenericKey<64> lhs;
+    GenericKey<64> rhs;
+    lhs.SetFromKey(Tuple(lhs_row, &schema), schema);
+    rhs.SetFromKey(Tuple(rhs_row, &schema), schema);
+    EXPECT_EQ(ValueCompare(lhs_row, rhs_row), Sign(comparator(lhs, rhs)));
+    for (uint32_t column = 0; column < schema.GetColumnCount(); column++) {
+      EXPECT_EQ(CmpBool::CmpTrue, lhs.ToValue(&schema, column).CompareEquals(lhs_row[column]));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NullAndPrefixOrderTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 8)});
+  GenericComparator<16> comparator(&schema);
+  auto make_key = [&](const Value &a, const std::string &b) {
+    GenericKey<16> key;
+    key.SetFromKey(Tuple({a, ValueFactory::GetVarcharValue(b)}, &schema), schema);
+    return key;
+  };
+  auto null_key = make_key(ValueFactory::GetNullValueByType(TypeId::INTEGER), "b");
+  auto min_key = make_key(ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN), "a");
+  auto prefix_key = make_key(ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN), "ab");
+
+  // NULL sorts before every value, and a string before every string it is a proper prefix of.
+  EXPECT_LT(comparator(null_key, min_key), 0);
+  EXPECT_LT(comparator(min_key, prefix_key), 0);
+  EXPECT_LT(comparator(make_key(ValueFactory::GetIntegerValue(0), ""), make_key(ValueFactory::GetIntegerValue(0), "a")),
+            0);
+  EXPECT_TRUE(null_key.ToValue(&schema, 0).IsNull());
+  EXPECT_EQ(CmpBool::CmpTrue, null_key.ToValue(&schema, 1).CompareEquals(ValueFactory::GetVarcharValue("b")));
+}
+
+// Binary search over a node's worth of BIGINT keys, the way B+ tree pages search, with the comparison on decoded
+// values and with memcmp on the normalized keys.
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, DISABLED_NodeSearchBenchmarkTest) {
+  Schema schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<8> comparator(&schema);
+  const int node_size = 256;
+  const int num_searches = 200000;
+  std::vector<GenericKey<8>> node(node_size);
+  for (int i = 0; i < node_size; i++) {
+    node[i].SetFromInteger(i * 2 - node_size);
+  }
+  std::vector<GenericKey<8>> probes(1024);
+  std::mt19937 rng(15445);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(static_cast<int64_t>(rng() % (node_size * 2)) - node_size);
+  }
+
+  auto value_less = [&](const GenericKey<8> &lhs, const GenericKey<8> &rhs) {
+    return ValueCompare({lhs.ToValue(&schema, 0)}, {rhs.ToValue(&schema, 0)}) < 0;
+  };
+  auto memcmp_less = [&](const GenericKey<8> &lhs, const GenericKey<8> &rhs) { return comparator(lhs, rhs) < 0; };
+
+  size_t checksum[2] = {0, 0};
+  double nanos[2];
+  for (int run = 0; run < 2; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_searches; i++) {
+      const auto &probe = probes[i % probes.size()];
+      auto it = run == 0 ? std::lower_bound(node.begin(), node.end(), probe, value_less)
+                         : std::lower_bound(node.begin(), node.end(), probe, memcmp_less);
+      checksum[run] += it - node.begin();
+    }
+    nanos[run] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+  EXPECT_EQ(checksum[0], checksum[1]);
+  std::cout << "node search ns/op: decoded values=" << nanos[0] / num_searches
+            << " normalized memcmp=" << nanos[1] / num_searches << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_latch_test.cpp
+//
+// Identification: test/storage/page_latch_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageLatchTest, OptimisticReadTest) {
+  Page page;
+  auto version = page.OptimisticRLatch();
+  EXPECT_TRUE(page.ValidateRead(version));
+
+  // Shared latches do not invalidate optimistic readers.
+  page.RLatch();
+  page.RUnlatch();
+  EXPECT_TRUE(page.ValidateRead(version));
+  EXPECT_EQ(version, page.OptimisticRLatch());
+
+  // A write latch does, even if it is released again before validation.
+  page.WLatch();
+  EXPECT_FALSE(page.ValidateRead(version));
+  page.WUnlatch();
+  EXPECT_FALSE(page.ValidateRead(version));
+  EXPECT_TRUE(page.ValidateRead(page.OptimisticRLatch()));
+}
+
+// NOLINTNEXTLINE
+TEST(PageLatchTest, ConcurrentOptimisticReadTest) {
+  Page page;
+  const int num_readers = 4;
+  const int num_writes = 20000;
+  const int num_reads = 1000;
+  std::atomic<int> writes{0};
+  std::atomic<int> validated{0};
+
+  // The writer keeps two copies of a counter in the page; a validated read must never see them disagree.
+  std::thread writer([&] {
+    for (int i = 1; i <= num_writes || validated < num_readers * num_reads; i++) {
+      page.WLatch();
+      memcpy(page.GetData() + 64, &i, sizeof(i));
+      memcpy(page.GetData() + 1024, &i, sizeof(i));
+      page.WUnlatch();
+      writes = i;
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&] {
+      for (int reads = 0; reads < num_reads;) {
+        auto version = page.OptimisticRLatch();
+        int first;
+        int second;
+        memcpy(&first, page.GetData() + 64, sizeof(first));
+        memcpy(&second, page.GetData() + 1024, sizeof(second));
+        if (page.ValidateRead(version)) {
+          EXPECT_EQ(first, second);
+          validated++;
+          reads++;
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  auto version = page.OptimisticRLatch();
+  int last;
+  memcpy(&last, page.GetData() + 64, sizeof(last));
+  EXPECT_TRUE(page.ValidateRead(version));
+  EXPECT_EQ(writes, last);
+  EXPECT_EQ(num_readers * num_reads, validated);
+}
+
+}  // namespace bustub